@@ -0,0 +1,188 @@
+/* Seven Segment Optical Character Recognition Parallel Bands */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* standard things */
+#include <stdio.h>          /* fprintf, perror */
+#include <stdlib.h>         /* calloc, free, exit */
+#include <string.h>         /* strerror */
+
+/* threads */
+#include <pthread.h>        /* pthread_create, pthread_join, mutex, cond */
+
+/* my headers */
+#include "defines.h"        /* PROG */
+#include "bands.h"          /* parallel bands */
+
+/* threads processing the bands of the images of one context, the bands of
+ * a call of run_bands() are taken in order by the workers and the calling
+ * thread, all fields but threads and nworkers are protected by lock */
+struct band_team_s {
+  pthread_t *threads;         /* worker threads */
+  int nworkers;               /* number of worker threads */
+  pthread_mutex_t lock;       /* protects the bands to process */
+  pthread_cond_t work;        /* signaled when there are bands to process */
+  pthread_cond_t done;        /* signaled when the last band is finished */
+  band_fn fn;                 /* process a band */
+  void *arg;                  /* argument of fn */
+  int first, end;             /* items to process */
+  int nbands;                 /* number of bands */
+  int next;                   /* next band to process */
+  int pending;                /* bands not yet finished */
+  int stop;                   /* should the workers exit? */
+};
+
+/* global variables */
+extern _Thread_local int ssocr_threads;
+
+/* team of the context of the calling thread */
+static _Thread_local band_team_struct *team = NULL;
+
+/* functions */
+
+/* number of bands for n items if a band should have at least min items */
+int count_bands(int n, int min)
+{
+  int nbands = ssocr_threads;
+
+  /* few items are not worth waking threads */
+  if(min > 0 && nbands > n / min) nbands = n / min;
+  if(nbands < 1) nbands = 1;
+  return nbands;
+}
+
+/* process bands of the current call of run_bands() until none is left,
+ * called and returning with t->lock held */
+static void take_bands(band_team_struct *t)
+{
+  int band, i0, i1;
+  long int n = t->end - t->first;
+
+  while(t->next < t->nbands) {
+    band = t->next++;
+    i0 = t->first + (int)(n * band / t->nbands);
+    i1 = t->first + (int)(n * (band + 1) / t->nbands);
+    pthread_mutex_unlock(&t->lock);
+    t->fn(t->arg, band, i0, i1);
+    pthread_mutex_lock(&t->lock);
+    if(--t->pending == 0) pthread_cond_signal(&t->done);
+  }
+}
+
+/* start routine of a worker thread */
+static void *band_worker(void *arg)
+{
+  band_team_struct *t = arg;
+
+  pthread_mutex_lock(&t->lock);
+  while(!t->stop) {
+    take_bands(t);
+    if(!t->stop) pthread_cond_wait(&t->work, &t->lock);
+  }
+  pthread_mutex_unlock(&t->lock);
+  return NULL;
+}
+
+/* create a team of threads processing bands with nthreads threads (including
+ * the calling thread), return NULL if one thread suffices */
+band_team_struct *new_band_team(int nthreads)
+{
+  band_team_struct *t;
+  int i, err;
+
+  if(nthreads <= 1) return NULL;
+  if(!(t = calloc(1, sizeof(band_team_struct)))) {
+    perror(PROG ": t = calloc()");
+    exit(99);
+  }
+  if(!(t->threads = calloc(nthreads - 1, sizeof(pthread_t)))) {
+    perror(PROG ": t->threads = calloc()");
+    exit(99);
+  }
+  pthread_mutex_init(&t->lock, NULL);
+  pthread_cond_init(&t->work, NULL);
+  pthread_cond_init(&t->done, NULL);
+  for(i = 0; i < nthreads - 1; i++) {
+    err = pthread_create(t->threads + i, NULL, band_worker, t);
+    if(err) {
+      fprintf(stderr, "%s: error: could not start band thread: %s\n", PROG,
+                      strerror(err));
+      exit(99);
+    }
+    t->nworkers++;
+  }
+  return t;
+}
+
+/* stop the threads of a team and free it */
+void free_band_team(band_team_struct *t)
+{
+  int i;
+
+  if(!t) return;
+  pthread_mutex_lock(&t->lock);
+  t->stop = 1;
+  pthread_cond_broadcast(&t->work);
+  pthread_mutex_unlock(&t->lock);
+  for(i = 0; i < t->nworkers; i++) {
+    pthread_join(t->threads[i], NULL);
+  }
+  pthread_cond_destroy(&t->done);
+  pthread_cond_destroy(&t->work);
+  pthread_mutex_destroy(&t->lock);
+  free(t->threads);
+  free(t);
+}
+
+/* set the team of the calling thread */
+void set_band_team(band_team_struct *t)
+{
+  team = t;
+}
+
+/* process items first to end-1 in nbands bands of (almost) equal size */
+void run_bands(int nbands, int first, int end, band_fn fn, void *arg)
+{
+  band_team_struct *t = team;
+  int band;
+
+  if(nbands <= 1) {
+    fn(arg, 0, first, end);
+    return;
+  }
+  /* without a team the calling thread processes every band */
+  if(!t) {
+    for(band = 0; band < nbands; band++) {
+      fn(arg, band, first + (int)((long int)(end - first) * band / nbands),
+         first + (int)((long int)(end - first) * (band + 1) / nbands));
+    }
+    return;
+  }
+  pthread_mutex_lock(&t->lock);
+  t->fn = fn;
+  t->arg = arg;
+  t->first = first;
+  t->end = end;
+  t->nbands = nbands;
+  t->next = 0;
+  t->pending = nbands;
+  pthread_cond_broadcast(&t->work);
+  /* the calling thread helps until every band has been started */
+  take_bands(t);
+  while(t->pending > 0) pthread_cond_wait(&t->done, &t->lock);
+  pthread_mutex_unlock(&t->lock);
+}
@@ -0,0 +1,55 @@
+/* Seven Segment Optical Character Recognition Parallel Bands */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* Work on one image is split into bands of consecutive rows, columns, or
+ * digits, the bands are processed by the calling thread and the worker
+ * threads of the team of its context, which wait for work from image to
+ * image.  The number of bands is the number of threads processing an image
+ * of the context of the calling thread (set_threads()).  Like the buffer
+ * pool, the team is set per thread (set_band_team()). */
+
+#ifndef SSOCR2_BANDS_H
+#define SSOCR2_BANDS_H
+
+/* function processing items i0 to i1-1, the band-th band, arg is passed
+ * through from run_bands() */
+typedef void (*band_fn)(void *arg, int band, int i0, int i1);
+
+/* worker threads waiting for bands (see bands.c) */
+typedef struct band_team_s band_team_struct;
+
+/* functions */
+
+/* number of bands for n items if a band should have at least min items */
+int count_bands(int n, int min);
+
+/* create a team of threads processing bands with nthreads threads (including
+ * the calling thread), return NULL if one thread suffices */
+band_team_struct *new_band_team(int nthreads);
+
+/* stop the threads of a team and free it */
+void free_band_team(band_team_struct *t);
+
+/* set the team of the calling thread, without a team the calling thread
+ * processes every band itself */
+void set_band_team(band_team_struct *t);
+
+/* process items first to end-1 in nbands bands of (almost) equal size */
+void run_bands(int nbands, int first, int end, band_fn fn, void *arg);
+
+#endif /* SSOCR2_BANDS_H */
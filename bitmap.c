@@ -0,0 +1,306 @@
+/* Seven Segment Optical Character Recognition Thresholded Bitmap Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* perror */
+#include <stdlib.h>         /* calloc, free, exit */
+#include <string.h>         /* memset */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "imgproc.h"        /* get_lum, is_pixel_set, clip */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+
+/* functions */
+
+/* make bitmap a thresholded view of w x h pixels, reusing its memory */
+static void init_view(bitmap_struct *bitmap, int w, int h, double thresh,
+                      luminance_t lt)
+{
+  int lum;
+
+  bitmap->w = w;
+  bitmap->h = h;
+  bitmap->data = NULL;
+  bitmap->frame = NULL;
+  bitmap->by_byte = 0;
+  bitmap->byte_offset = 0;
+  bitmap->byte_step = 0;
+  bitmap->by_bit = 0;
+
+  /* decide once for every possible luminance value if it is set */
+  for(lum = 0; lum <= MAXRGB; lum++) {
+    bitmap->set[lum] = is_pixel_set(lum, thresh);
+  }
+  bitmap->lt = lt;
+
+  bitmap->bw = (bitmap->w + BITMAP_BLOCK - 1) / BITMAP_BLOCK;
+  bitmap->bh = (bitmap->h + BITMAP_BLOCK - 1) / BITMAP_BLOCK;
+  bitmap->blocks = buf_zero(&bitmap->blocks_buf,
+                            (size_t)bitmap->bw * bitmap->bh,
+                            sizeof(unsigned char *));
+  bitmap->computed = 0;
+  bitmap->sat = NULL;
+}
+
+/* allocate an empty thresholded view */
+static bitmap_struct *alloc_bitmap(void)
+{
+  bitmap_struct *bitmap;
+
+  if(!(bitmap = calloc(1, sizeof(bitmap_struct)))) {
+    perror(PROG ": bitmap = calloc()");
+    exit(99);
+  }
+  return bitmap;
+}
+
+/* create a thresholded view of an image, no pixels are thresholded yet */
+bitmap_struct *new_bitmap(Imlib_Image *image, double thresh, luminance_t lt)
+{
+  bitmap_struct *bitmap = alloc_bitmap();
+
+  init_bitmap(bitmap, image, thresh, lt);
+  return bitmap;
+}
+
+/* make bitmap a thresholded view of an image like new_bitmap(), reusing its
+ * memory, bitmap must be zeroed before its first use */
+void init_bitmap(bitmap_struct *bitmap, Imlib_Image *image, double thresh,
+                 luminance_t lt)
+{
+  Imlib_Image current_image; /* save image pointer */
+
+  /* save pointer to current image */
+  current_image = imlib_context_get_image();
+
+  /* the image data is only read, never changed */
+  imlib_context_set_image(*image);
+  init_view(bitmap, imlib_image_get_width(), imlib_image_get_height(),
+            thresh, lt);
+  bitmap->data = imlib_image_get_data_for_reading_only();
+
+  /* restore image from before function call */
+  imlib_context_set_image(current_image);
+}
+
+/* create a thresholded view of a frame, no pixels are thresholded yet */
+bitmap_struct *new_bitmap_frame(frame_struct *frame, double thresh,
+                                luminance_t lt)
+{
+  bitmap_struct *bitmap = alloc_bitmap();
+
+  init_bitmap_frame(bitmap, frame, thresh, lt);
+  return bitmap;
+}
+
+/* make bitmap a thresholded view of a frame like new_bitmap_frame(), reusing
+ * its memory, bitmap must be zeroed before its first use */
+void init_bitmap_frame(bitmap_struct *bitmap, frame_struct *frame,
+                       double thresh, luminance_t lt)
+{
+  const int *lut;
+  int v;
+
+  init_view(bitmap, frame->w, frame->h, thresh, lt);
+  bitmap->frame = frame;
+
+  /* the luminance and thus the thresholding result of gray values, palette
+   * entries, and luma values is computed once, pixels are thresholded by
+   * lookup */
+  if(frame_lum_byte(frame, lt, &bitmap->byte_offset, &bitmap->byte_step)) {
+    lut = frame_lum_lut(frame, lt);
+    for(v = 0; v <= MAXRGB; v++) {
+      bitmap->byte_set[v] = bitmap->set[clip(lut[v], 0, MAXRGB)];
+    }
+    bitmap->by_byte = 1;
+  } else if(frame->fmt == FRAME_MONO1) {
+    /* a set bit is black */
+    lut = frame_lum_lut(frame, lt);
+    bitmap->byte_set[0] = bitmap->set[clip(lut[MAXRGB], 0, MAXRGB)];
+    bitmap->byte_set[1] = bitmap->set[clip(lut[0], 0, MAXRGB)];
+    bitmap->by_bit = 1;
+  }
+}
+
+/* free the memory of a thresholded view, but not the view itself */
+void clear_bitmap(bitmap_struct *bitmap)
+{
+  free_buf(&bitmap->blocks_buf);
+  free_buf(&bitmap->store_buf);
+  free_buf(&bitmap->sat_buf);
+  bitmap->blocks = NULL;
+  bitmap->sat = NULL;
+}
+
+/* free a thresholded view (the image or frame itself is not freed) */
+void free_bitmap(bitmap_struct *bitmap)
+{
+  if(!bitmap) return;
+  clear_bitmap(bitmap);
+  free(bitmap);
+}
+
+/* threshold all pixels of block (bx,by) */
+static unsigned char *compute_block(bitmap_struct *bitmap, int bx, int by)
+{
+  unsigned char *block;
+  const DATA32 *row;
+  const unsigned char *src;
+  DATA32 pixel;
+  Imlib_Color color;
+  int x, y, x0, y0, x1, y1, fx;
+  int lum[BITMAP_BLOCK]; /* luminance of the pixels of one row of a frame */
+
+  /* the pixels of the blocks are stored in the order of the blocks, pixels
+   * of a block outside of the image are not set */
+  block = buf_reserve(&bitmap->store_buf, (size_t)bitmap->bw * bitmap->bh,
+                      BITMAP_BLOCK * BITMAP_BLOCK);
+  block += ((size_t)by * bitmap->bw + bx) * BITMAP_BLOCK * BITMAP_BLOCK;
+  memset(block, 0, BITMAP_BLOCK * BITMAP_BLOCK);
+  x0 = bx * BITMAP_BLOCK;
+  y0 = by * BITMAP_BLOCK;
+  x1 = (x0 + BITMAP_BLOCK < bitmap->w) ? x0 + BITMAP_BLOCK : bitmap->w;
+  y1 = (y0 + BITMAP_BLOCK < bitmap->h) ? y0 + BITMAP_BLOCK : bitmap->h;
+  for(y = y0; y < y1; y++) {
+    if(bitmap->by_byte) {
+      src = bitmap->frame->data +
+            (size_t)(bitmap->frame->y0 + y) * bitmap->frame->stride +
+            bitmap->byte_offset +
+            (size_t)(bitmap->frame->x0 + x0) * bitmap->byte_step;
+      for(x = x0; x < x1; x++, src += bitmap->byte_step) {
+        block[(y - y0) * BITMAP_BLOCK + (x - x0)] = bitmap->byte_set[*src];
+      }
+      continue;
+    }
+    if(bitmap->by_bit) {
+      src = bitmap->frame->data +
+            (size_t)(bitmap->frame->y0 + y) * bitmap->frame->stride;
+      for(x = x0, fx = bitmap->frame->x0 + x0; x < x1; x++, fx++) {
+        block[(y - y0) * BITMAP_BLOCK + (x - x0)] =
+          bitmap->byte_set[(src[fx >> 3] >> (7 - (fx & 7))) & 1];
+      }
+      continue;
+    }
+    if(bitmap->frame) {
+      /* a frame provides the luminance values directly */
+      frame_lum_row(bitmap->frame, x0, y, x1 - x0, bitmap->lt, lum);
+      for(x = x0; x < x1; x++) {
+        block[(y - y0) * BITMAP_BLOCK + (x - x0)] =
+          bitmap->set[clip(lum[x - x0], 0, MAXRGB)];
+      }
+      continue;
+    }
+    row = bitmap->data + (size_t)y * bitmap->w;
+    for(x = x0; x < x1; x++) {
+      pixel = row[x];
+      color.alpha = (pixel >> 24) & 0xff;
+      color.red = (pixel >> 16) & 0xff;
+      color.green = (pixel >> 8) & 0xff;
+      color.blue = pixel & 0xff;
+      block[(y - y0) * BITMAP_BLOCK + (x - x0)] =
+        bitmap->set[clip(get_lum(&color, bitmap->lt), 0, MAXRGB)];
+    }
+  }
+  bitmap->blocks[by * bitmap->bw + bx] = block;
+  bitmap->computed++;
+
+  return block;
+}
+
+/* return 1 if the pixel at (x,y) is set (foreground), 0 otherwise */
+int bitmap_pixel(bitmap_struct *bitmap, int x, int y)
+{
+  int bx = x / BITMAP_BLOCK, by = y / BITMAP_BLOCK;
+  unsigned char *block;
+
+  if(x < 0 || y < 0 || x >= bitmap->w || y >= bitmap->h) {
+    return 0;
+  }
+  block = bitmap->blocks[by * bitmap->bw + bx];
+  if(!block) {
+    block = compute_block(bitmap, bx, by);
+  }
+  return block[(y % BITMAP_BLOCK) * BITMAP_BLOCK + x % BITMAP_BLOCK];
+}
+
+/* return the part of row y inside block column bx,
+ * i.e., BITMAP_BLOCK (or less in the last block column) pixels */
+const unsigned char *bitmap_block_row(bitmap_struct *bitmap, int bx, int y)
+{
+  int by = y / BITMAP_BLOCK;
+  unsigned char *block;
+
+  block = bitmap->blocks[by * bitmap->bw + bx];
+  if(!block) {
+    block = compute_block(bitmap, bx, by);
+  }
+  return block + (y % BITMAP_BLOCK) * BITMAP_BLOCK;
+}
+
+/* build the summed-area table of the thresholded image (thresholds all
+ * blocks), entry (x,y) holds the number of set pixels above and left of (x,y)
+ * in a table of (w+1)x(h+1) entries */
+void bitmap_build_sat(bitmap_struct *bitmap)
+{
+  int x, y, bx, n;
+  size_t sw = bitmap->w + 1; /* width of the table */
+  unsigned int sum; /* number of set pixels left of x in the current row */
+  unsigned int *above, *cur;
+
+  if(bitmap->sat) return;
+  bitmap->sat = buf_zero(&bitmap->sat_buf, sw * (bitmap->h + 1),
+                         sizeof(unsigned int));
+  /* row 0 and column 0 stay zero */
+  for(y = 0; y < bitmap->h; y++) {
+    above = bitmap->sat + y * sw;
+    cur = above + sw;
+    sum = 0;
+    for(bx = 0; bx < bitmap->bw; bx++) {
+      const unsigned char *bits = bitmap_block_row(bitmap, bx, y);
+      x = bx * BITMAP_BLOCK;
+      n = (bitmap->w - x < BITMAP_BLOCK) ? bitmap->w - x : BITMAP_BLOCK;
+      for(; n > 0; n--, x++, bits++) {
+        sum += *bits;
+        cur[x+1] = above[x+1] + sum;
+      }
+    }
+  }
+}
+
+/* return the number of set pixels in the rectangle (x1,y1) -> (x2,y2),
+ * both corners included, the rectangle is clipped to the image,
+ * bitmap_build_sat() must have been called before */
+unsigned int bitmap_area(bitmap_struct *bitmap, int x1, int y1, int x2, int y2)
+{
+  size_t sw = bitmap->w + 1; /* width of the table */
+
+  x1 = clip(x1, 0, bitmap->w - 1);
+  x2 = clip(x2, 0, bitmap->w - 1);
+  y1 = clip(y1, 0, bitmap->h - 1);
+  y2 = clip(y2, 0, bitmap->h - 1);
+  if(x2 < x1 || y2 < y1) return 0;
+  return bitmap->sat[(y2+1) * sw + x2 + 1] - bitmap->sat[y1 * sw + x2 + 1]
+         - bitmap->sat[(y2+1) * sw + x1] + bitmap->sat[y1 * sw + x1];
+}
@@ -0,0 +1,93 @@
+/* Seven Segment Optical Character Recognition Thresholded Bitmap Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* Needs "buffer.h" to be included before. */
+
+#ifndef SSOCR2_BITMAP_H
+#define SSOCR2_BITMAP_H
+
+/* thresholded view of an image
+ * the image is split into blocks of BITMAP_BLOCK x BITMAP_BLOCK pixels,
+ * a block is thresholded when one of its pixels is requested for the first
+ * time, and the result is kept for later requests */
+typedef struct {
+  int w, h;                 /* image dimensions in pixels */
+  int bw, bh;               /* image dimensions in blocks */
+  const DATA32 *data;       /* ARGB pixel data of the thresholded image */
+  frame_struct *frame;      /* frame to threshold instead of data, or NULL */
+  unsigned char set[MAXRGB+1]; /* is a pixel with a given luminance set? */
+  unsigned char byte_set[MAXRGB+1]; /* is a pixel of a frame with one byte
+                                     * giving its luminance (gray, palette
+                                     * index, or luma) set? */
+  int by_byte;              /* threshold frame pixels using byte_set? */
+  int byte_offset;          /* offset of that byte of the first pixel */
+  int byte_step;            /* bytes from pixel to pixel */
+  int by_bit;               /* threshold bits of a packed bilevel frame using
+                             * byte_set[bit]? */
+  luminance_t lt;           /* luminance formula */
+  unsigned char **blocks;   /* one byte per pixel, NULL if not yet computed */
+  int computed;             /* number of blocks computed so far */
+  unsigned int *sat;        /* summed-area table, NULL if not yet built */
+  buf_struct blocks_buf;    /* memory of blocks */
+  buf_struct store_buf;     /* memory of the blocks' pixels */
+  buf_struct sat_buf;       /* memory of sat */
+} bitmap_struct;
+
+/* functions */
+
+/* create a thresholded view of an image, no pixels are thresholded yet */
+bitmap_struct *new_bitmap(Imlib_Image *image, double thresh, luminance_t lt);
+
+/* create a thresholded view of a frame, no pixels are thresholded yet */
+bitmap_struct *new_bitmap_frame(frame_struct *frame, double thresh,
+                                luminance_t lt);
+
+/* make bitmap a thresholded view of an image like new_bitmap(), reusing its
+ * memory, bitmap must be zeroed before its first use */
+void init_bitmap(bitmap_struct *bitmap, Imlib_Image *image, double thresh,
+                 luminance_t lt);
+
+/* make bitmap a thresholded view of a frame like new_bitmap_frame(), reusing
+ * its memory, bitmap must be zeroed before its first use */
+void init_bitmap_frame(bitmap_struct *bitmap, frame_struct *frame,
+                       double thresh, luminance_t lt);
+
+/* free the memory of a thresholded view, but not the view itself */
+void clear_bitmap(bitmap_struct *bitmap);
+
+/* free a thresholded view (the image or frame itself is not freed) */
+void free_bitmap(bitmap_struct *bitmap);
+
+/* return 1 if the pixel at (x,y) is set (foreground), 0 otherwise */
+int bitmap_pixel(bitmap_struct *bitmap, int x, int y);
+
+/* return the part of row y inside block column bx,
+ * i.e., BITMAP_BLOCK (or less in the last block column) pixels */
+const unsigned char *bitmap_block_row(bitmap_struct *bitmap, int bx, int y);
+
+/* build the summed-area table of the thresholded image (thresholds all
+ * blocks), entry (x,y) holds the number of set pixels above and left of (x,y)
+ * in a table of (w+1)x(h+1) entries */
+void bitmap_build_sat(bitmap_struct *bitmap);
+
+/* return the number of set pixels in the rectangle (x1,y1) -> (x2,y2),
+ * both corners included, the rectangle is clipped to the image,
+ * bitmap_build_sat() must have been called before */
+unsigned int bitmap_area(bitmap_struct *bitmap, int x1, int y1, int x2, int y2);
+
+#endif /* SSOCR2_BITMAP_H */
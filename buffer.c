@@ -0,0 +1,88 @@
+/* Seven Segment Optical Character Recognition Reusable Buffers */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* standard things */
+#include <stdint.h>         /* SIZE_MAX */
+#include <stdio.h>          /* fputs, perror */
+#include <stdlib.h>         /* realloc, free, exit */
+#include <string.h>         /* memset */
+
+/* my headers */
+#include "defines.h"        /* PROG */
+#include "buffer.h"         /* reusable buffers */
+
+/* allocations of buffers by this thread */
+static _Thread_local unsigned long int allocations = 0;
+
+/* functions */
+
+/* make the buffer hold at least n elements of size bytes each, keeping its
+ * contents, return its memory */
+void *buf_reserve(buf_struct *buf, size_t n, size_t size)
+{
+  size_t need, grow;
+  void *mem;
+
+  if(size && n > SIZE_MAX / size) {
+    fputs(PROG ": error: size_t overflow (memory for buffer)\n", stderr);
+    exit(99);
+  }
+  need = n * size;
+  if(need <= buf->size && buf->mem) return buf->mem;
+  /* grow at least by half to reach the high-water mark in few steps */
+  grow = buf->size + buf->size / 2;
+  if(grow > need) need = grow;
+  if(!(mem = realloc(buf->mem, need ? need : 1))) {
+    perror(PROG ": buf->mem = realloc()");
+    exit(99);
+  }
+  buf->mem = mem;
+  buf->size = need;
+  allocations++;
+  return mem;
+}
+
+/* make the buffer hold at least n elements of size bytes each, set them to
+ * zero, return its memory */
+void *buf_zero(buf_struct *buf, size_t n, size_t size)
+{
+  void *mem = buf_reserve(buf, n, size);
+
+  memset(mem, 0, n * size);
+  return mem;
+}
+
+/* free the memory of the buffer, it may be used again afterwards */
+void free_buf(buf_struct *buf)
+{
+  free(buf->mem);
+  buf->mem = NULL;
+  buf->size = 0;
+}
+
+/* return the number of allocations of buffers by the calling thread */
+unsigned long int buf_allocations(void)
+{
+  return allocations;
+}
+
+/* count an allocation of memory reused like a buffer */
+void buf_count_allocation(void)
+{
+  allocations++;
+}
@@ -0,0 +1,54 @@
+/* Seven Segment Optical Character Recognition Reusable Buffers */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* A buffer keeps its memory from image to image and grows to the largest
+ * size needed so far (its high-water mark), thus processing the frames of a
+ * stream of constant geometry allocates no memory after the first frames.
+ * Every allocation is counted per thread to verify this. */
+
+#ifndef SSOCR2_BUFFER_H
+#define SSOCR2_BUFFER_H
+
+#include <stddef.h>         /* size_t */
+
+/* memory reused for every image */
+typedef struct {
+  void *mem;                  /* allocated memory, or NULL */
+  size_t size;                /* number of bytes allocated */
+} buf_struct;
+
+/* functions */
+
+/* make the buffer hold at least n elements of size bytes each, keeping its
+ * contents, return its memory */
+void *buf_reserve(buf_struct *buf, size_t n, size_t size);
+
+/* make the buffer hold at least n elements of size bytes each, set them to
+ * zero, return its memory */
+void *buf_zero(buf_struct *buf, size_t n, size_t size);
+
+/* free the memory of the buffer, it may be used again afterwards */
+void free_buf(buf_struct *buf);
+
+/* return the number of allocations of buffers by the calling thread */
+unsigned long int buf_allocations(void);
+
+/* count an allocation of memory reused like a buffer */
+void buf_count_allocation(void);
+
+#endif /* SSOCR2_BUFFER_H */
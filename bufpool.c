@@ -0,0 +1,178 @@
+/* Seven Segment Optical Character Recognition Buffer Pool */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* fprintf, perror */
+#include <stdlib.h>         /* calloc, free, exit */
+#include <string.h>         /* memcpy */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+#include "rle.h"            /* run-length encoding */
+#include "bufpool.h"        /* buffer pool */
+
+/* the buffer pool set by the calling thread, and its own pool if none is */
+static _Thread_local buf_pool_struct *current_pool = NULL;
+static _Thread_local buf_pool_struct *own_pool = NULL;
+
+/* functions */
+
+/* create an empty buffer pool */
+buf_pool_struct *new_buf_pool(void)
+{
+  buf_pool_struct *pool;
+
+  if(!(pool = calloc(1, sizeof(buf_pool_struct)))) {
+    perror(PROG ": pool = calloc()");
+    exit(99);
+  }
+  return pool;
+}
+
+/* free a buffer pool and its images (using Imlib2) */
+void free_buf_pool(buf_pool_struct *pool)
+{
+  int i;
+
+  if(!pool) return;
+  if(current_pool == pool) current_pool = NULL;
+  for(i = 0; i < BUF_COUNT; i++) {
+    free_buf(pool->bufs + i);
+  }
+  clear_bitmap(&pool->bitmap);
+  clear_rle(&pool->rle);
+  clear_bitmap(&pool->cmd_bitmap);
+  clear_rle(pool->cmd_rle);
+  clear_rle(pool->cmd_rle + 1);
+  for(i = 0; i < pool->nimages; i++) {
+    imlib_context_set_image(pool->images[i]);
+    imlib_free_image();
+  }
+  free(pool);
+}
+
+/* set the buffer pool of the calling thread */
+void set_buf_pool(buf_pool_struct *pool)
+{
+  current_pool = pool;
+}
+
+/* return the buffer pool of the calling thread, a thread that has not set
+ * one gets a pool of its own */
+buf_pool_struct *get_buf_pool(void)
+{
+  if(current_pool) return current_pool;
+  if(!own_pool) own_pool = new_buf_pool();
+  return own_pool;
+}
+
+/* return buffer id of the pool of the calling thread holding at least n
+ * elements of size bytes each, its contents are undefined */
+void *pool_buf(buf_id_t id, size_t n, size_t size)
+{
+  return buf_reserve(get_buf_pool()->bufs + id, n, size);
+}
+
+/* return buffer id of the pool of the calling thread holding at least n
+ * elements of size bytes each, set to zero */
+void *pool_buf_zero(buf_id_t id, size_t n, size_t size)
+{
+  return buf_zero(get_buf_pool()->bufs + id, n, size);
+}
+
+/* like imlib_create_image(), but reuse an unused image of the pool */
+Imlib_Image pool_create_image(int w, int h)
+{
+  buf_pool_struct *pool = get_buf_pool();
+  Imlib_Image current_image; /* save image pointer */
+  Imlib_Image image;
+  int i;
+
+  /* take the newest unused image of this size */
+  current_image = imlib_context_get_image();
+  for(i = pool->nimages - 1; i >= 0; i--) {
+    imlib_context_set_image(pool->images[i]);
+    if(imlib_image_get_width() == w && imlib_image_get_height() == h) {
+      image = pool->images[i];
+      pool->nimages--;
+      memmove(pool->images + i, pool->images + i + 1,
+              (pool->nimages - i) * sizeof(Imlib_Image));
+      /* like a new image */
+      imlib_image_set_has_alpha(0);
+      imlib_context_set_image(current_image);
+      return image;
+    }
+  }
+  imlib_context_set_image(current_image);
+
+  if(!(image = imlib_create_image(w, h))) {
+    fprintf(stderr, "%s: error: could not create image\n", PROG);
+    exit(99);
+  }
+  buf_count_allocation();
+  return image;
+}
+
+/* like imlib_clone_image(), but reuse an unused image of the pool */
+Imlib_Image pool_clone_image(void)
+{
+  Imlib_Image source_image, image;
+  const DATA32 *src;
+  DATA32 *dst;
+  int w, h;
+  char has_alpha;
+
+  source_image = imlib_context_get_image();
+  w = imlib_image_get_width();
+  h = imlib_image_get_height();
+  has_alpha = imlib_image_has_alpha();
+  src = imlib_image_get_data_for_reading_only();
+  image = pool_create_image(w, h);
+  imlib_context_set_image(image);
+  dst = imlib_image_get_data();
+  memcpy(dst, src, (size_t)w * h * sizeof(DATA32));
+  imlib_image_put_back_data(dst);
+  imlib_image_set_has_alpha(has_alpha);
+  imlib_context_set_image(source_image);
+  return image;
+}
+
+/* like imlib_free_image(), but keep the current image for reuse, it must not
+ * have been loaded from a file (Imlib2 might keep loaded images) */
+void pool_free_image(void)
+{
+  buf_pool_struct *pool = get_buf_pool();
+  Imlib_Image image = imlib_context_get_image();
+
+  /* the oldest unused image makes room, it probably has an old size */
+  if(pool->nimages == POOL_IMAGES) {
+    imlib_context_set_image(pool->images[0]);
+    imlib_free_image();
+    pool->nimages--;
+    memmove(pool->images, pool->images + 1,
+            pool->nimages * sizeof(Imlib_Image));
+  }
+  pool->images[pool->nimages++] = image;
+}
@@ -0,0 +1,101 @@
+/* Seven Segment Optical Character Recognition Buffer Pool */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* The buffer pool of a context keeps everything allocated for recognizing an
+ * image for the next image: buffers for intermediate results, the thresholded
+ * view and its runs of set pixels, and Imlib2 images of the size of the image.
+ * The buffers grow to the largest size needed (see buffer.h), an image is
+ * reused for a new image of the same width and height.  Thus recognizing the
+ * frames of a stream with constant geometry and pixel format allocates no
+ * memory after the first frames.  Like the colors, the pool is set per thread
+ * for the image processing functions.  The band threads must not use it.
+ *
+ * Needs <X11/Xlib.h>, <Imlib2.h>, "frame.h", "buffer.h", "bitmap.h", and
+ * "rle.h" to be included before. */
+
+#ifndef SSOCR2_BUFPOOL_H
+#define SSOCR2_BUFPOOL_H
+
+/* buffers of the pool, a buffer is used by one function at a time */
+typedef enum buf_id_e {
+  BUF_BANDS,                  /* bands of an image processing function */
+  BUF_NEIGHBORS,              /* thresholded rows of neighborhood filters */
+  BUF_LUM,                    /* luminance of every pixel */
+  BUF_PARENT,                 /* union-find forest of the runs */
+  BUF_LABELS,                 /* component of every run */
+  BUF_BLOBS,                  /* bounding boxes of components */
+  BUF_COL_PIXELS,             /* foreground pixels of every column */
+  BUF_COL_BANDS,              /* partitions of the bands of columns */
+  BUF_COL_SCRATCH,            /* boundaries and profiles of the bands */
+  BUF_BOUNDS,                 /* columns starting and ending digits */
+  BUF_ROW_PIXELS,             /* foreground pixels of the rows of digits */
+  BUF_LINES,                  /* rows of digits with a debug line */
+  BUF_DIGITS,                 /* potential digits */
+  BUF_FRAME,                  /* pixels of an image copied into a frame */
+  BUF_FRAME_ROW,              /* luminance of a row of a frame view */
+  BUF_SKIP_ROW,               /* luminance of a row of a frame */
+  BUF_SKIP_CUR,               /* luminance of the region of the image */
+  BUF_SKIP_REF,               /* kept luminance of the reference region */
+  BUF_COUNT                   /* number of buffers */
+} buf_id_t;
+
+/* memory kept from image to image */
+typedef struct buf_pool_s {
+  buf_struct bufs[BUF_COUNT]; /* buffers by buf_id_t */
+  bitmap_struct bitmap;       /* thresholded image for recognition */
+  rle_struct rle;             /* runs of set pixels for recognition */
+  bitmap_struct cmd_bitmap;   /* thresholded image of a command */
+  rle_struct cmd_rle[2];      /* runs of set pixels of a command */
+  Imlib_Image images[POOL_IMAGES]; /* unused images, the newest last */
+  int nimages;                /* number of unused images */
+} buf_pool_struct;
+
+/* functions */
+
+/* create an empty buffer pool */
+buf_pool_struct *new_buf_pool(void);
+
+/* free a buffer pool and its images (using Imlib2) */
+void free_buf_pool(buf_pool_struct *pool);
+
+/* set the buffer pool of the calling thread */
+void set_buf_pool(buf_pool_struct *pool);
+
+/* return the buffer pool of the calling thread, a thread that has not set
+ * one gets a pool of its own */
+buf_pool_struct *get_buf_pool(void);
+
+/* return buffer id of the pool of the calling thread holding at least n
+ * elements of size bytes each, its contents are undefined */
+void *pool_buf(buf_id_t id, size_t n, size_t size);
+
+/* return buffer id of the pool of the calling thread holding at least n
+ * elements of size bytes each, set to zero */
+void *pool_buf_zero(buf_id_t id, size_t n, size_t size);
+
+/* like imlib_create_image(), but reuse an unused image of the pool */
+Imlib_Image pool_create_image(int w, int h);
+
+/* like imlib_clone_image(), but reuse an unused image of the pool */
+Imlib_Image pool_clone_image(void);
+
+/* like imlib_free_image(), but keep the current image for reuse, it must not
+ * have been loaded from a file (Imlib2 might keep loaded images) */
+void pool_free_image(void);
+
+#endif /* SSOCR2_BUFPOOL_H */
@@ -27,12 +27,12 @@
 #include "defines.h"        /* defines */
 #include "help.h"           /* character set keyword functions */
 
-/* parse KEYWORD from --charset option */
+/* parse KEYWORD from --charset option, print the keywords for "help" */
 charset_t parse_charset(char *keyword)
 {
   if(strncasecmp(keyword, "help", 4) == 0) {
     print_cs_help();
-    exit(42);
+    return CS_HELP;
   } else if(strncasecmp(keyword, "full", 4) == 0) {
     return CS_FULL;
   } else if(strncasecmp(keyword, "digits", 6) == 0) {
@@ -48,11 +48,9 @@ charset_t parse_charset(char *keyword)
   }
 }
 
-/* array for character set */
-static char charset_array[CHARSET_MAX + 1];
-
-/* initialize the character set array with the given character set */
-void init_charset(charset_t cs)
+/* initialize the character set array (of CHARSET_MAX + 1 characters) with
+ * the given character set */
+void init_charset(charset_t cs, char *charset_array)
 {
   int i;
 
@@ -185,21 +183,10 @@ void init_charset(charset_t cs)
   }
 }
 
-/* print a digit according to charset, return 1 if unknown, else 0 */
-int print_digit(int digit, unsigned int flags)
+/* return the character of a digit according to the character set array,
+ * '_' if the digit is unknown */
+char digit_char(const char *charset_array, int digit)
 {
-  int unknown_digit = 0;
-  char c = '_';
-
-  if(digit <= CHARSET_MAX) {
-    c = charset_array[digit];
-  }
-  if(c == '_') {
-    unknown_digit = 1;
-  }
-  if(!((c == '.') && (flags & OMIT_DECIMAL))) {
-    putchar(c);
-  }
-
-  return unknown_digit;
+  if(digit < 0 || digit > CHARSET_MAX) return '_';
+  return charset_array[digit];
 }
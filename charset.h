@@ -21,13 +21,16 @@
 
 /* functions */
 
-/* parse KEYWORD from --charset option */
+/* parse KEYWORD from --charset option, CS_HELP after printing the keywords
+ * for "help" */
 charset_t parse_charset(char *keyword);
 
-/* initialize the character set array with the given character set */
-void init_charset(charset_t cs);
+/* initialize the character set array (of CHARSET_MAX + 1 characters) with
+ * the given character set */
+void init_charset(charset_t cs, char *charset_array);
 
-/* print a digit according to charset, return 1 if unknown, else 0 */
-int print_digit(int digit, unsigned int flags);
+/* return the character of a digit according to the character set array,
+ * '_' if the digit is unknown */
+char digit_char(const char *charset_array, int digit);
 
 #endif /* SSOCR2_CHARSET_H */
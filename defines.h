@@ -31,6 +31,8 @@
 
 /* boarder between dark and light */
 #define THRESHOLD 50.0
+/* threshold used for an image given as bilevel (black and white) */
+#define BILEVEL_THRESHOLD 50.0
 #define DARK 0
 #define LIGHT 1
 #define UNKNOWN 2
@@ -137,6 +139,74 @@
 /* ignore # of pixels when checking a column fo black or white */
 #define IGNORE_PIXELS 0
 
+/* percentage of a segment area that has to be set when using --segment-fill
+ * without a valid argument */
+#define SEGMENT_FILL 10
+
+/* MJPEG frames are decoded at full size by default (denominator of scale) */
+#define JPEG_SCALE 1
+
+/* images of a batch are processed sequentially by default (worker threads) */
+#define JOBS 1
+
+/* an image is processed by one thread by default (threads per image) */
+#define THREADS 1
+
+/* fewest rows of an image processed by one thread */
+#define BAND_ROWS 32
+
+/* fewest columns of an image segmented by one thread */
+#define BAND_COLS 64
+
+/* images per worker thread that may be unfinished or wait to be printed in
+ * input order, i.e., the size of the reorder buffer of a parallel batch */
+#define JOB_WINDOW 16
+
+/* options and commands of this many requests are kept parsed by the daemon */
+#define PLAN_CACHE 16
+
+/* maximum length of the arguments of a request sent to the daemon */
+#define MAX_REQUEST (1024*1024)
+
+/* seconds a client of the daemon may take to send its request */
+#define REQUEST_TIMEOUT 5
+
+/* frames of one stream of the multi-stream server waiting for a worker */
+#define STREAM_BACKLOG 4
+
+/* bytes read from a stream of the multi-stream server at once */
+#define STREAM_READ (64*1024)
+
+/* events handled by the multi-stream server per call of epoll_wait() */
+#define STREAM_EVENTS 64
+
+/* microseconds to sleep while waiting for the other side of a shared memory
+ * frame ring */
+#define SHM_RING_POLL 200
+
+/* frames in the streaming pipeline (decoded, recognized, or printed) */
+#define PIPELINE_DEPTH 4
+
+/* stages of the streaming pipeline (decode, process, output) */
+#define PIPELINE_STAGES 3
+
+/* microseconds to sleep while waiting for a neighboring pipeline stage */
+#define PIPELINE_POLL 50
+
+/* unused images a buffer pool keeps for the next images of the same size */
+#define POOL_IMAGES 8
+
+/* pixels that may differ from the last recognized image for skipping an
+ * unchanged image by default */
+#define SKIP_TOLERANCE 0
+
+/* luminance difference of a pixel that differs from the last recognized
+ * image */
+#define SKIP_LUM_DIFF 16
+
+/* width and height of the blocks thresholded on demand for recognition */
+#define BITMAP_BLOCK 32
+
 #define DIR_SEP "/"
 #define TMP_FILE_DIR "/tmp"
 #define TMP_FILE_PATTERN "ssocr.img.XXXXXX"
@@ -157,6 +227,16 @@
 #define PRINT_SPACES (1<<11)
 #define SPC_USE_AVG_DST (1<<12)
 #define ADAPT_AFTER_CROP (1<<13)
+#define AREA_SEGMENTS (1<<14)
+#define COMPONENT_SEGMENTS (1<<15)
+#define STREAM_FRAMES (1<<16)
+#define BILEVEL_INPUT (1<<17)
+#define BATCH_MODE (1<<18)
+#define UNORDERED_OUTPUT (1<<19)
+#define DROP_OLDEST (1<<20)
+#define SHM_RING_INPUT (1<<21)
+#define SKIP_UNCHANGED (1<<22)
+#define CHANGES_ONLY (1<<23)
 
 /* colors used by ssocr */
 #define SSOCR_BLACK 0
@@ -193,7 +273,8 @@ typedef enum luminance_e {
   RED,
   GREEN,
   BLUE,
-  LUM_PARSE_ERROR
+  LUM_PARSE_ERROR,
+  LUM_HELP
 } luminance_t;
 
 /* direction, to mirror horizontally or vertically, or for a scanline */
@@ -209,9 +290,37 @@ typedef enum charset_e {
   CS_DECIMAL,
   CS_HEXADECIMAL,
   CS_TT_ROBOT,
-  CS_PARSE_ERROR
+  CS_PARSE_ERROR,
+  CS_HELP
 } charset_t;
 
 #define DEFAULT_CHARSET CS_FULL
 
+/* image processing commands */
+typedef enum cmd_e {
+  CMD_DILATION,
+  CMD_EROSION,
+  CMD_OPENING,
+  CMD_CLOSING,
+  CMD_REMOVE_ISOLATED,
+  CMD_REMOVE_SMALL_BLOBS,
+  CMD_MAKE_MONO,
+  CMD_WHITE_BORDER,
+  CMD_SHEAR,
+  CMD_SET_PIXELS_FILTER,
+  CMD_KEEP_PIXELS_FILTER,
+  CMD_DYNAMIC_THRESHOLD,
+  CMD_RGB_THRESHOLD,
+  CMD_R_THRESHOLD,
+  CMD_G_THRESHOLD,
+  CMD_B_THRESHOLD,
+  CMD_INVERT,
+  CMD_GRAY_STRETCH,
+  CMD_GRAYSCALE,
+  CMD_CROP,
+  CMD_ROTATE,
+  CMD_MIRROR,
+  CMD_UNKNOWN
+} cmd_t;
+
 #endif /* SSOCR2_DEFINES_H */
@@ -0,0 +1,458 @@
+/* Seven Segment Optical Character Recognition Frame Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* perror */
+#include <stdlib.h>         /* calloc, free, exit */
+#include <string.h>         /* memset */
+
+/* memory mapping */
+#include <sys/mman.h>       /* munmap */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "imgproc.h"        /* get_lum, clip, iterative_threshold_hist */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+#include "rle.h"            /* run-length encoding */
+#include "bufpool.h"        /* buffer pool */
+
+/* functions */
+
+/* create an empty frame, e.g., to read a stream of frames into */
+frame_struct *new_frame(void)
+{
+  frame_struct *frame;
+
+  if(!(frame = calloc(1, sizeof(frame_struct)))) {
+    perror(PROG ": frame = calloc()");
+    exit(99);
+  }
+  return frame;
+}
+
+/* free a frame including the memory holding its pixel data */
+void free_frame(frame_struct *frame)
+{
+  if(!frame) return;
+  if(frame->map) {
+    munmap(frame->map, frame->map_len);
+  }
+  free(frame->buf);
+  free(frame);
+}
+
+/* return the luminance of every possible byte value of a frame using one byte
+ * per pixel, i.e., of every gray value or palette entry */
+const int *frame_lum_lut(frame_struct *frame, luminance_t lt)
+{
+  Imlib_Color color;
+  int v;
+
+  if(frame->lut_valid && frame->lut_lt == lt) return frame->lum_lut;
+  /* compute the luminance once per gray value or palette entry */
+  color.alpha = MAXRGB;
+  for(v = 0; v <= MAXRGB; v++) {
+    if(frame->fmt == FRAME_PAL8) {
+      color.red = frame->palette[v][0];
+      color.green = frame->palette[v][1];
+      color.blue = frame->palette[v][2];
+    } else if(frame->fmt == FRAME_YUYV || frame->fmt == FRAME_NV12) {
+      /* luma is used as is */
+      frame->lum_lut[v] = v;
+      continue;
+    } else {
+      color.red = color.green = color.blue = v;
+    }
+    frame->lum_lut[v] = get_lum(&color, lt);
+  }
+  frame->lut_lt = lt;
+  frame->lut_valid = 1;
+  return frame->lum_lut;
+}
+
+/* check if the luminance of a pixel is given by one byte, i.e., a gray value,
+ * a palette index, the high byte of a 16 bit gray value, or luma Y used for a
+ * luminance formula of the Y kind, return 1 and set the offset of that byte
+ * for pixel 0 and the step in bytes from pixel to pixel if it is, 0 if not */
+int frame_lum_byte(const frame_struct *frame, luminance_t lt,
+                   int *offset, int *step)
+{
+  /* the luma of YUV data replaces the luminance formulas computing Y */
+  int luma = (lt == REC601 || lt == REC709 || lt == LINEAR);
+
+  switch(frame->fmt) {
+    case FRAME_GRAY8:
+    case FRAME_PAL8:
+      *offset = 0;
+      *step = 1;
+      return 1;
+    case FRAME_GRAY16:
+      *offset = 1;
+      *step = 2;
+      return 1;
+    case FRAME_YUYV:
+      *offset = 0;
+      *step = 2;
+      return luma;
+    case FRAME_NV12:
+      *offset = 0;
+      *step = 1;
+      return luma;
+    default:
+      return 0;
+  }
+}
+
+/* return the number of bytes of one row of w pixels of the given format */
+size_t frame_row_len(frame_fmt_t fmt, int w)
+{
+  switch(fmt) {
+    case FRAME_MONO1:  return ((size_t)w + 7) / 8;
+    case FRAME_GRAY8:
+    case FRAME_PAL8:   return w;
+    case FRAME_GRAY16:
+    case FRAME_RGB565: return 2 * (size_t)w;
+    case FRAME_RGB24:  return 3 * (size_t)w;
+    case FRAME_BGRA32: return 4 * (size_t)w;
+    /* chroma is shared by pairs of pixels */
+    case FRAME_YUYV:   return 4 * (((size_t)w + 1) / 2);
+    case FRAME_NV12:   return 2 * (((size_t)w + 1) / 2);
+  }
+  return 0;
+}
+
+/* convert luma Y and chroma U and V (ITU-R BT.601, limited range) to RGB */
+static void yuv_to_color(int y, int u, int v, Imlib_Color *color)
+{
+  double l = 1.164 * (y - 16);
+
+  color->red = clip((int)(l + 1.596 * (v - 128)), 0, MAXRGB);
+  color->green = clip((int)(l - 0.392 * (u - 128) - 0.813 * (v - 128)),
+                      0, MAXRGB);
+  color->blue = clip((int)(l + 2.017 * (u - 128)), 0, MAXRGB);
+}
+
+/* get the color of pixel x (counted from the start of the pixel data) of a
+ * row, uv is the chroma row of an NV12 frame */
+static void frame_color(const frame_struct *frame, const unsigned char *row,
+                        const unsigned char *uv, int x, Imlib_Color *color)
+{
+  const unsigned char *c;
+  int v;
+
+  color->alpha = MAXRGB;
+  switch(frame->fmt) {
+    case FRAME_MONO1:
+      v = ((row[x >> 3] >> (7 - (x & 7))) & 1) ? 0 : MAXRGB;
+      color->red = color->green = color->blue = v;
+      break;
+    case FRAME_GRAY8:
+      color->red = color->green = color->blue = row[x];
+      break;
+    case FRAME_GRAY16:
+      color->red = color->green = color->blue = row[2*x+1];
+      break;
+    case FRAME_RGB24:
+      c = row + 3*x;
+      color->red = c[0];
+      color->green = c[1];
+      color->blue = c[2];
+      break;
+    case FRAME_PAL8:
+      c = frame->palette[row[x]];
+      color->red = c[0];
+      color->green = c[1];
+      color->blue = c[2];
+      break;
+    case FRAME_BGRA32:
+      c = row + 4*x;
+      color->red = c[2];
+      color->green = c[1];
+      color->blue = c[0];
+      break;
+    case FRAME_RGB565:
+      v = row[2*x] | (row[2*x+1] << 8);
+      color->red = ((v >> 11) & 0x1f) * MAXRGB / 0x1f;
+      color->green = ((v >> 5) & 0x3f) * MAXRGB / 0x3f;
+      color->blue = (v & 0x1f) * MAXRGB / 0x1f;
+      break;
+    case FRAME_YUYV:
+      c = row + 4*(x/2);
+      yuv_to_color(row[2*x], c[1], c[3], color);
+      break;
+    case FRAME_NV12:
+      c = uv + (x & ~1);
+      yuv_to_color(row[x], c[0], c[1], color);
+      break;
+  }
+}
+
+/* return the chroma row of row y of the view of an NV12 frame, else NULL */
+static const unsigned char *frame_uv_row(const frame_struct *frame, int y)
+{
+  if(frame->fmt != FRAME_NV12) return NULL;
+  return frame->uv + (size_t)((frame->y0 + y) / 2) * frame->stride;
+}
+
+/* compute the luminance of n pixels of row y starting at column x */
+void frame_lum_row(frame_struct *frame, int x, int y, int n, luminance_t lt,
+                   int *lum)
+{
+  const unsigned char *row, *uv;
+  const int *lut;
+  Imlib_Color color;
+  int i, bit, offset, step;
+
+  x += frame->x0;
+  row = frame->data + (size_t)(frame->y0 + y) * frame->stride;
+  if(frame_lum_byte(frame, lt, &offset, &step)) {
+    /* one byte per pixel determines the luminance */
+    lut = frame_lum_lut(frame, lt);
+    row += offset + (size_t)x * step;
+    for(i = 0; i < n; i++, row += step) {
+      lum[i] = lut[*row];
+    }
+    return;
+  }
+  switch(frame->fmt) {
+    case FRAME_MONO1:
+      lut = frame_lum_lut(frame, lt);
+      for(i = 0; i < n; i++, x++) {
+        bit = (row[x >> 3] >> (7 - (x & 7))) & 1;
+        lum[i] = lut[bit ? 0 : MAXRGB];
+      }
+      break;
+    case FRAME_RGB24:
+      row += 3 * x;
+      color.alpha = MAXRGB;
+      for(i = 0; i < n; i++, row += 3) {
+        color.red = row[0];
+        color.green = row[1];
+        color.blue = row[2];
+        lum[i] = get_lum(&color, lt);
+      }
+      break;
+    default:
+      uv = frame_uv_row(frame, y);
+      for(i = 0; i < n; i++, x++) {
+        frame_color(frame, row, uv, x, &color);
+        lum[i] = get_lum(&color, lt);
+      }
+      break;
+  }
+}
+
+/* adjust a crop rectangle to an image of width x height pixels exactly like
+ * crop() does, return 0 if the result is inside the image or -1 if not */
+int crop_rect(int width, int height, int *x, int *y, int *w, int *h)
+{
+  /* get sane values, exactly like crop() */
+  if(*x < 0) *x = 0;
+  if(*y < 0) *y = 0;
+  if(*x >= width) *x = width - 1;
+  if(*y >= height) *y = height - 1;
+  if(*x + *w > width) *w = width - *x;
+  if(*y + *h > height) *h = height - *x;
+
+  if(*x < 0 || *y < 0 || *w <= 0 || *h <= 0 ||
+     *x + *w > width || *y + *h > height) {
+    return -1;
+  }
+  return 0;
+}
+
+/* crop the view like crop() crops an image, return 0 on success or -1 if the
+ * crop would extend beyond the frame (the frame is not changed then) */
+int frame_crop(frame_struct *frame, int x, int y, int w, int h)
+{
+  /* leave anything but a proper sub-rectangle to Imlib2 */
+  if(crop_rect(frame->w, frame->h, &x, &y, &w, &h) < 0) return -1;
+  frame->x0 += x;
+  frame->y0 += y;
+  frame->w = w;
+  frame->h = h;
+  frame->partial = 0;
+
+  return 0;
+}
+
+/* create an Imlib2 image from the view of a frame, reusing an image of the
+ * buffer pool */
+Imlib_Image frame_to_image(frame_struct *frame)
+{
+  Imlib_Image current_image; /* save image pointer */
+  Imlib_Image image;
+  DATA32 *data, *p;
+  const unsigned char *row, *uv;
+  Imlib_Color color;
+  int x, y;
+
+  /* save pointer to current image */
+  current_image = imlib_context_get_image();
+
+  image = pool_create_image(frame->w, frame->h);
+  imlib_context_set_image(image);
+  p = data = imlib_image_get_data();
+  for(y = 0; y < frame->h; y++) {
+    row = frame->data + (size_t)(frame->y0 + y) * frame->stride;
+    uv = frame_uv_row(frame, y);
+    for(x = frame->x0; x < frame->x0 + frame->w; x++) {
+      frame_color(frame, row, uv, x, &color);
+      *p++ = 0xff000000 | (color.red << 16) | (color.green << 8) | color.blue;
+    }
+  }
+  imlib_image_put_back_data(data);
+
+  /* restore image from before function call */
+  imlib_context_set_image(current_image);
+
+  return image;
+}
+
+/* compute threshold like get_threshold() */
+double frame_get_threshold(frame_struct *frame, double fraction,
+                           luminance_t lt, int x, int y, int w, int h)
+{
+  int width = frame->w, height = frame->h; /* image dimensions */
+  int xi, yi, n; /* iteration variables, pixels per row */
+  int *lum; /* luminance of pixels of one row */
+  double minval=(double)MAXRGB, maxval=0.0;
+
+  /* special value -1 for width or height means image width/height,
+   * including the quirk of get_threshold() */
+  if(w == -1) w = width;
+  if(h == -1) h = width;
+
+  /* assure valid coordinates */
+  if(x+w > width) x = width-w;
+  if(y+h > height) y = height-h;
+  if(x<0) x=0;
+  if(y<0) y=0;
+
+  n = (w < width - x) ? w : width - x;
+  if(n <= 0) return minval * 100 / MAXRGB;
+  lum = pool_buf(BUF_FRAME_ROW, n, sizeof(int));
+  for(yi=0; (yi<h) && (yi<height) && (y+yi<height); yi++) {
+    frame_lum_row(frame, x, y+yi, n, lt, lum);
+    for(xi=0; xi<n; xi++) {
+      if(lum[xi] < minval) minval = lum[xi];
+      if(lum[xi] > maxval) maxval = lum[xi];
+    }
+  }
+
+  return (minval + fraction * (maxval - minval)) * 100 / MAXRGB;
+}
+
+/* build the histogram of the clipped luminance values of the view */
+static void frame_histogram(frame_struct *frame, luminance_t lt,
+                            unsigned long int *hist)
+{
+  int x, y, v, offset, step;
+  int *lum;
+  const int *lut;
+  const unsigned char *row;
+  unsigned long int count[MAXRGB+1]; /* number of pixels per byte value */
+
+  memset(hist, 0, (MAXRGB+1) * sizeof(unsigned long int));
+  if(frame->w <= 0) return;
+  if(frame_lum_byte(frame, lt, &offset, &step)) {
+    /* count gray values, palette indices, or luma values, then convert at
+     * most 256 of them to luminance */
+    memset(count, 0, sizeof(count));
+    for(y = 0; y < frame->h; y++) {
+      row = frame->data + (size_t)(frame->y0 + y) * frame->stride + offset +
+            (size_t)frame->x0 * step;
+      for(x = 0; x < frame->w; x++, row += step) {
+        count[*row]++;
+      }
+    }
+    lut = frame_lum_lut(frame, lt);
+    for(v = 0; v <= MAXRGB; v++) {
+      hist[clip(lut[v], 0, MAXRGB)] += count[v];
+    }
+    return;
+  }
+  lum = pool_buf(BUF_FRAME_ROW, frame->w, sizeof(int));
+  for(y = 0; y < frame->h; y++) {
+    frame_lum_row(frame, 0, y, frame->w, lt, lum);
+    for(x = 0; x < frame->w; x++) {
+      hist[clip(lum[x], 0, MAXRGB)]++;
+    }
+  }
+}
+
+/* check if the view contains exactly two luminance values, i.e., if it is a
+ * bilevel image, return 1 and set lo and hi to the two values if it is,
+ * return 0 otherwise */
+int frame_bilevel(frame_struct *frame, luminance_t lt, int *lo, int *hi)
+{
+  int x, y, l, n = 0;
+  int val[2]; /* luminance values found so far */
+  int *lum;
+
+  if(frame->w <= 0) return 0;
+  lum = pool_buf(BUF_FRAME_ROW, frame->w, sizeof(int));
+  /* stop at the first pixel with a third luminance value */
+  for(y = 0; y < frame->h; y++) {
+    frame_lum_row(frame, 0, y, frame->w, lt, lum);
+    for(x = 0; x < frame->w; x++) {
+      l = clip(lum[x], 0, MAXRGB);
+      if((n > 0 && l == val[0]) || (n > 1 && l == val[1])) continue;
+      if(n == 2) return 0;
+      val[n++] = l;
+    }
+  }
+  if(n < 2) return 0;
+  *lo = (val[0] < val[1]) ? val[0] : val[1];
+  *hi = (val[0] < val[1]) ? val[1] : val[0];
+  return 1;
+}
+
+/* compute threshold like iterative_threshold() */
+double frame_iterative_threshold(frame_struct *frame, double thresh,
+                                 luminance_t lt)
+{
+  unsigned long int hist[MAXRGB+1]; /* number of pixels per luminance */
+
+  frame_histogram(frame, lt, hist);
+  return iterative_threshold_hist(hist, thresh);
+}
+
+/* get minimum and maximum luminance like get_minmaxval() */
+void frame_minmaxval(frame_struct *frame, luminance_t lt,
+                     double *min, double *max)
+{
+  unsigned long int hist[MAXRGB+1]; /* number of pixels per luminance */
+  int lum;
+
+  *min = MAXRGB;
+  *max = 0;
+  frame_histogram(frame, lt, hist);
+  for(lum = 0; lum <= MAXRGB; lum++) {
+    if(hist[lum]) {
+      if(lum < *min) *min = lum;
+      if(lum > *max) *max = lum;
+    }
+  }
+}
@@ -0,0 +1,119 @@
+/* Seven Segment Optical Character Recognition Frame Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_FRAME_H
+#define SSOCR2_FRAME_H
+
+/* pixel formats of frames */
+typedef enum frame_fmt_e {
+  FRAME_MONO1,  /* 1 bit per pixel, 1 is black, rows padded to full bytes */
+  FRAME_GRAY8,  /* 8 bit gray value per pixel */
+  FRAME_RGB24,  /* 8 bit each of red, green, and blue per pixel */
+  FRAME_PAL8,   /* 8 bit index into a palette of RGB colors per pixel */
+  FRAME_GRAY16, /* 16 bit little endian gray value per pixel */
+  FRAME_BGRA32, /* 8 bit each of blue, green, red, and alpha per pixel */
+  FRAME_RGB565, /* 16 bit little endian, 5 bit red, 6 bit green, 5 bit blue */
+  FRAME_YUYV,   /* packed YUV 4:2:2, Y0 U Y1 V for every two pixels */
+  FRAME_NV12    /* planar Y followed by interleaved U V at half resolution */
+} frame_fmt_t;
+
+/* an image decoded without Imlib2, i.e., a view of pixel data in memory
+ * (usually a memory mapped file or a buffer holding data read from stdin),
+ * a frame of which only the area of a crop command has been decoded has the
+ * dimensions of the whole image with x0 and y0 <= 0 and partial set, i.e.,
+ * its pixel data may be used only after cropping to that area */
+typedef struct {
+  frame_fmt_t fmt;            /* pixel format */
+  int w, h;                   /* dimensions of the (cropped) view */
+  int x0, y0;                 /* position of the view inside the pixel data */
+  int partial;                /* has only the area of a crop been decoded? */
+  size_t stride;              /* bytes per row of pixel data */
+  const unsigned char *data;  /* pixel data of the complete frame */
+  const unsigned char *uv;    /* chroma plane of an NV12 frame (same stride) */
+  void *map;                  /* memory mapping holding the data, or NULL */
+  size_t map_len;             /* length of memory mapping */
+  unsigned char *buf;         /* allocated memory holding the data, or NULL */
+  size_t buf_size;            /* size of allocated memory */
+  unsigned char palette[MAXRGB+1][3]; /* RGB colors of palette entries */
+  int lum_lut[MAXRGB+1];      /* luminance of gray values or palette entries */
+  luminance_t lut_lt;         /* luminance formula used for lum_lut */
+  int lut_valid;              /* is lum_lut valid? (reset if palette changes) */
+} frame_struct;
+
+/* functions */
+
+/* create an empty frame, e.g., to read a stream of frames into */
+frame_struct *new_frame(void);
+
+/* free a frame including the memory holding its pixel data */
+void free_frame(frame_struct *frame);
+
+/* return the luminance of every possible byte value of a frame using one byte
+ * per pixel, i.e., of every gray value or palette entry */
+const int *frame_lum_lut(frame_struct *frame, luminance_t lt);
+
+/* check if the luminance of a pixel is given by one byte, i.e., a gray value,
+ * a palette index, the high byte of a 16 bit gray value, or luma Y used for a
+ * luminance formula of the Y kind, return 1 and set the offset of that byte
+ * for pixel 0 and the step in bytes from pixel to pixel if it is, 0 if not */
+int frame_lum_byte(const frame_struct *frame, luminance_t lt,
+                   int *offset, int *step);
+
+/* return the number of bytes of one row of w pixels of the given format */
+size_t frame_row_len(frame_fmt_t fmt, int w);
+
+/* compute the luminance of n pixels of row y starting at column x */
+void frame_lum_row(frame_struct *frame, int x, int y, int n, luminance_t lt,
+                   int *lum);
+
+/* adjust a crop rectangle to an image of width x height pixels exactly like
+ * crop() does, return 0 if the result is inside the image or -1 if not */
+int crop_rect(int width, int height, int *x, int *y, int *w, int *h);
+
+/* crop the view like crop() crops an image, return 0 on success or -1 if the
+ * crop would extend beyond the frame (the frame is not changed then) */
+int frame_crop(frame_struct *frame, int x, int y, int w, int h);
+
+/* create an Imlib2 image from the view of a frame, reusing an image of the
+ * buffer pool */
+Imlib_Image frame_to_image(frame_struct *frame);
+
+/* compute threshold like get_threshold() */
+double frame_get_threshold(frame_struct *frame, double fraction,
+                           luminance_t lt, int x, int y, int w, int h);
+
+/* check if the view contains exactly two luminance values, i.e., if it is a
+ * bilevel image, return 1 and set lo and hi to the two values if it is,
+ * return 0 otherwise */
+int frame_bilevel(frame_struct *frame, luminance_t lt, int *lo, int *hi);
+
+/* compute threshold like iterative_threshold() */
+double frame_iterative_threshold(frame_struct *frame, double thresh,
+                                 luminance_t lt);
+
+/* get minimum and maximum luminance like get_minmaxval() */
+void frame_minmaxval(frame_struct *frame, luminance_t lt,
+                     double *min, double *max);
+
+/* adapt threshold to frame like adapt_threshold() adapts it to an image
+ * (implemented in imgproc.c to share the adaptation logic) */
+double adapt_threshold_frame(frame_struct *frame, double thresh,
+                             luminance_t lt, unsigned int flags,
+                             int force_update, int *is_adapted);
+
+#endif /* SSOCR2_FRAME_H */
@@ -0,0 +1,272 @@
+/* Seven Segment Optical Character Recognition GIF Loading Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* FILE, fopen, getc, fread, fclose, perror */
+#include <stdlib.h>         /* calloc, realloc, free, exit */
+#include <string.h>         /* memcmp, memcpy */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "gif.h"            /* GIF loading */
+
+/* GIF block types and extension labels */
+#define GIF_EXTENSION 0x21
+#define GIF_IMAGE 0x2C
+#define GIF_GRAPHIC_CONTROL 0xF9
+
+/* LZW codes have at most 12 bits */
+#define GIF_MAX_CODES 4096
+
+/* functions */
+
+/* read a little endian 16 bit number, return -1 at the end of the file */
+static int gif_read16(FILE *f)
+{
+  int lo, hi;
+
+  if((lo = getc(f)) == EOF || (hi = getc(f)) == EOF) return -1;
+  return lo | (hi << 8);
+}
+
+/* read a color table of n entries into the palette of frame,
+ * return 0 on success or -1 at the end of the file */
+static int gif_read_palette(FILE *f, frame_struct *frame, int n)
+{
+  unsigned char rgb[3];
+  int i;
+
+  for(i = 0; i < n; i++) {
+    if(fread(rgb, 1, 3, f) != 3) return -1;
+    frame->palette[i][0] = rgb[0];
+    frame->palette[i][1] = rgb[1];
+    frame->palette[i][2] = rgb[2];
+  }
+  return 0;
+}
+
+/* read a sequence of data sub-blocks, appending the data to *buf if buf is
+ * not NULL, return the number of bytes or -1 at the end of the file */
+static long gif_read_blocks(FILE *f, unsigned char **buf, size_t *size)
+{
+  unsigned char block[MAXRGB];
+  long len = 0;
+  int n;
+
+  while((n = getc(f)) != EOF) {
+    if(n == 0) return len;
+    if(fread(block, 1, n, f) != (size_t)n) return -1;
+    if(buf) {
+      if(len + n > (long)*size) {
+        unsigned char *b;
+        size_t s = *size ? 2 * *size : BUFSIZ;
+        if(!(b = realloc(*buf, s))) {
+          perror(PROG ": buf = realloc()");
+          exit(99);
+        }
+        *buf = b;
+        *size = s;
+      }
+      memcpy(*buf + len, block, n);
+    }
+    len += n;
+  }
+  return -1;
+}
+
+/* return the row of the n-th row stored in an image of height h */
+static int gif_row(int n, int h, int interlaced)
+{
+  if(!interlaced) return n;
+  /* pass 1: every 8th row from 0, pass 2: every 8th row from 4,
+   * pass 3: every 4th row from 2, pass 4: every 2nd row from 1 */
+  if(n < (h + 7) / 8) return 8 * n;
+  n -= (h + 7) / 8;
+  if(n < (h + 3) / 8) return 8 * n + 4;
+  n -= (h + 3) / 8;
+  if(n < (h + 1) / 4) return 4 * n + 2;
+  n -= (h + 1) / 4;
+  return 2 * n + 1;
+}
+
+/* decode LZW compressed data into w x h palette indices,
+ * return 0 on success or -1 if the data is not valid */
+static int gif_lzw(const unsigned char *data, long len, int min_size,
+                   unsigned char *pixels, int w, int h, int interlaced)
+{
+  unsigned short prefix[GIF_MAX_CODES];
+  unsigned char suffix[GIF_MAX_CODES];
+  unsigned char stack[GIF_MAX_CODES];
+  int clear = 1 << min_size, eoi = clear + 1;
+  int next = clear + 2, size = min_size + 1;
+  int code, c, prev = -1, first = 0, sp;
+  unsigned long bits = 0; /* bit buffer, codes are stored LSB first */
+  int nbits = 0;
+  long pos = 0;
+  size_t npix = (size_t)w * h, p = 0;
+  int x = 0, n = 0; /* column and number of the current row */
+  unsigned char *row = pixels + (size_t)gif_row(0, h, interlaced) * w;
+
+  for(c = 0; c < clear; c++) {
+    suffix[c] = c;
+  }
+  while(p < npix) {
+    while(nbits < size) {
+      if(pos >= len) return -1;
+      bits |= (unsigned long)data[pos++] << nbits;
+      nbits += 8;
+    }
+    code = bits & ((1 << size) - 1);
+    bits >>= size;
+    nbits -= size;
+
+    if(code == clear) {
+      next = clear + 2;
+      size = min_size + 1;
+      prev = -1;
+      continue;
+    }
+    if(code == eoi) break;
+    sp = 0;
+    if(prev < 0) {
+      if(code >= clear) return -1;
+      stack[sp++] = first = code;
+    } else {
+      if(code > next || (code == next && next >= GIF_MAX_CODES)) return -1;
+      /* a code not yet in the table is the previous string plus its first
+       * character */
+      if(code == next) {
+        stack[sp++] = first;
+        c = prev;
+      } else {
+        c = code;
+      }
+      while(c >= clear) {
+        stack[sp++] = suffix[c];
+        c = prefix[c];
+      }
+      stack[sp++] = first = c;
+      if(next < GIF_MAX_CODES) {
+        prefix[next] = prev;
+        suffix[next] = first;
+        next++;
+        if(next == (1 << size) && size < 12) size++;
+      }
+    }
+    prev = code;
+    /* the string is on the stack in reverse order */
+    while(sp > 0 && p < npix) {
+      row[x++] = stack[--sp];
+      p++;
+      if(x == w && p < npix) {
+        x = 0;
+        row = pixels + (size_t)gif_row(++n, h, interlaced) * w;
+      }
+    }
+  }
+  return (p < npix) ? -1 : 0;
+}
+
+/* decode the first image following the GIF header into frame,
+ * return 0 on success or -1 if the image is not supported */
+static int gif_decode(FILE *f, frame_struct *frame, unsigned char **data,
+                      size_t *data_size)
+{
+  int width, height, flags, block, label, min_size;
+  int x, y, w, h, interlaced;
+  long len;
+
+  /* logical screen descriptor with optional global color table */
+  width = gif_read16(f);
+  height = gif_read16(f);
+  if((flags = getc(f)) == EOF || getc(f) == EOF || getc(f) == EOF) return -1;
+  if(width <= 0 || height <= 0) return -1;
+  if((flags & 0x80) && gif_read_palette(f, frame, 2 << (flags & 7)) < 0)
+    return -1;
+
+  while((block = getc(f)) == GIF_EXTENSION) {
+    if((label = getc(f)) == EOF) return -1;
+    /* transparent pixels are left to Imlib2 */
+    if(label == GIF_GRAPHIC_CONTROL) {
+      int n = getc(f), packed = getc(f);
+      if(n < 1 || packed == EOF || (packed & 1)) return -1;
+      if(fseek(f, n - 1, SEEK_CUR) != 0) return -1;
+    }
+    if(gif_read_blocks(f, NULL, NULL) < 0) return -1;
+  }
+  if(block != GIF_IMAGE) return -1;
+
+  /* image descriptor with optional local color table */
+  x = gif_read16(f);
+  y = gif_read16(f);
+  w = gif_read16(f);
+  h = gif_read16(f);
+  if((flags = getc(f)) == EOF) return -1;
+  if(x != 0 || y != 0 || w != width || h != height) return -1;
+  interlaced = flags & 0x40;
+  if((flags & 0x80) && gif_read_palette(f, frame, 2 << (flags & 7)) < 0)
+    return -1;
+  if((min_size = getc(f)) == EOF || min_size < 2 || min_size > 8) return -1;
+  if((len = gif_read_blocks(f, data, data_size)) < 0) return -1;
+
+  frame->buf_size = (size_t)w * h;
+  if(!(frame->buf = calloc(frame->buf_size, 1))) {
+    perror(PROG ": frame->buf = calloc()");
+    exit(99);
+  }
+  if(gif_lzw(*data, len, min_size, frame->buf, w, h, interlaced) < 0)
+    return -1;
+  frame->fmt = FRAME_PAL8;
+  frame->w = w;
+  frame->h = h;
+  frame->stride = w;
+  frame->data = frame->buf;
+  return 0;
+}
+
+/* decode the first image of a GIF file into a frame of palette indices,
+ * return NULL if the file is not supported (Imlib2 shall try), i.e., if the
+ * image does not cover the whole logical screen or uses transparency */
+frame_struct *gif_load_file(const char *filename)
+{
+  FILE *f;
+  unsigned char header[6];
+  unsigned char *data = NULL; /* LZW compressed image data */
+  size_t data_size = 0;
+  frame_struct *frame;
+
+  if(!(f = fopen(filename, "rb"))) return NULL;
+  if(fread(header, 1, 6, f) != 6 || (memcmp(header, "GIF87a", 6) != 0 &&
+                                     memcmp(header, "GIF89a", 6) != 0)) {
+    fclose(f);
+    return NULL;
+  }
+  frame = new_frame();
+  if(gif_decode(f, frame, &data, &data_size) < 0) {
+    free_frame(frame);
+    frame = NULL;
+  }
+  free(data);
+  fclose(f);
+  return frame;
+}
@@ -0,0 +1,29 @@
+/* Seven Segment Optical Character Recognition GIF Loading Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_GIF_H
+#define SSOCR2_GIF_H
+
+/* functions */
+
+/* decode the first image of a GIF file into a frame of palette indices,
+ * return NULL if the file is not supported (Imlib2 shall try), i.e., if the
+ * image does not cover the whole logical screen or uses transparency */
+frame_struct *gif_load_file(const char *filename);
+
+#endif /* SSOCR2_GIF_H */
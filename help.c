@@ -24,8 +24,8 @@
 #include "defines.h"        /* defines */
 
 /* global variables */
-extern int ssocr_foreground;
-extern int ssocr_background;
+extern _Thread_local int ssocr_foreground;
+extern _Thread_local int ssocr_background;
 
 /* functions */
 
@@ -112,6 +112,10 @@ void usage(char *name, FILE *f)
 {
   print_version(f);
   fprintf(f, "\nUsage: %s [OPTION]... [COMMAND]... IMAGE\n", name);
+  fprintf(f, "       %s -U [OPTION]... [COMMAND]... [IMAGE]...\n", name);
+  fprintf(f, "       %s --serve=SOCKET [-v]\n", name);
+  fprintf(f, "       %s --client SOCKET [OPTION]... [COMMAND]... IMAGE\n", name);
+  fprintf(f, "       %s --streams=FILE [-v] [-j N]\n", name);
   fprintf(f, "\nOptions: -h, --help               print this message\n");
   fprintf(f, "         -v, --verbose            talk about program execution\n");
   fprintf(f, "         -V, --version            print version information\n");
@@ -119,10 +123,14 @@ void usage(char *name, FILE *f)
   fprintf(f, "                                  from white\n");
   fprintf(f, "         -a, --absolute-threshold don't adjust threshold to image\n");
   fprintf(f, "         -T, --iter-threshold     use iterative thresholding method\n");
+  fprintf(f, "         -B, --bilevel            image is black and white, use fixed threshold\n");
   fprintf(f, "         -n, --number-pixels=#    number of pixels needed to recognize a segment\n");
   fprintf(f, "         -N, --min-segment=SIZE   minimum width and height of a segment\n");
+  fprintf(f, "         -R, --segment-fill=PCT   recognize segments by percentage of set\n");
+  fprintf(f, "                                  pixels in segment areas\n");
   fprintf(f, "         -i, --ignore-pixels=#    number of pixels ignored when searching digit\n");
   fprintf(f, "                                  boundaries\n");
+  fprintf(f, "         -K, --components         segment image using connected components\n");
   fprintf(f, "         -M, --min-char-dims=WxH  minimum width and height of a character/digit\n");
   fprintf(f, "         -d, --number-digits=RNG  number of digits in image (-1 for auto,\n");
   fprintf(f, "                                  positive number, or positive range)\n");
@@ -153,6 +161,42 @@ void usage(char *name, FILE *f)
   fprintf(f, "                                  use -c help for list of KEYWORDS\n");
   fprintf(f, "         -F, --adapt-after-crop   do not adapt threshold to image directly\n"
              "                                  before, only after, cropping\n");
+  fprintf(f, "         -e, --stream             process a stream of binary PNM images, a\n"
+             "                                  YUV4MPEG2 stream, or an MJPEG stream (IMAGE\n"
+             "                                  is the stream file, FIFO, or - for STDIN)\n");
+  fprintf(f, "         -k, --shm-ring           process the frames written to the POSIX\n"
+             "                                  shared memory frame ring IMAGE in place\n");
+  fprintf(f, "         -J, --jpeg-scale=DENOM   decode MJPEG frames scaled by 1/DENOM\n"
+             "                                  (1, 2, 4, or 8)\n");
+  fprintf(f, "         -z, --queue-depth=N      decode, recognize, and print up to N frames\n"
+             "                                  of a stream at the same time (%d)\n",
+             PIPELINE_DEPTH);
+  fprintf(f, "         -Z, --affinity=D,P,O     run the decoder, processor, and output\n"
+             "                                  threads of a stream on CPUs D, P, and O\n");
+  fprintf(f, "         -Y, --skip-unchanged=TOL repeat the result of the last recognized\n"
+             "                                  frame if at most TOL pixels differ after\n"
+             "                                  the geometric commands\n");
+  fprintf(f, "             --changes-only       print nothing for frames skipped by -Y\n");
+  fprintf(f, "         -U, --batch              process many images, the commands are\n"
+             "                                  followed by any number of IMAGEs\n");
+  fprintf(f, "         -L, --file-list=FILE     process the images named in FILE, one per\n"
+             "                                  line, - for STDIN (implies --batch)\n");
+  fprintf(f, "         -j, --jobs=N             process images of a batch with N threads\n"
+             "                                  (0 for one per processor)\n");
+  fprintf(f, "         -y, --threads=N          process the rows of an image with N threads\n"
+             "                                  (0 for one per processor)\n");
+  fprintf(f, "         -u, --unordered          print results of a batch as soon as they\n"
+             "                                  are available, not in input order\n");
+  fprintf(f, "         -Q, --serve=SOCKET       answer requests of clients as a daemon\n"
+             "                                  listening on Unix domain socket SOCKET\n");
+  fprintf(f, "         -q, --client SOCKET      let the daemon at SOCKET process the other\n"
+             "                                  arguments (must be the first option)\n");
+  fprintf(f, "         -E, --streams=FILE       read the PNM streams named in FILE, one per\n"
+             "                                  line with its own options and commands\n");
+  fprintf(f, "         -w, --backlog=N          queue up to N frames of a stream (%d)\n",
+             STREAM_BACKLOG);
+  fprintf(f, "         -x, --drop-oldest        drop the oldest queued frame of a stream\n"
+             "                                  instead of pausing the stream if it is full\n");
   fprintf(f, "\nCommands: dilation [N]            [N times] dilation algorithm"
              "\n                                  (set_pixels_filter with mask"
              " of 1 pixel)\n");
@@ -164,6 +208,8 @@ void usage(char *name, FILE *f)
   fprintf(f, "          opening [N]             opening algorithm\n");
   fprintf(f, "                                  ([N times] erosion then [N times] dilation)\n");
   fprintf(f, "          remove_isolated         remove isolated pixels\n");
+  fprintf(f, "          remove_small_blobs AREA remove connected components of less than\n");
+  fprintf(f, "                                  AREA pixels\n");
   fprintf(f, "          make_mono               make image monochrome\n");
   fprintf(f, "          grayscale               transform image to grayscale\n");
   fprintf(f, "          invert                  make inverted monochrome image\n");
@@ -191,6 +237,7 @@ void usage(char *name, FILE *f)
   fprintf(f, "                                  pixels set (not counting the checked pixel)\n");
   fprintf(f, "\nDefaults: needed pixels                         = %2d\n", NEED_PIXELS);
   fprintf(f, "          minimum segment size                  = %2d\n", MIN_SEGMENT);
+  fprintf(f, "          segment area fill percentage          = %2d\n", SEGMENT_FILL);
   fprintf(f, "          minimum character width               = %2d\n", MIN_CHAR_W);
   fprintf(f, "          minimum character height              = %2d\n", MIN_CHAR_H);
   fprintf(f, "          ignored pixels                        = %2d\n", IGNORE_PIXELS);
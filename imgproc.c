@@ -25,7 +25,7 @@
 #include <stdlib.h>         /* exit */
 
 /* string manipulation */
-#include <string.h>         /* strcasecmp, strcmp, strrchr */
+#include <string.h>         /* strcasecmp, strcmp, strrchr, memset, memcpy */
 
 /* trigonometry */
 #include <math.h>           /* sin, cos, M_PI */
@@ -37,10 +37,17 @@
 #include "defines.h"        /* defines */
 #include "imgproc.h"        /* image processing */
 #include "help.h"           /* online help */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+#include "rle.h"            /* run-length encoding */
+#include "bufpool.h"        /* buffer pool */
+#include "bands.h"          /* parallel bands */
 
 /* global variables */
-extern int ssocr_foreground;
-extern int ssocr_background;
+extern _Thread_local int ssocr_foreground;
+extern _Thread_local int ssocr_background;
+extern _Thread_local int ssocr_threads;
 
 /* functions */
 
@@ -58,6 +65,12 @@ void set_bg_color(int color)
   ssocr_background = color;
 }
 
+/* set number of threads processing an image */
+void set_threads(int threads)
+{
+  ssocr_threads = threads;
+}
+
 /* set imlib color */
 void ssocr_set_color(fg_bg_t color)
 {
@@ -140,52 +153,365 @@ int is_pixel_set(int value, double threshold)
   }
 }
 
+/*** row bands ***/
+
+/* The pixel loops of the image processing functions work on the pixel data
+ * of the images directly instead of using Imlib2 per pixel.  The rows of an
+ * image are split into horizontal bands, every band is processed by its own
+ * thread (see bands.h).  Neighborhood filters read the rows adjacent to their
+ * band (the halo) from the unchanged source image.  The band threads must
+ * neither use Imlib2 nor the thread local colors and buffer pool, thus
+ * everything they need is prepared in a filter_job_struct beforehand. */
+
+/* what the threads processing the bands of an image need to know */
+typedef struct {
+  const DATA32 *src;          /* pixel data of the source image */
+  DATA32 *dst;                /* pixel data of the new image */
+  int w, h;                   /* dimensions of both images */
+  luminance_t lt;             /* luminance formula */
+  unsigned char set[MAXRGB+1]; /* is a pixel of this luminance set? */
+  int black;                  /* is the foreground black? */
+  DATA32 fg, bg;              /* foreground and background pixel values */
+  int mask;                   /* mask of set and keep pixels filters */
+  int keep;                   /* keep pixels instead of set pixels filter? */
+  int stretch;                /* gray stretching instead of grayscale? */
+  double t1, t2;              /* gray stretching thresholds */
+  double fraction;            /* dynamic threshold fraction */
+  int ww, wh;                 /* dynamic threshold window */
+  const unsigned char *lum;   /* luminance of every pixel (or NULL) */
+  unsigned char *lum_dst;     /* store luminance of every pixel here */
+  unsigned char *neighbors;   /* thresholded rows of the bands and halos */
+  int x, rw;                  /* columns examined for the minimum/maximum */
+} filter_job_struct;
+
+/* a band of rows processed by one thread and its results */
+typedef struct band_s {
+  const filter_job_struct *job; /* the image */
+  void (*fn)(struct band_s *band); /* process the band */
+  int b;                      /* number of the band */
+  int y0, y1;                 /* first row and row after the band */
+  unsigned long int hist[MAXRGB+1]; /* luminance histogram of the band */
+  double min, max;            /* minimum and maximum luminance of the band */
+  int translucent;            /* has the band pixels that are not opaque? */
+} band_struct;
+
+/* luminance of a pixel of Imlib2 pixel data */
+static int pixel_lum(DATA32 pixel, luminance_t lt)
+{
+  Imlib_Color color;
+
+  color.alpha = (pixel >> 24) & 0xff;
+  color.red = (pixel >> 16) & 0xff;
+  color.green = (pixel >> 8) & 0xff;
+  color.blue = pixel & 0xff;
+  return get_lum(&color, lt);
+}
+
+/* prepare a job for source_image, set the current image to source_image */
+static void init_filter_job(filter_job_struct *job, Imlib_Image *source_image,
+                            double thresh, luminance_t lt)
+{
+  int lum;
+
+  memset(job, 0, sizeof(filter_job_struct));
+  imlib_context_set_image(*source_image);
+  job->w = imlib_image_get_width();
+  job->h = imlib_image_get_height();
+  job->src = imlib_image_get_data_for_reading_only();
+  job->lt = lt;
+  /* decide once for every possible luminance value if it is set */
+  for(lum = 0; lum <= MAXRGB; lum++) {
+    job->set[lum] = is_pixel_set(lum, thresh);
+  }
+  job->black = (ssocr_foreground == SSOCR_BLACK);
+  job->fg = 0xff000000 | (ssocr_foreground << 16) | (ssocr_foreground << 8)
+            | ssocr_foreground;
+  job->bg = 0xff000000 | (ssocr_background << 16) | (ssocr_background << 8)
+            | ssocr_background;
+}
+
+/* create the new image of a job as a copy of the source image, set the current
+ * image to the new image, the pixel data must be put back afterwards */
+static Imlib_Image new_filter_image(filter_job_struct *job)
+{
+  Imlib_Image new_image;
+
+  new_image = pool_clone_image();
+  imlib_context_set_image(new_image);
+  job->dst = imlib_image_get_data();
+  return new_image;
+}
+
+/* process one band of a job */
+static void filter_band(void *arg, int b, int y0, int y1)
+{
+  band_struct *bands = arg;
+
+  bands[b].b = b;
+  bands[b].y0 = y0;
+  bands[b].y1 = y1;
+  bands[b].fn(bands + b);
+}
+
+/* process rows y0 to y1-1 of the job in bands using fn, return the bands
+ * (valid until the next call) and their number in nbands (unless NULL) */
+static band_struct *filter_bands(const filter_job_struct *job,
+                                 void (*fn)(band_struct *band), int y0, int y1,
+                                 int *nbands)
+{
+  band_struct *bands;
+  int n, i;
+
+  n = count_bands(y1 - y0, BAND_ROWS);
+  bands = pool_buf_zero(BUF_BANDS, n, sizeof(band_struct));
+  for(i = 0; i < n; i++) {
+    bands[i].job = job;
+    bands[i].fn = fn;
+    bands[i].min = MAXRGB;
+    bands[i].max = 0;
+  }
+  run_bands(n, y0, y1, filter_band, bands);
+  if(nbands) *nbands = n;
+  return bands;
+}
+
+/* threshold every pixel of the band (make_mono, invert) */
+static void mono_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  size_t i, end = (size_t)band->y1 * job->w;
+
+  for(i = (size_t)band->y0 * job->w; i < end; i++) {
+    job->dst[i] = job->set[clip(pixel_lum(job->src[i], job->lt), 0, MAXRGB)]
+                  ? job->fg : job->bg;
+  }
+}
+
+/* reserve the thresholded rows of the bands of a neighborhood filter, every
+ * band gets its rows and the rows above and below */
+static void alloc_neighbors(filter_job_struct *job)
+{
+  size_t rows = (size_t)job->h + 2 * count_bands(job->h, BAND_ROWS);
+
+  job->neighbors = pool_buf(BUF_NEIGHBORS, rows * job->w,
+                            sizeof(unsigned char));
+}
+
+/* set or keep pixels depending on their 3x3 neighborhood, the rows next to
+ * the band (inside the image) are thresholded, too */
+static void neighbor_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  unsigned char *set; /* thresholded rows y0-1 to y1 */
+  const unsigned char *row;
+  int x, y, i, j, n;
+  size_t k;
+
+  set = job->neighbors + ((size_t)band->y0 + 2 * band->b) * job->w;
+  for(y = band->y0 - 1; y <= band->y1; y++) {
+    if(y < 0 || y >= job->h) { /* not counted, as in the image */
+      memset(set + (size_t)(y - band->y0 + 1) * job->w, 0, job->w);
+      continue;
+    }
+    for(x = 0; x < job->w; x++) {
+      k = (size_t)y * job->w + x;
+      set[(size_t)(y - band->y0 + 1) * job->w + x] =
+        job->set[clip(pixel_lum(job->src[k], job->lt), 0, MAXRGB)];
+    }
+  }
+  for(y = band->y0; y < band->y1; y++) {
+    row = set + (size_t)(y - band->y0 + 1) * job->w;
+    for(x = 0; x < job->w; x++) {
+      n = 0;
+      /* the keep pixels filter tests neighbors of set pixels only */
+      if(!job->keep || row[x]) {
+        for(j = -1; j <= 1; j++) {
+          for(i = x-1; i <= x+1; i++) {
+            if(i >= 0 && i < job->w) n += row[j * job->w + i];
+          }
+        }
+      }
+      if(job->keep ? (n > job->mask) : (n >= job->mask)) {
+        job->dst[(size_t)y * job->w + x] = job->fg;
+      } else {
+        job->dst[(size_t)y * job->w + x] = job->bg;
+      }
+    }
+  }
+}
+
+/* gray value of a pixel of luminance lum (grayscale, gray_stretch) */
+static int gray_value(const filter_job_struct *job, int lum)
+{
+  if(!job->stretch) {
+    return clip(lum, 0, 255);
+  } else if(lum <= job->t1) {
+    return 0;
+  } else if(lum >= job->t2) {
+    return MAXRGB;
+  } else {
+    return clip(((lum-job->t1)*255)/(job->t2-job->t1), 0, 255);
+  }
+}
+
+/* convert the opaque pixels of the band to gray, Imlib2 blends pixels that
+ * are not opaque, thus they are left for the calling thread */
+static void gray_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  size_t i, end = (size_t)band->y1 * job->w;
+  DATA32 v;
+
+  for(i = (size_t)band->y0 * job->w; i < end; i++) {
+    if((job->src[i] >> 24) != 0xff) {
+      band->translucent = 1;
+      continue;
+    }
+    v = gray_value(job, pixel_lum(job->src[i], job->lt));
+    job->dst[i] = 0xff000000 | (v << 16) | (v << 8) | v;
+  }
+}
+
+/* convert the pixels that are not opaque to gray using Imlib2 */
+static void gray_translucent(const filter_job_struct *job,
+                             Imlib_Image *new_image)
+{
+  Imlib_Image current_image; /* save image pointer */
+  Imlib_Color color;
+  int x, y, v;
+
+  current_image = imlib_context_get_image();
+  imlib_context_set_image(*new_image);
+  for(y = 0; y < job->h; y++) {
+    for(x = 0; x < job->w; x++) {
+      DATA32 pixel = job->src[(size_t)y * job->w + x];
+      color.alpha = pixel >> 24;
+      if(color.alpha == 0xff) continue;
+      v = gray_value(job, pixel_lum(pixel, job->lt));
+      imlib_context_set_color(v, v, v, color.alpha);
+      imlib_image_draw_pixel(x, y, 0);
+    }
+  }
+  imlib_context_set_image(current_image);
+}
+
+/* store the luminance of every pixel of the band */
+static void lum_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  size_t i, end = (size_t)band->y1 * job->w;
+
+  for(i = (size_t)band->y0 * job->w; i < end; i++) {
+    job->lum_dst[i] = clip(pixel_lum(job->src[i], job->lt), 0, MAXRGB);
+  }
+}
+
+/* normalize the rectangle (x,y),(x+w,y+h) examined for a dynamic threshold
+ * to the part inside the image */
+static void threshold_rect(int width, int height, int *x, int *y, int *w,
+                           int *h)
+{
+  /* special value -1 for width or height means image width/height */
+  if(*w == -1) *w = width;
+  if(*h == -1) *h = width;
+
+  /* assure valid coordinates */
+  if(*x + *w > width) *x = width - *w;
+  if(*y + *h > height) *y = height - *h;
+  if(*x < 0) *x = 0;
+  if(*y < 0) *y = 0;
+  if(*w > width) *w = width;
+  if(*h > height) *h = height;
+}
+
+/* threshold every pixel of the band with the dynamic threshold of the window
+ * around it */
+static void dynamic_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  const unsigned char *row;
+  int x, y, wx, wy, ww, wh, xi, yi, lum;
+  double minval, maxval, thresh;
+
+  for(y = band->y0; y < band->y1; y++) {
+    for(x = 0; x < job->w; x++) {
+      /* the window is positioned as always, i.e., using ww for y, too */
+      wx = x - job->ww/2;
+      wy = y - job->ww/2;
+      ww = job->ww;
+      wh = job->wh;
+      threshold_rect(job->w, job->h, &wx, &wy, &ww, &wh);
+      minval = (double)MAXRGB;
+      maxval = 0.0;
+      for(yi = 0; yi < wh; yi++) {
+        row = job->lum + (size_t)(wy + yi) * job->w + wx;
+        for(xi = 0; xi < ww; xi++) {
+          if(row[xi] < minval) minval = row[xi];
+          if(row[xi] > maxval) maxval = row[xi];
+        }
+      }
+      thresh = (minval + job->fraction * (maxval - minval)) * 100 / MAXRGB;
+      lum = job->lum[(size_t)y * job->w + x];
+      if(job->black ? (lum < thresh/100.0*MAXRGB) :
+                      (lum >= thresh/100.0*MAXRGB)) {
+        job->dst[(size_t)y * job->w + x] = job->fg;
+      } else {
+        job->dst[(size_t)y * job->w + x] = job->bg;
+      }
+    }
+  }
+}
+
+/* find the minimum and maximum luminance of columns x to x+rw-1 of the band */
+static void minmax_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  const DATA32 *row;
+  int x, y, lum;
+
+  for(y = band->y0; y < band->y1; y++) {
+    row = job->src + (size_t)y * job->w + job->x;
+    for(x = 0; x < job->rw; x++) {
+      lum = clip(pixel_lum(row[x], job->lt), 0, MAXRGB);
+      if(lum < band->min) band->min = lum;
+      if(lum > band->max) band->max = lum;
+    }
+  }
+}
+
+/* count the pixels per luminance of the band */
+static void hist_band(band_struct *band)
+{
+  const filter_job_struct *job = band->job;
+  size_t i, end = (size_t)band->y1 * job->w;
+
+  for(i = (size_t)band->y0 * job->w; i < end; i++) {
+    band->hist[clip(pixel_lum(job->src[i], job->lt), 0, MAXRGB)]++;
+  }
+}
+
 /* set pixels that have at least mask pixels around it set (including the
  * examined pixel itself) to black (foreground), all other pixels to white
  * (background) */
 Imlib_Image set_pixels_filter(Imlib_Image *source_image, double thresh,
                               luminance_t lt, int mask)
 {
+  filter_job_struct job;
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y,i,j; /* iteration variables */
-  int set_pixel; /* should  pixel be set or not? */
-  Imlib_Color color;
-  int lum; /* luminance value of pixel */
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, thresh, lt);
+  new_image = new_filter_image(&job);
+  job.mask = mask;
+  alloc_neighbors(&job);
 
   /* check for every pixel if it should be set in filtered image */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      set_pixel=0;
-      for(i=x-1; i<=x+1; i++) {
-        for(j=y-1; j<=y+1; j++) {
-          if(i>=0 && i<width && j>=0 && j<height) { /* i,j inside image? */
-            imlib_image_query_pixel(i, j, &color);
-            lum = get_lum(&color, lt);
-            if(is_pixel_set(lum, thresh)) {
-              set_pixel++;
-            }
-          }
-        }
-      }
-      /* set pixel if at least mask pixels around it are set */
-      if(set_pixel >= mask) {
-        draw_fg_pixel(&new_image, x, y);
-      } else {
-        draw_bg_pixel(&new_image, x, y);
-      }
-    }
-  }
+  filter_bands(&job, neighbor_band, 0, job.h, NULL);
+  imlib_image_put_back_data(job.dst);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -200,26 +526,28 @@ Imlib_Image set_pixels_filter_iter(Imlib_Image *source_image, double thresh,
   int i;
   Imlib_Image temp_image1, temp_image2;
   imlib_context_set_image(*source_image);
-  temp_image1 = temp_image2 = imlib_clone_image();
+  temp_image1 = temp_image2 = pool_clone_image();
   for(i=0; i<iter; i++) {
     temp_image2 = set_pixels_filter(&temp_image1, thresh, lt, mask);
     imlib_context_set_image(temp_image1);
-    imlib_free_image();
+    pool_free_image();
     temp_image1 = temp_image2;
   }
   return temp_image2;
 }
 
+/* dilation and erosion work on runs of set pixels, this gives the same
+ * result as set_pixels_filter_iter() */
 Imlib_Image dilation(Imlib_Image *source_image, double thresh, luminance_t lt,
                      int n)
 {
-  return set_pixels_filter_iter(source_image, thresh, lt, 1, n);
+  return rle_filter_image(source_image, thresh, lt, 1, n);
 }
 
 Imlib_Image erosion(Imlib_Image *source_image, double thresh, luminance_t lt,
                     int n)
 {
-  return set_pixels_filter_iter(source_image, thresh, lt, 9, n);
+  return rle_filter_image(source_image, thresh, lt, 9, n);
 }
 
 Imlib_Image closing(Imlib_Image *source_image, double thresh, luminance_t lt,
@@ -231,7 +559,7 @@ Imlib_Image closing(Imlib_Image *source_image, double thresh, luminance_t lt,
   /* erosion n times */
   return_image = erosion(&temp_image, thresh, lt, n);
   imlib_context_set_image(temp_image);
-  imlib_free_image();
+  pool_free_image();
   return return_image;
 }
 
@@ -244,7 +572,7 @@ Imlib_Image opening(Imlib_Image *source_image, double thresh, luminance_t lt,
   /* dilation n times */
   return_image = dilation(&temp_image, thresh, lt, n);
   imlib_context_set_image(temp_image);
-  imlib_free_image();
+  pool_free_image();
   return return_image;
 }
 
@@ -255,51 +583,23 @@ Imlib_Image opening(Imlib_Image *source_image, double thresh, luminance_t lt,
 Imlib_Image keep_pixels_filter(Imlib_Image *source_image, double thresh,
                                luminance_t lt, int mask)
 {
+  filter_job_struct job;
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y,i,j; /* iteration variables */
-  int set_pixel; /* should  pixel be set or not? */
-  Imlib_Color color;
-  int lum; /* luminance value of pixel */
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, thresh, lt);
+  new_image = new_filter_image(&job);
+  job.mask = mask;
+  job.keep = 1;
+  alloc_neighbors(&job);
 
   /* check for every pixel if it should be set in filtered image */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      set_pixel=0;
-      imlib_image_query_pixel(x, y, &color);
-      lum = get_lum(&color, lt);
-      if(is_pixel_set(lum, thresh)) { /* only test neighbors of set pixels */
-        for(i=x-1; i<=x+1; i++) {
-          for(j=y-1; j<=y+1; j++) {
-            if(i>=0 && i<width && j>=0 && j<height) { /* i,j inside image? */
-              imlib_image_query_pixel(i, j, &color);
-              lum = get_lum(&color, lt);
-              if(is_pixel_set(lum, thresh)) {
-                set_pixel++;
-              }
-            }
-          }
-        }
-      }
-      /* set pixel if at least mask pixels around it are set */
-      /* mask = 1 keeps all pixels */
-      if(set_pixel > mask) {
-        draw_fg_pixel(&new_image, x, y);
-      } else {
-        draw_bg_pixel(&new_image, x, y);
-      }
-    }
-  }
+  filter_bands(&job, neighbor_band, 0, job.h, NULL);
+  imlib_image_put_back_data(job.dst);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -314,65 +614,69 @@ Imlib_Image remove_isolated(Imlib_Image *source_image, double thresh,
   return keep_pixels_filter(source_image, thresh, lt, 1);
 }
 
+/* remove connected components (8-neighborhood) of less than area set pixels,
+ * set pixels of all other components to black (foreground), all other pixels
+ * to white (background) */
+Imlib_Image remove_small_blobs(Imlib_Image *source_image, double thresh,
+                               luminance_t lt, int area)
+{
+  Imlib_Image new_image; /* construct filtered image here */
+  buf_pool_struct *pool = get_buf_pool();
+
+  init_bitmap(&pool->cmd_bitmap, source_image, thresh, lt);
+  encode_rle(pool->cmd_rle, &pool->cmd_bitmap);
+  rle_remove_small_blobs(pool->cmd_rle, pool->cmd_rle + 1, area);
+  new_image = rle_to_image(pool->cmd_rle + 1, source_image);
+
+  /* return filtered image */
+  return new_image;
+}
+
 /* gray stretching, i.e. lum<t1 => lum=0, lum>t2 => lum=100,
- * else lum=((lum-t1)*MAXRGB)/(t2-t1) */
+ * else lum=((lum-t1)*MAXRGB)/(t2-t1),
+ * return NULL unless 0 < t1 < t2 < MAXRGB */
 Imlib_Image gray_stretch(Imlib_Image *source_image, double t1, double t2,
                          luminance_t lt)
 {
+  filter_job_struct job;
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y; /* iteration variables */
-  Imlib_Color color;
-  int lum; /* luminance value of pixel */
+  band_struct *bands;
+  int i, n, translucent = 0;
 
   /* do nothing if t1>=t2 */
   if(t1 >= t2) {
     fprintf(stderr, "%s: error: gray_stretch(): t1=%.2f >= t2=%.2f\n",
                     PROG, t1, t2);
-    exit(99);
+    return NULL;
   }
 
   /* check if 0 < t1,t2 < MAXRGB */
   if(t1 <= 0.0) {
     fprintf(stderr, "%s: error: gray_stretch(): t1=%.2f <= 0.0\n", PROG, t1);
-    exit(99);
+    return NULL;
   }
   if(t2 >= MAXRGB) {
     fprintf(stderr, "%s: error: gray_stretch(): t2=%.2f >= %d.0\n",
                     PROG, t2, MAXRGB);
-    exit(99);
+    return NULL;
   }
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, 0.0, lt);
+  new_image = new_filter_image(&job);
+  job.stretch = 1;
+  job.t1 = t1;
+  job.t2 = t2;
 
   /* gray stretch image */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      imlib_image_query_pixel(x, y, &color);
-      lum = get_lum(&color, lt);
-      imlib_context_set_image(new_image);
-      if(lum<=t1) {
-        imlib_context_set_color(0, 0, 0, color.alpha);
-      } else if(lum>=t2) {
-        imlib_context_set_color(MAXRGB, MAXRGB, MAXRGB, color.alpha);
-      } else {
-        imlib_context_set_color(clip(((lum-t1)*255)/(t2-t1),0,255),
-                                clip(((lum-t1)*255)/(t2-t1),0,255),
-                                clip(((lum-t1)*255)/(t2-t1),0,255),
-                                color.alpha);
-      }
-      imlib_image_draw_pixel(x, y, 0);
-      imlib_context_set_image(*source_image);
-    }
-  }
+  bands = filter_bands(&job, gray_band, 0, job.h, &n);
+  for(i = 0; i < n; i++) translucent |= bands[i].translucent;
+  imlib_image_put_back_data(job.dst);
+  if(translucent) gray_translucent(&job, &new_image);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -387,36 +691,31 @@ Imlib_Image gray_stretch(Imlib_Image *source_image, double t1, double t2,
 Imlib_Image dynamic_threshold(Imlib_Image *source_image,double t,luminance_t lt,
                               int ww, int wh)
 {
+  filter_job_struct job;
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y; /* iteration variables */
-  Imlib_Color color;
-  int lum;
-  double thresh;
+  unsigned char *lum; /* luminance of every pixel */
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, 0.0, lt);
+  new_image = new_filter_image(&job);
+  job.fraction = t/100.0;
+  job.ww = ww;
+  job.wh = wh;
+
+  /* the windows of neighboring pixels overlap, thus the luminance of every
+   * pixel is computed once */
+  lum = pool_buf(BUF_LUM, (size_t)job.w * job.h + 1, sizeof(unsigned char));
+  job.lum_dst = lum;
+  filter_bands(&job, lum_band, 0, job.h, NULL);
+  job.lum = lum;
 
   /* check for every pixel if it should be set in filtered image */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      imlib_image_query_pixel(x, y, &color);
-      lum = get_lum(&color, lt);
-      thresh = get_threshold(source_image, t/100.0, lt, x-ww/2, y-ww/2, ww, wh);
-      if(is_pixel_set(lum, thresh)) {
-        draw_fg_pixel(&new_image, x, y);
-      } else {
-        draw_bg_pixel(&new_image, x, y);
-      }
-    }
-  }
+  filter_bands(&job, dynamic_band, 0, job.h, NULL);
+  imlib_image_put_back_data(job.dst);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -428,34 +727,20 @@ Imlib_Image dynamic_threshold(Imlib_Image *source_image,double t,luminance_t lt,
 /* use simple thresholding to generate monochrome image */
 Imlib_Image make_mono(Imlib_Image *source_image, double thresh, luminance_t lt)
 {
+  filter_job_struct job;
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y; /* iteration variables */
-  Imlib_Color color;
-  int lum; /* pixel luminance */
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, thresh, lt);
+  new_image = new_filter_image(&job);
 
   /* check for every pixel if it should be set in filtered image */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      imlib_image_query_pixel(x, y, &color);
-      lum = get_lum(&color, lt);
-      if(is_pixel_set(lum, thresh)) {
-        draw_fg_pixel(&new_image, x, y);
-      } else {
-        draw_bg_pixel(&new_image, x, y);
-      }
-    }
-  }
+  filter_bands(&job, mono_band, 0, job.h, NULL);
+  imlib_image_put_back_data(job.dst);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -464,28 +749,37 @@ Imlib_Image make_mono(Imlib_Image *source_image, double thresh, luminance_t lt)
   return new_image;
 }
 
-/* adapt threshold to image values values */
-double adapt_threshold(Imlib_Image *image, double thresh, luminance_t lt,
-                       unsigned int flags, int force_update)
+/* adapt threshold to image or frame values, is_adapted tells if this has
+ * been done for the current image already */
+static double adapt(Imlib_Image *image, frame_struct *frame, double thresh,
+                    luminance_t lt, unsigned int flags, int force_update,
+                    int *is_adapted)
 {
   double t = thresh;
-  static int is_adapted = 0;
-  if(is_adapted && !force_update) {
+  if(*is_adapted && !force_update) {
     fprintf(stderr, "threshold is already adjusted to image\n");
   } else if(!(flags & ABSOLUTE_THRESHOLD)) {
     if(flags & DEBUG_OUTPUT)
       fprintf(stderr, "adjusting threshold to image: %f ->", t);
-    t = get_threshold(image, thresh/100.0, lt, 0, 0, -1, -1);
+    if(frame) {
+      t = frame_get_threshold(frame, thresh/100.0, lt, 0, 0, -1, -1);
+    } else {
+      t = get_threshold(image, thresh/100.0, lt, 0, 0, -1, -1);
+    }
     if(flags & DEBUG_OUTPUT)
       fprintf(stderr, " %f\n", t);
     if(flags & DO_ITERATIVE_THRESHOLD) {
       if(flags & DEBUG_OUTPUT)
         fprintf(stderr, "doing iterative_thresholding: %f ->", t);
-      t = iterative_threshold(image, t, lt);
+      if(frame) {
+        t = frame_iterative_threshold(frame, t, lt);
+      } else {
+        t = iterative_threshold(image, t, lt);
+      }
       if(flags & DEBUG_OUTPUT)
         fprintf(stderr, " %f\n", t);
     }
-    is_adapted = 1;
+    *is_adapted = 1;
   }
   if((flags & VERBOSE) || (flags & DEBUG_OUTPUT)) {
     fprintf(stderr, "using threshold %.2f\n", t);
@@ -493,44 +787,48 @@ double adapt_threshold(Imlib_Image *image, double thresh, luminance_t lt,
   return t;
 }
 
+/* adapt threshold to image values values (unless is_adapted is set and
+ * force_update is not), set is_adapted */
+double adapt_threshold(Imlib_Image *image, double thresh, luminance_t lt,
+                       unsigned int flags, int force_update, int *is_adapted)
+{
+  return adapt(image, NULL, thresh, lt, flags, force_update, is_adapted);
+}
+
+/* adapt threshold to frame like adapt_threshold() adapts it to an image
+ * (implemented in imgproc.c to share the adaptation logic) */
+double adapt_threshold_frame(frame_struct *frame, double thresh,
+                             luminance_t lt, unsigned int flags,
+                             int force_update, int *is_adapted)
+{
+  return adapt(NULL, frame, thresh, lt, flags, force_update, is_adapted);
+}
+
 /* compute dynamic threshold value from the rectangle (x,y),(x+w,y+h) of
  * source_image */
 double get_threshold(Imlib_Image *source_image, double fraction, luminance_t lt,
                     int x, int y, int w, int h)
 {
+  filter_job_struct job;
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int xi,yi; /* iteration variables */
-  Imlib_Color color;
-  int lum; /* luminance of pixel */
+  band_struct *bands;
+  int i, n;
   double minval=(double)MAXRGB, maxval=0.0;
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* get image dimensions */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-
-  /* special value -1 for width or height means image width/height */
-  if(w == -1) w = width;
-  if(h == -1) h = width;
-
-  /* assure valid coordinates */
-  if(x+w > width) x = width-w;
-  if(y+h > height) y = height-h;
-  if(x<0) x=0;
-  if(y<0) y=0;
+  init_filter_job(&job, source_image, 0.0, lt);
+  threshold_rect(job.w, job.h, &x, &y, &w, &h);
+  job.x = x;
+  job.rw = w;
 
   /* find the threshold value to differentiate between dark and light */
-  for(xi=0; (xi<w) && (xi<width); xi++) {
-    for(yi=0; (yi<h) && (yi<height); yi++) {
-      imlib_image_query_pixel(x+xi, y+yi, &color);
-      lum = get_lum(&color, lt);
-      if(lum < minval) minval = lum;
-      if(lum > maxval) maxval = lum;
-    }
+  bands = filter_bands(&job, minmax_band, y, y+h, &n);
+  for(i = 0; i < n; i++) {
+    if(bands[i].min < minval) minval = bands[i].min;
+    if(bands[i].max > maxval) maxval = bands[i].max;
   }
 
   /* restore image from before function call */
@@ -543,11 +841,35 @@ double get_threshold(Imlib_Image *source_image, double fraction, luminance_t lt,
 double iterative_threshold(Imlib_Image *source_image, double thresh,
                            luminance_t lt)
 {
+  filter_job_struct job;
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int xi,yi; /* iteration variables */
-  Imlib_Color color;
-  int lum; /* luminance of pixel */
+  band_struct *bands;
+  int i, n, lum;
+  unsigned long int hist[MAXRGB+1]; /* number of pixels per luminance */
+
+  /* save pointer to current image */
+  current_image = imlib_context_get_image();
+
+  /* get image dimensions */
+  init_filter_job(&job, source_image, 0.0, lt);
+
+  /* the iteration needs the luminance histogram only */
+  memset(hist, 0, sizeof(hist));
+  bands = filter_bands(&job, hist_band, 0, job.h, &n);
+  for(i = 0; i < n; i++) {
+    for(lum = 0; lum <= MAXRGB; lum++) hist[lum] += bands[i].hist[lum];
+  }
+
+  /* restore image from before function call */
+  imlib_context_set_image(current_image);
+
+  return iterative_threshold_hist(hist, thresh);
+}
+
+/* determine threshold by an iterative method from a luminance histogram */
+double iterative_threshold_hist(const unsigned long int *hist, double thresh)
+{
+  int lum; /* luminance value */
   unsigned int size_white, size_black; /* size of black and white groups */
   unsigned long int sum_white, sum_black; /* sum of black and white groups */
   unsigned int avg_white, avg_black; /* average values of black and white */
@@ -558,42 +880,28 @@ double iterative_threshold(Imlib_Image *source_image, double thresh,
   /* normalize threshold (was given as a percentage) */
   new_thresh = thresh / 100.0;
 
-  /* save pointer to current image */
-  current_image = imlib_context_get_image();
-
-  /* get image dimensions */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-
   /* find the threshold value to differentiate between dark and light */
   do {
     thresh_lum = MAXRGB * new_thresh;
     old_thresh = new_thresh;
     size_black = sum_black = size_white = sum_white = 0;
-    for(xi=0; xi<width; xi++) {
-      for(yi=0; yi<height; yi++) {
-        imlib_image_query_pixel(xi, yi, &color);
-        lum = get_lum(&color, lt);
-        if(lum <= thresh_lum) {
-          size_black++;
-          sum_black += lum;
-        } else {
-          size_white++;
-          sum_white += lum;
-        }
+    for(lum=0; lum<=MAXRGB; lum++) {
+      if(lum <= thresh_lum) {
+        size_black += hist[lum];
+        sum_black += hist[lum] * lum;
+      } else {
+        size_white += hist[lum];
+        sum_white += hist[lum] * lum;
       }
     }
     if(!size_white) {
       fprintf(stderr, "%s: iterative_threshold(): error: no white pixels\n",
                       PROG);
-      imlib_context_set_image(current_image);
       return thresh;
     }
     if(!size_black) {
       fprintf(stderr, "%s: iterative_threshold(): error: no black pixels\n",
                       PROG);
-      imlib_context_set_image(current_image);
       return thresh;
     }
     avg_white = sum_white / size_white;
@@ -601,9 +909,6 @@ double iterative_threshold(Imlib_Image *source_image, double thresh,
     new_thresh = (avg_white + avg_black) / (2.0 * MAXRGB);
   } while(fabs(new_thresh - old_thresh) > EPSILON);
 
-  /* restore image from before function call */
-  imlib_context_set_image(current_image);
-
   return new_thresh * 100;
 }
 
@@ -611,11 +916,10 @@ double iterative_threshold(Imlib_Image *source_image, double thresh,
 void get_minmaxval(Imlib_Image *source_image, luminance_t lt,
                    double *min, double *max)
 {
+  filter_job_struct job;
   Imlib_Image current_image; /* save image pointer */
-  int w, h; /* image dimensions */
-  int xi,yi; /* iteration variables */
-  Imlib_Color color; /* Imlib2 RGBA color structure */
-  int lum = 0;
+  band_struct *bands;
+  int i, n;
 
   *min = MAXRGB;
   *max = 0;
@@ -624,18 +928,15 @@ void get_minmaxval(Imlib_Image *source_image, luminance_t lt,
   current_image = imlib_context_get_image();
 
   /* get image dimensions */
-  imlib_context_set_image(*source_image);
-  h = imlib_image_get_height();
-  w = imlib_image_get_width();
+  init_filter_job(&job, source_image, 0.0, lt);
+  job.x = 0;
+  job.rw = job.w;
 
   /* find the minimum value in the image */
-  for(xi=0; xi<w; xi++) {
-    for(yi=0; yi<h; yi++) {
-      imlib_image_query_pixel(xi, yi, &color);
-      lum = clip(get_lum(&color, lt),0,255);
-      if(lum < *min) *min = lum;
-      if(lum > *max) *max = lum;
-    }
+  bands = filter_bands(&job, minmax_band, 0, job.h, &n);
+  for(i = 0; i < n; i++) {
+    if(bands[i].min < *min) *min = bands[i].min;
+    if(bands[i].max > *max) *max = bands[i].max;
   }
 
   /* restore image from before function call */
@@ -658,7 +959,7 @@ Imlib_Image white_border(Imlib_Image *source_image, int bdwidth)
   imlib_context_set_image(*source_image);
   height = imlib_image_get_height();
   width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  new_image = pool_clone_image();
 
   /* assure border width has a legal value */
   if(bdwidth > width/2) bdwidth = width/2;
@@ -699,7 +1000,7 @@ Imlib_Image shear(Imlib_Image *source_image, int offset)
   imlib_context_set_image(*source_image);
   height = imlib_image_get_height();
   width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  new_image = pool_clone_image();
 
   /* move every line to the right */
   for(y=1; y<height; y++) {
@@ -739,7 +1040,7 @@ Imlib_Image rotate(Imlib_Image *source_image, double theta)
   imlib_context_set_image(*source_image);
   height = imlib_image_get_height();
   width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  new_image = pool_clone_image();
 
   /* convert theta from degrees to radians */
   theta = theta / 360 * 2.0 * M_PI;
@@ -782,7 +1083,7 @@ Imlib_Image mirror(Imlib_Image *source_image, direction_t direction)
   imlib_context_set_image(*source_image);
   height = imlib_image_get_height();
   width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  new_image = pool_clone_image();
 
   /* create mirrored image */
   if(direction == HORIZONTAL) {
@@ -811,33 +1112,24 @@ Imlib_Image mirror(Imlib_Image *source_image, direction_t direction)
 /* turn image to grayscale */
 Imlib_Image grayscale(Imlib_Image *source_image, luminance_t lt)
 {
-  Imlib_Image new_image; /* construct grayscale image here */
+  filter_job_struct job;
+  Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y; /* iteration variables */
-  Imlib_Color color; /* Imlib2 color structure */
-  int lum=0;
+  band_struct *bands;
+  int i, n, translucent = 0;
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, 0.0, lt);
+  new_image = new_filter_image(&job);
 
   /* transform image to grayscale */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      imlib_context_set_image(*source_image);
-      imlib_image_query_pixel(x, y, &color);
-      imlib_context_set_image(new_image);
-      lum = clip(get_lum(&color, lt),0,255);
-      imlib_context_set_color(lum, lum, lum, color.alpha);
-      imlib_image_draw_pixel(x, y, 0);
-    }
-  }
+  bands = filter_bands(&job, gray_band, 0, job.h, &n);
+  for(i = 0; i < n; i++) translucent |= bands[i].translucent;
+  imlib_image_put_back_data(job.dst);
+  if(translucent) gray_translucent(&job, &new_image);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -849,34 +1141,26 @@ Imlib_Image grayscale(Imlib_Image *source_image, luminance_t lt)
 /* use simple thresholding to generate an inverted monochrome image */
 Imlib_Image invert(Imlib_Image *source_image, double thresh, luminance_t lt)
 {
+  filter_job_struct job;
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
-  int height, width; /* image dimensions */
-  int x,y; /* iteration variables */
-  Imlib_Color color;
-  int lum; /* pixel luminance */
+  DATA32 fg; /* foreground pixel value */
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
 
   /* create a new image */
-  imlib_context_set_image(*source_image);
-  height = imlib_image_get_height();
-  width = imlib_image_get_width();
-  new_image = imlib_clone_image();
+  init_filter_job(&job, source_image, thresh, lt);
+  new_image = new_filter_image(&job);
+
+  /* set pixels are drawn in background color and vice versa */
+  fg = job.fg;
+  job.fg = job.bg;
+  job.bg = fg;
 
   /* check for every pixel if it should be set in filtered image */
-  for(x=0; x<width; x++) {
-    for(y=0; y<height; y++) {
-      imlib_image_query_pixel(x, y, &color);
-      lum = get_lum(&color, lt);
-      if(is_pixel_set(lum, thresh)) {
-        draw_bg_pixel(&new_image, x, y);
-      } else {
-        draw_fg_pixel(&new_image, x, y);
-      }
-    }
-  }
+  filter_bands(&job, mono_band, 0, job.h, NULL);
+  imlib_image_put_back_data(job.dst);
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -891,6 +1175,10 @@ Imlib_Image crop(Imlib_Image *source_image, int x, int y, int w, int h)
   Imlib_Image new_image; /* construct filtered image here */
   Imlib_Image current_image; /* save image pointer */
   int width, height; /* source image dimensions */
+  const DATA32 *src;
+  DATA32 *dst;
+  char has_alpha;
+  int row;
 
   /* save pointer to current image */
   current_image = imlib_context_get_image();
@@ -908,9 +1196,24 @@ Imlib_Image crop(Imlib_Image *source_image, int x, int y, int w, int h)
   if(x + w > width) w = width - x;
   if(y + h > height) h = height - x;
 
-  /* create the new image */
+  /* create the new image, reusing an image of the buffer pool if the
+   * rectangle is inside the source image */
   imlib_context_set_image(*source_image);
-  new_image = imlib_create_cropped_image(x, y, w, h);
+  if(w > 0 && h > 0 && y + h <= height) {
+    src = imlib_image_get_data_for_reading_only();
+    has_alpha = imlib_image_has_alpha();
+    new_image = pool_create_image(w, h);
+    imlib_context_set_image(new_image);
+    dst = imlib_image_get_data();
+    for(row = 0; row < h; row++) {
+      memcpy(dst + (size_t)row * w, src + (size_t)(y + row) * width + x,
+             w * sizeof(DATA32));
+    }
+    imlib_image_put_back_data(dst);
+    imlib_image_set_has_alpha(has_alpha);
+  } else {
+    new_image = imlib_create_cropped_image(x, y, w, h);
+  }
 
   /* restore image from before function call */
   imlib_context_set_image(current_image);
@@ -1039,12 +1342,12 @@ void save_image(const char *image_type, Imlib_Image *image, const char *fmt,
   imlib_context_set_image(current_image);
 }
 
-/* parse KEYWORD from --luminace option */
+/* parse KEYWORD from --luminace option, print the keywords for "help" */
 luminance_t parse_lum(char *keyword)
 {
   if(strcasecmp(keyword, "help") == 0) {
     print_lum_help();
-    exit(42);
+    return LUM_HELP;
   } else if(strcasecmp(keyword, "rec601") == 0) {
     return REC601;
   } else if(strcasecmp(keyword, "rec709") == 0) {
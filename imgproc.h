@@ -19,7 +19,7 @@
 #ifndef SSOCR2_IMGPROC_H
 #define SSOCR2_IMGPROC_H
 
-/* parse luminance keyword */
+/* parse luminance keyword, LUM_HELP after printing the keywords for "help" */
 luminance_t parse_lum(char *keyword);
 
 /* set foreground color */
@@ -28,6 +28,9 @@ void set_fg_color(int color);
 /* set background color */
 void set_bg_color(int color);
 
+/* set number of threads processing an image */
+void set_threads(int threads);
+
 /* set imlib color */
 void ssocr_set_color(fg_bg_t color);
 
@@ -82,8 +85,13 @@ Imlib_Image keep_pixels_filter(Imlib_Image *source_image, double thresh,
 Imlib_Image remove_isolated(Imlib_Image *source_image, double thresh,
                             luminance_t lt);
 
+/* remove connected components of less than area set pixels */
+Imlib_Image remove_small_blobs(Imlib_Image *source_image, double thresh,
+                               luminance_t lt, int area);
+
 /* gray stretching, i.e. lum<t1 => lum=0, lum>t2 => lum=100,
- * else lum=((lum-t1)*MAXRGB)/(t2-t1) */
+ * else lum=((lum-t1)*MAXRGB)/(t2-t1),
+ * return NULL unless 0 < t1 < t2 < MAXRGB */
 Imlib_Image gray_stretch(Imlib_Image *source_image, double t1, double t2,
                          luminance_t lt);
 
@@ -128,9 +136,10 @@ Imlib_Image grayscale(Imlib_Image *source_image, luminance_t lt);
 /* crop image */
 Imlib_Image crop(Imlib_Image *source_image, int x, int y, int w, int h);
 
-/* adapt threshold to image values values */
+/* adapt threshold to image values values (unless is_adapted is set and
+ * force_update is not), set is_adapted */
 double adapt_threshold(Imlib_Image *image, double thresh, luminance_t lt,
-                       unsigned int flags, int force_update);
+                       unsigned int flags, int force_update, int *is_adapted);
 
 /* compute dynamic threshold value from the rectangle (x,y),(x+w,y+h) of
  * source_image */
@@ -141,6 +150,9 @@ double get_threshold(Imlib_Image *source_image, double fraction, luminance_t lt,
 double iterative_threshold(Imlib_Image *source_image, double thresh,
                            luminance_t lt);
 
+/* determine threshold by an iterative method from a luminance histogram */
+double iterative_threshold_hist(const unsigned long int *hist, double thresh);
+
 /* get minimum and maximum gray (luminace) values */
 void get_minmaxval(Imlib_Image *source_image, luminance_t lt,
                    double *min, double *max);
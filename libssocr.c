@@ -0,0 +1,2121 @@
+/* Seven Segment Optical Character Recognition Library */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2004-2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+/* Copyright (C) 2013 Cristiano Fontana <fontanacl@ornl.gov> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <limits.h>         /* INT_MAX */
+#include <stdio.h>          /* fprintf, fputs, perror, snprintf */
+#include <stdlib.h>         /* calloc, realloc, free, exit, qsort, strtol */
+
+/* string manipulation */
+#include <string.h>         /* memcpy, strrchr, strcasecmp */
+
+/* threads */
+#include <pthread.h>        /* pthread_mutex_lock, pthread_mutex_unlock */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "ssocr.h"          /* types */
+#include "imgproc.h"        /* image processing */
+#include "charset.h"        /* character set selection */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+#include "rle.h"            /* run-length encoding */
+#include "bufpool.h"        /* buffer pool */
+#include "bands.h"          /* parallel bands */
+#include "libssocr.h"       /* library interface */
+
+/* global variables, the colors and the number of threads processing an image
+ * of the context of the current thread */
+_Thread_local int ssocr_foreground = SSOCR_DEFAULT_FOREGROUND;
+_Thread_local int ssocr_background = SSOCR_DEFAULT_BACKGROUND;
+_Thread_local int ssocr_threads = THREADS;
+
+/* Imlib2 is not thread safe, a thread holds this lock from its first use of
+ * Imlib2 until it has finished the image */
+static pthread_mutex_t imlib_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local int imlib_lock_held = 0; /* does this thread hold it? */
+
+/* names of the image processing commands, in the order of cmd_t */
+static const char *command_names[] = {
+  "dilation", "erosion", "opening", "closing", "remove_isolated",
+  "remove_small_blobs", "make_mono", "white_border", "shear",
+  "set_pixels_filter", "keep_pixels_filter", "dynamic_threshold",
+  "rgb_threshold", "r_threshold", "g_threshold", "b_threshold", "invert",
+  "gray_stretch", "grayscale", "crop", "rotate", "mirror"
+};
+
+/* functions */
+
+/* acquire the Imlib2 lock before using Imlib2 outside of the library */
+void ssocr_lock_imlib(void)
+{
+  if(!imlib_lock_held) {
+    pthread_mutex_lock(&imlib_lock);
+    imlib_lock_held = 1;
+  }
+}
+
+/* release the Imlib2 lock, unless it is not held */
+void ssocr_unlock_imlib(void)
+{
+  if(imlib_lock_held) {
+    imlib_lock_held = 0;
+    pthread_mutex_unlock(&imlib_lock);
+  }
+}
+
+/* forget the digits of the last image */
+static void forget_result(ssocr_ctx_struct *ctx)
+{
+  ctx->digits = NULL;
+  ctx->ndigits = 0;
+  ctx->text_len = 0;
+  ctx->text[0] = '\0';
+}
+
+/* forget the digits of the last image and the image to compare the next one
+ * to, return exit code 99 */
+static int no_result(ssocr_ctx_struct *ctx)
+{
+  forget_result(ctx);
+  ctx->unchanged = 0;
+  ctx->ref_valid = 0;
+  return 99;
+}
+
+/* append n copies of character c to the recognized text of the context */
+static void add_chars(ssocr_ctx_struct *ctx, char c, int n)
+{
+  char *tmp;
+
+  for(; n > 0; n--) {
+    if(ctx->text_len + 1 >= ctx->text_size) {
+      if(!(tmp = realloc(ctx->text, 2 * ctx->text_size))) {
+        perror(PROG ": text = realloc()");
+        exit(99);
+      }
+      ctx->text = tmp;
+      ctx->text_size *= 2;
+    }
+    ctx->text[ctx->text_len++] = c;
+    ctx->text[ctx->text_len] = '\0';
+  }
+}
+
+/* return number of foreground pixels in a scanline */
+static unsigned int scanline(Imlib_Image *debug_image, rle_struct *rle,
+                             int x, int y, int len, direction_t dir,
+                             color_struct d_color, unsigned int flags)
+{
+  Imlib_Color debug_color;
+  int i, ix, start, end;
+  unsigned int found_pixels = 0;
+  start = (dir == HORIZONTAL) ? x : y;
+  end = start + len;
+  debug_color.red = d_color.R;
+  debug_color.green = d_color.G;
+  debug_color.blue = d_color.B;
+  debug_color.alpha = d_color.A;
+  if (dir == HORIZONTAL) {
+    /* count the parts of the runs of row y inside the scanline */
+    if (y < 0 || y >= rle->h) return 0;
+    for (i = rle->row[y]; i < rle->row[y+1]; i++) {
+      int x1 = (rle->runs[i].x1 > start) ? rle->runs[i].x1 : start;
+      int x2 = (rle->runs[i].x2 < end) ? rle->runs[i].x2 : end;
+      if (rle->runs[i].x1 > end) break;
+      for (ix = x1; ix <= x2; ix++) {
+        if(flags & USE_DEBUG_IMAGE) {
+          draw_color_pixel(debug_image, ix, y, debug_color);
+        }
+        found_pixels++;
+      }
+    }
+  } else {
+    for (i = start; i <= end; i++) {
+      if(rle_pixel(rle, x, i)) {
+        if(flags & USE_DEBUG_IMAGE) {
+          draw_color_pixel(debug_image, x, i, debug_color);
+        }
+        found_pixels++;
+      }
+    }
+  }
+  return found_pixels;
+}
+
+/* return the percentage of foreground pixels in the rectangle (x1,y1) ->
+ * (x2,y2), both corners included */
+static int segment_area(Imlib_Image *debug_image, bitmap_struct *bitmap,
+                        int x1, int y1, int x2, int y2, color_struct d_color,
+                        unsigned int flags)
+{
+  int area = (x2 - x1 + 1) * (y2 - y1 + 1);
+
+  if(area <= 0) return 0;
+  if(flags & USE_DEBUG_IMAGE) {
+    Imlib_Image current_image = imlib_context_get_image();
+    imlib_context_set_image(*debug_image);
+    imlib_context_set_color(d_color.R, d_color.G, d_color.B, d_color.A);
+    imlib_image_draw_rectangle(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+    imlib_context_set_image(current_image);
+  }
+  return (int) ((bitmap_area(bitmap, x1, y1, x2, y2) * 100.0) / area);
+}
+
+/* the horizontal partition of a band of columns, found without knowing
+ * whether the band starts inside a digit */
+typedef struct {
+  int first;                  /* first column not UNKNOWN, -1 if none */
+  int first_fg;               /* is it a foreground column? */
+  int *x;                     /* later columns starting or ending a digit */
+  int n;                      /* number of columns in x */
+} col_band_struct;
+
+/* what the threads segmenting bands of columns or digits need to know,
+ * the threads must not use Imlib2 or the thread local colors and buffer
+ * pool */
+typedef struct {
+  rle_struct *rle;            /* runs of foreground pixels */
+  int ignore_pixels;          /* foreground pixels ignored per column or row */
+  int *col_pixels;            /* number of foreground pixels in each column */
+  col_band_struct *cols;      /* partition of every band of columns */
+  int *scratch;               /* 2*(x1-x0+1) entries for every band */
+  digit_struct *digits;       /* potential digits, ordered from left to right */
+  int *row_pixels;            /* foreground pixels in each row of each digit */
+  unsigned char *lines;       /* rows of each digit with a debug line */
+} segment_job_struct;
+
+/* classify a column or row of n pixels with set foreground pixels,
+ * return 1 for foreground, 0 for background, and -1 for UNKNOWN */
+static int profile_class(int set, int n, int ignore_pixels)
+{
+  if(set > ignore_pixels) {
+    /* 1 not ignored foreground pixel makes the whole column foreground */
+    return 1;
+  } else if(set < n) /* at least one background pixel */ {
+    return 0;
+  } else {
+    return -1;
+  }
+}
+
+/* horizontal partition of columns x0 to x1-1, starting in an unknown state:
+ * every column with a different class than the last column that is not
+ * UNKNOWN starts or ends a digit */
+static void col_band(void *arg, int b, int x0, int x1)
+{
+  segment_job_struct *job = arg;
+  col_band_struct *cb = job->cols + b;
+  int x, c, last = -1;
+
+  /* the scratch memory of the band is used for cb->x and the profile */
+  cb->x = job->scratch + 2 * (x0 + b);
+  rle_col_profile_range(job->rle, x0, x1, job->col_pixels + x0,
+                        cb->x + (x1 - x0 + 1));
+  cb->first = -1;
+  cb->n = 0;
+  for(x = x0; x < x1; x++) {
+    c = profile_class(job->col_pixels[x], job->rle->h, job->ignore_pixels);
+    if(c < 0) continue;
+    if(last < 0) {
+      cb->first = x;
+      cb->first_fg = c;
+    } else if(c != last) {
+      cb->x[cb->n++] = x;
+    }
+    last = c;
+  }
+}
+
+/* find upper and lower boundaries of digits d0 to d1-1 */
+static void digit_band(void *arg, int b, int d0, int d1)
+{
+  segment_job_struct *job = arg;
+  rle_struct *rle = job->rle;
+  digit_struct *digits = job->digits;
+  int h = rle->h;
+  int i, j, d, k, lo, hi, mid, c, inside;
+
+  (void) b;
+  /* count foreground pixels of every row of every potential digit from the
+   * runs of set pixels */
+  for(j=0; j<h; j++) {
+    /* skip runs left of the first potential digit */
+    lo = rle->row[j];
+    hi = rle->row[j+1];
+    while(lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      if(rle->runs[mid].x2 < digits[d0].x1) lo = mid + 1; else hi = mid;
+    }
+    d = d0;
+    for(i=lo; i<rle->row[j+1] && rle->runs[i].x1 <= digits[d1-1].x2; i++) {
+      int x1 = rle->runs[i].x1, x2 = rle->runs[i].x2;
+      /* skip potential digits left of the run */
+      while(d < d1 && digits[d].x2 < x1) d++;
+      /* add overlap of run with every potential digit it touches */
+      for(k=d; k < d1 && digits[k].x1 <= x2; k++) {
+        job->row_pixels[k * h + j] +=
+          ((x2 < digits[k].x2) ? x2 : digits[k].x2)
+          - ((x1 > digits[k].x1) ? x1 : digits[k].x1) + 1;
+      }
+    }
+  }
+
+  for(d=d0; d<d1; d++) {
+    int found_top=0;
+    int *rows = job->row_pixels + (size_t)d * h;
+    unsigned char *lines = job->lines ? job->lines + (size_t)d * h : NULL;
+    inside = 0;
+    /* start from top of image and scan rows for foreground pixel(s) */
+    for(j=0; j<h; j++) {
+      c = profile_class(rows[j], digits[d].x2 - digits[d].x1 + 1,
+                        job->ignore_pixels);
+      if(!inside && c == 1) {
+        if(found_top) /* then we are searching for the bottom */ {
+          digits[d].y2 = j;
+        } else /* found the top line */ {
+          digits[d].y1 = j;
+          found_top = 1;
+        }
+        inside = 1;
+        if(lines) lines[j] = 1;
+      } else if(inside && c == 0) {
+        /* found_top has to be 1 because otherwise we were still looking for
+         * foreground */
+        digits[d].y2 = j;
+        inside = 0;
+        if(lines) lines[j] = 1;
+      }
+    }
+    /* if we are still looking for background, use the bottom */
+    if(inside) {
+      digits[d].y2 = h-1;
+      if(lines) lines[h-1] = 1;
+    }
+  }
+}
+
+/* segment image into potential digits using projection profiles, i.e.,
+ * columns and rows without (enough) foreground pixels separate digits,
+ * the columns are partitioned in bands, the partitions of the bands are
+ * merged, then the digits are searched for their upper and lower boundaries
+ * in bands of digits, return number of potential digits */
+static int segment_profiles(Imlib_Image debug_image, Imlib_Image image,
+                            rle_struct *rle, int ignore_pixels,
+                            digit_struct **digits_ptr, unsigned int flags)
+{
+  segment_job_struct job;
+  int i, j, d, k, b; /* iteration variables */
+  int w = rle->w, h = rle->h; /* image dimensions */
+  int ncols; /* number of bands of columns */
+  int *bounds; /* columns starting and ending digits, alternating */
+  int nbounds = 0, inside = 0;
+  digit_struct *digits=NULL; /* position of digits in image */
+  int potential_digits; /* number of potential digits after segmentation */
+
+  memset(&job, 0, sizeof(job));
+  job.rle = rle;
+  job.ignore_pixels = ignore_pixels;
+
+  /* count foreground pixels of every column from the runs of set pixels and
+   * partition every band of columns */
+  ncols = count_bands(w, BAND_COLS);
+  job.col_pixels = pool_buf(BUF_COL_PIXELS, w, sizeof(int));
+  job.cols = pool_buf_zero(BUF_COL_BANDS, ncols, sizeof(col_band_struct));
+  job.scratch = pool_buf(BUF_COL_SCRATCH, 2 * ((size_t)w + ncols),
+                         sizeof(int));
+  run_bands(ncols, 0, w, col_band, &job);
+
+  /* merge the partitions of the bands, the first column of a band that is
+   * not UNKNOWN starts or ends a digit depending on the preceding bands */
+  bounds = pool_buf(BUF_BOUNDS, (size_t)w + 1, sizeof(int));
+  for(b=0; b<ncols; b++) {
+    if(job.cols[b].first >= 0) {
+      if(job.cols[b].first_fg != inside) {
+        bounds[nbounds++] = job.cols[b].first;
+      }
+      inside = job.cols[b].first_fg;
+      for(k=0; k<job.cols[b].n; k++) {
+        bounds[nbounds++] = job.cols[b].x[k];
+        inside = !inside;
+      }
+    }
+  }
+
+  /* every second bound ends a digit, the last digit may end at the border */
+  digits = pool_buf_zero(BUF_DIGITS, nbounds / 2 + 1, sizeof(digit_struct));
+
+  /* horizontal partition */
+  d = 0;
+  for(k=0; k<nbounds; k++) {
+    i = bounds[k];
+    /* save digit position and draw partition line for DEBUG */
+    if(!(k & 1)) {
+      /* beginning of digit */
+      if (flags & DEBUG_OUTPUT) {
+        fprintf(stderr, " start of potential digit %d in image column %d\n",
+                d, i);
+      }
+      digits[d].x1 = i;
+      digits[d].y1 = 0;
+      if(flags & USE_DEBUG_IMAGE) {
+        imlib_context_set_image(debug_image);
+        imlib_context_set_color(255,0,0,255);/* red line for start of digit */
+        imlib_image_draw_line(i,0,i,h-1,0);
+        imlib_context_set_image(image);
+      }
+    } else {
+      /* end of digit */
+      if (flags & DEBUG_OUTPUT) {
+        fprintf(stderr, " end of potential digit %d in image column %d\n",d,i);
+      }
+      digits[d].x2 = i;
+      digits[d].y2 = h-1;
+      if((d >= INT_MAX - 1) || (d < 0)) {
+        fputs(PROG ": error: too many potential digits (integer overflow)\n",
+              stderr);
+        exit(99);
+      }
+      d++;
+      if(flags & USE_DEBUG_IMAGE) {
+        imlib_context_set_image(debug_image);
+        imlib_context_set_color(0,0,255,255); /* blue line for end of digit */
+        imlib_image_draw_line(i,0,i,h-1,0);
+        imlib_context_set_image(image);
+      }
+    }
+  }
+
+  /* after the loop above the last digit should have ended, i.e. after the
+   * last digit some background was found
+   * if it is still searching for background then end the digit at the border
+   * of the image */
+  if(nbounds & 1) {
+    if (flags & DEBUG_OUTPUT) {
+      fprintf(stderr, " end of potential digit %d in image column %d\n",d,w-1);
+    }
+    digits[d].x2 = w-1;
+    digits[d].y2 = h-1;
+    d++;
+  }
+
+  /* horizontal partitioning has found "d" potential characters / digits */
+  potential_digits = d;
+  if(flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "horizontal partitioning found %d digit(s)\n",
+            potential_digits);
+  }
+
+  /* find upper and lower boundaries of every digit */
+  if (flags & DEBUG_OUTPUT) {
+    fputs("looking for upper and lower digit boundaries\n", stderr);
+  }
+  if(potential_digits > 0) {
+    job.digits = digits;
+    job.row_pixels = pool_buf_zero(BUF_ROW_PIXELS, (size_t)potential_digits * h,
+                                   sizeof(int));
+    if(flags & USE_DEBUG_IMAGE) {
+      job.lines = pool_buf_zero(BUF_LINES, (size_t)potential_digits * h, 1);
+    }
+    run_bands(count_bands(potential_digits, 1), 0, potential_digits,
+              digit_band, &job);
+    if(flags & USE_DEBUG_IMAGE) {
+      imlib_context_set_image(debug_image);
+      imlib_context_set_color(0,255,0,255); /* green lines */
+      for(d=0; d<potential_digits; d++) {
+        for(j=0; j<h; j++) {
+          if(job.lines[(size_t)d * h + j]) {
+            imlib_image_draw_line(digits[d].x1,j,digits[d].x2,j,0);
+          }
+        }
+      }
+      imlib_context_set_image(image);
+    }
+  }
+
+  *digits_ptr = digits;
+  return potential_digits;
+}
+
+/* order components from left to right */
+static int compare_blobs(const void *a, const void *b)
+{
+  const blob_struct *ba = a, *bb = b;
+
+  if(ba->x1 != bb->x1) return (ba->x1 < bb->x1) ? -1 : 1;
+  return (ba->y1 < bb->y1) ? -1 : (ba->y1 > bb->y1);
+}
+
+/* segment image into potential digits using connected components, i.e.,
+ * components overlapping horizontally belong to the same digit, components
+ * of at most ignore_pixels pixels are ignored,
+ * return number of potential digits */
+static int segment_components(Imlib_Image debug_image, Imlib_Image image,
+                              rle_struct *rle, int ignore_pixels,
+                              digit_struct **digits_ptr, unsigned int flags)
+{
+  int *labels; /* component number of every run */
+  blob_struct *blobs; /* bounding boxes of components */
+  digit_struct *digits; /* position of digits in image */
+  int n, i, d, kept;
+  int max_x = -1, max_y = -1; /* last pixel of current digit */
+
+  if (flags & DEBUG_OUTPUT) {
+    fputs("starting connected component labeling\n", stderr);
+  }
+  labels = pool_buf(BUF_LABELS, rle->nruns, sizeof(int));
+  n = rle_label(rle, labels);
+  blobs = rle_blobs(rle, labels, n);
+
+  /* drop small components */
+  for(i = 0, kept = 0; i < n; i++) {
+    if(blobs[i].area > ignore_pixels) {
+      blobs[kept++] = blobs[i];
+    } else if(flags & DEBUG_OUTPUT) {
+      fprintf(stderr, " ignoring component at (%d,%d) with %d pixel(s)\n",
+              blobs[i].x1, blobs[i].y1, blobs[i].area);
+    }
+  }
+  if(flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "found %d components, %d of them large enough\n", n, kept);
+  }
+  qsort(blobs, kept, sizeof(blob_struct), compare_blobs);
+
+  /* join horizontally overlapping components into potential digits */
+  digits = pool_buf_zero(BUF_DIGITS, (size_t)kept + 1, sizeof(digit_struct));
+  d = -1;
+  for(i = 0; i < kept; i++) {
+    if(d >= 0 && blobs[i].x1 <= max_x) {
+      if(blobs[i].y1 < digits[d].y1) digits[d].y1 = blobs[i].y1;
+      if(blobs[i].x2 > max_x) max_x = blobs[i].x2;
+      if(blobs[i].y2 > max_y) max_y = blobs[i].y2;
+    } else {
+      d++;
+      digits[d].x1 = blobs[i].x1;
+      digits[d].y1 = blobs[i].y1;
+      max_x = blobs[i].x2;
+      max_y = blobs[i].y2;
+    }
+    /* like profile based segmentation, the digit ends at the first
+     * background column and row (or at the image border) */
+    digits[d].x2 = (max_x + 1 < rle->w) ? max_x + 1 : rle->w - 1;
+    digits[d].y2 = (max_y + 1 < rle->h) ? max_y + 1 : rle->h - 1;
+  }
+
+  for(i = 0; i <= d; i++) {
+    if(flags & DEBUG_OUTPUT) {
+      fprintf(stderr, " potential digit %d: (%d,%d) -> (%d,%d)\n", i,
+              digits[i].x1, digits[i].y1, digits[i].x2, digits[i].y2);
+    }
+    if(flags & USE_DEBUG_IMAGE) {
+      imlib_context_set_image(debug_image);
+      imlib_context_set_color(255,0,0,255);/* red line for start of digit */
+      imlib_image_draw_line(digits[i].x1,0,digits[i].x1,rle->h-1,0);
+      imlib_context_set_color(0,0,255,255); /* blue line for end of digit */
+      imlib_image_draw_line(digits[i].x2,0,digits[i].x2,rle->h-1,0);
+      imlib_context_set_color(0,255,0,255); /* green line */
+      imlib_image_draw_line(digits[i].x1,digits[i].y1,
+                            digits[i].x2,digits[i].y1,0);
+      imlib_image_draw_line(digits[i].x1,digits[i].y2,
+                            digits[i].x2,digits[i].y2,0);
+      imlib_context_set_image(image);
+    }
+  }
+
+  *digits_ptr = digits;
+  return d + 1;
+}
+
+/* check if an image shall be written in PBM format */
+static int is_pbm(const char *fmt, const char *filename)
+{
+  const char *ext;
+
+  if(fmt) return strcasecmp(fmt, "pbm") == 0;
+  ext = strrchr(filename, '.');
+  return ext && strcasecmp(ext + 1, "pbm") == 0;
+}
+
+/* continue with an Imlib2 image instead of a frame (the frame is not freed)
+ * and make that the context image */
+static Imlib_Image image_from_frame(frame_struct **frame)
+{
+  Imlib_Image image;
+
+  ssocr_lock_imlib();
+  image = frame_to_image(*frame);
+  *frame = NULL;
+  imlib_context_set_image(image);
+  return image;
+}
+
+/* print given number of space characters to given stream */
+static void print_spaces(FILE *f, int n)
+{
+  int i;
+  for (i = 0; i < n; i++) {
+    fputc(' ', f);
+  }
+}
+
+/* parse the image processing commands argv[first] to argv[last-1],
+ * store them in newly allocated memory, return the number of commands or -1
+ * after printing an error message, if end is not NULL, stop at the first
+ * argument that is not a command and store its index in end,
+ * the commands refer to argv, which must not be changed */
+int ssocr_parse_commands(char **argv, int first, int last,
+                         command_struct **cmds_ptr, int *end)
+{
+  command_struct *cmds, *cmd;
+  int i, k, ncmds = 0;
+
+  *cmds_ptr = NULL;
+  if(end) *end = first;
+  if(first >= last) return 0;
+  if(!(cmds = calloc(last - first, sizeof(command_struct)))) {
+    perror(PROG ": cmds = calloc()");
+    exit(99);
+  }
+  for(i = first; i < last; i++) {
+    cmd = cmds + ncmds++;
+    cmd->argv = argv + i;
+    cmd->argi = i;
+    cmd->cmd = CMD_UNKNOWN;
+    cmd->name = argv[i];
+    for(k = 0; k < CMD_UNKNOWN; k++) {
+      if(strcasecmp(command_names[k], argv[i]) == 0) {
+        cmd->cmd = k;
+        cmd->name = command_names[k];
+        break;
+      }
+    }
+    if(end && cmd->cmd == CMD_UNKNOWN) {
+      ncmds--;
+      break;
+    }
+    switch(cmd->cmd) {
+      case CMD_DILATION:
+      case CMD_EROSION:
+      case CMD_OPENING:
+      case CMD_CLOSING:
+      case CMD_WHITE_BORDER:
+        /* optional positive argument, 1 if not given */
+        cmd->n[0] = (i+1 < last) ? atoi(argv[i+1]) : 0;
+        if(cmd->n[0] > 0) {
+          cmd->nargs = 1;
+        } else {
+          cmd->n[0] = 1;
+        }
+        break;
+      case CMD_REMOVE_SMALL_BLOBS:
+      case CMD_SHEAR:
+      case CMD_SET_PIXELS_FILTER:
+      case CMD_KEEP_PIXELS_FILTER:
+      case CMD_ROTATE:
+        if(i+1 >= last) {
+          fprintf(stderr, "%s: error: %s command needs an argument\n", PROG,
+                          cmd->name);
+          free(cmds);
+          return -1;
+        }
+        cmd->n[0] = atoi(argv[i+1]);
+        cmd->t[0] = atof(argv[i+1]);
+        cmd->nargs = 1;
+        if(cmd->cmd == CMD_REMOVE_SMALL_BLOBS) {
+          char *num_end;
+          long int area = strtol(argv[i+1], &num_end, 10);
+          if(num_end == argv[i+1] || *num_end != '\0' || area < 1 ||
+             area > INT_MAX) {
+            fprintf(stderr, "%s: error: remove_small_blobs needs a positive"
+                            " integer AREA (AREA=%s)\n", PROG, argv[i+1]);
+            free(cmds);
+            return -1;
+          }
+          cmd->n[0] = (int) area;
+        }
+        break;
+      case CMD_DYNAMIC_THRESHOLD:
+      case CMD_GRAY_STRETCH:
+        if(i+2 >= last) {
+          fprintf(stderr, "%s: error: %s command needs two arguments\n", PROG,
+                          cmd->name);
+          free(cmds);
+          return -1;
+        }
+        cmd->n[0] = atoi(argv[i+1]);
+        cmd->n[1] = atoi(argv[i+2]);
+        cmd->t[0] = atof(argv[i+1]);
+        cmd->t[1] = atof(argv[i+2]);
+        cmd->nargs = 2;
+        if(cmd->cmd == CMD_GRAY_STRETCH &&
+           (cmd->t[0] < 0.0 || cmd->t[0] >= cmd->t[1] ||
+            cmd->t[1] > MAXRGB)) {
+          fprintf(stderr, "%s: error: gray_stretch needs 0 <= T1 < T2 <= %d"
+                          " (T1=%s, T2=%s)\n", PROG, MAXRGB, argv[i+1],
+                          argv[i+2]);
+          free(cmds);
+          return -1;
+        }
+        break;
+      case CMD_CROP:
+        if(i+4 >= last) {
+          fprintf(stderr, "%s: error: crop command needs 4 arguments\n", PROG);
+          free(cmds);
+          return -1;
+        }
+        for(k = 0; k < 4; k++) {
+          cmd->n[k] = atoi(argv[i+1+k]);
+        }
+        cmd->nargs = 4;
+        break;
+      case CMD_MIRROR:
+        if(i+1 >= last) {
+          fprintf(stderr, "%s: error: mirror command needs argument 'horiz'"
+                          " or 'vert'\n", PROG);
+          free(cmds);
+          return -1;
+        }
+        if(strncasecmp("horiz",argv[i+1],5) == 0) {
+          cmd->n[0] = 0;
+        } else if(strncasecmp("vert",argv[i+1],4) == 0) {
+          cmd->n[0] = 1;
+        } else {
+          fprintf(stderr, "%s: error: argument to 'mirror' must be 'horiz'"
+                          " or 'vert'\n", PROG);
+          free(cmds);
+          return -1;
+        }
+        cmd->nargs = 1;
+        break;
+      default:
+        break;
+    }
+    i += cmd->nargs;
+  }
+
+  if(end) *end = i;
+  *cmds_ptr = cmds;
+  return ncmds;
+}
+
+/* do the commands change luminance values in a way that a threshold between
+ * the two luminance values of a bilevel image does not separate them? */
+static int remaps_lum(const command_struct *cmds, int ncmds)
+{
+  int c;
+
+  for(c = 0; c < ncmds; c++) {
+    switch(cmds[c].cmd) {
+      case CMD_GRAY_STRETCH:
+      case CMD_RGB_THRESHOLD:
+      case CMD_R_THRESHOLD:
+      case CMD_G_THRESHOLD:
+      case CMD_B_THRESHOLD:
+        return 1;
+      default:
+        break;
+    }
+  }
+  return 0;
+}
+
+/* free an image of process_image(), the image loaded by the caller is freed
+ * (and set to NULL), every other image is kept in the buffer pool */
+static void free_work_image(Imlib_Image image, Imlib_Image *loaded)
+{
+  imlib_context_set_image(image);
+  if(image == *loaded) {
+    imlib_free_image_and_decache();
+    *loaded = NULL;
+  } else {
+    pool_free_image();
+  }
+}
+
+/* store the luminance of every pixel of the frame or, without a frame, of
+ * the current image in the pool, return its 64 bit FNV-1a hash */
+static unsigned long long int region_lum(frame_struct *frame, luminance_t lt,
+                                         int w, int h)
+{
+  unsigned long long int hash = 14695981039346656037ULL;
+  unsigned char *lum;
+  DATA32 *data = NULL;
+  Imlib_Color color;
+  int *row = NULL;
+  size_t i = 0;
+  int x, y;
+
+  lum = pool_buf(BUF_SKIP_CUR, (size_t)w * h, sizeof(unsigned char));
+  if(frame) {
+    row = pool_buf(BUF_SKIP_ROW, w, sizeof(int));
+  } else {
+    data = imlib_image_get_data_for_reading_only();
+  }
+  for(y = 0; y < h; y++) {
+    if(frame) frame_lum_row(frame, 0, y, w, lt, row);
+    for(x = 0; x < w; x++, i++) {
+      if(frame) {
+        lum[i] = clip(row[x], 0, MAXRGB);
+      } else {
+        color.alpha = (data[i] >> 24) & 0xff;
+        color.red = (data[i] >> 16) & 0xff;
+        color.green = (data[i] >> 8) & 0xff;
+        color.blue = data[i] & 0xff;
+        lum[i] = clip(get_lum(&color, lt), 0, MAXRGB);
+      }
+      hash = (hash ^ lum[i]) * 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+/* compare the frame or, without a frame, the current image to the last
+ * recognized image, it is unchanged if the luminance is the same, or if at
+ * most tolerance pixels differ noticeably, a changed image becomes the new
+ * reference, return 1 if unchanged and 0 otherwise */
+static int region_unchanged(ssocr_ctx_struct *ctx, frame_struct *frame,
+                            int tolerance)
+{
+  buf_pool_struct *pool = ctx->pool;
+  unsigned long long int hash;
+  const unsigned char *cur, *ref;
+  buf_struct tmp;
+  size_t i, n;
+  int w, h, diff, differing = 0;
+
+  if(frame) {
+    w = frame->w;
+    h = frame->h;
+  } else {
+    w = imlib_image_get_width();
+    h = imlib_image_get_height();
+  }
+  hash = region_lum(frame, ctx->opt.lt, w, h);
+  if(ctx->ref_valid && w == ctx->ref_w && h == ctx->ref_h) {
+    if(hash == ctx->ref_hash) return 1;
+    cur = pool->bufs[BUF_SKIP_CUR].mem;
+    ref = pool->bufs[BUF_SKIP_REF].mem;
+    n = (size_t)w * h;
+    for(i = 0; i < n && differing <= tolerance; i++) {
+      diff = cur[i] - ref[i];
+      if(diff > SKIP_LUM_DIFF || diff < -SKIP_LUM_DIFF) differing++;
+    }
+    if(ctx->opt.flags & DEBUG_OUTPUT) {
+      fprintf(stderr, "%s%d pixels differ from the last recognized image\n",
+                      differing > tolerance ? "more than " : "",
+                      differing > tolerance ? tolerance : differing);
+    }
+    if(differing <= tolerance) return 1;
+  }
+  /* keep the luminance of the new reference by swapping the buffers */
+  tmp = pool->bufs[BUF_SKIP_REF];
+  pool->bufs[BUF_SKIP_REF] = pool->bufs[BUF_SKIP_CUR];
+  pool->bufs[BUF_SKIP_CUR] = tmp;
+  ctx->ref_valid = 1;
+  ctx->ref_w = w;
+  ctx->ref_h = h;
+  ctx->ref_hash = hash;
+  return 0;
+}
+
+/* can an image be processed as a frame, i.e., do neither the commands nor
+ * the output of images need Imlib2? */
+static int frame_suffices(const ssocr_ctx_struct *ctx)
+{
+  int c;
+
+  if((ctx->opt.flags & USE_DEBUG_IMAGE) || ctx->opt.output_file) return 0;
+  for(c = 0; c < ctx->ncmds; c++) {
+    if(ctx->cmds[c].cmd != CMD_CROP) return 0;
+  }
+  return 1;
+}
+
+/* copy the pixels of the current image into a BGRA32 frame viewing memory of
+ * the buffer pool, the frame must not be freed */
+static void image_to_frame(frame_struct *frame)
+{
+  const DATA32 *data = imlib_image_get_data_for_reading_only();
+  int w = imlib_image_get_width(), h = imlib_image_get_height();
+  unsigned char *p;
+  size_t i, n = (size_t)w * h;
+
+  p = pool_buf(BUF_FRAME, n, 4);
+  for(i = 0; i < n; i++) {
+    p[4*i] = data[i] & 0xff;
+    p[4*i+1] = (data[i] >> 8) & 0xff;
+    p[4*i+2] = (data[i] >> 16) & 0xff;
+    p[4*i+3] = (data[i] >> 24) & 0xff;
+  }
+  memset(frame, 0, sizeof(frame_struct));
+  frame->fmt = FRAME_BGRA32;
+  frame->w = w;
+  frame->h = h;
+  frame->stride = 4 * (size_t)w;
+  frame->data = p;
+}
+
+/* process one image (or frame, which is not freed) with the commands of the
+ * context, recognize the digits and store them and their characters in the
+ * context, a frame copied from an Imlib2 image is processed like that image,
+ * return the exit code for this image */
+static int process_image(ssocr_ctx_struct *ctx, Imlib_Image image,
+                         frame_struct *frame, int copied, const char *imgfile)
+{
+  Imlib_Image new_image=NULL; /* a temporary image handle */
+  Imlib_Image debug_image=NULL; /* DEBUG */
+  Imlib_Image loaded=image; /* image given by the caller, not pooled */
+  bitmap_struct *bitmap=NULL; /* thresholded processed image */
+  rle_struct *rle=NULL; /* runs of set pixels of the processed image */
+
+  int i, c, d;  /* iteration variables */
+  int unknown_digit=0; /* was one of the 6 found digits an unknown one? */
+  int potential_digits; /* number of potential digits after segmentation */
+  int number_of_digits; /* number of digits found and accepted */
+  int w, h;  /* width, height */
+  int dig_w;  /* width of digit part of image */
+  int dig_h;  /* height of digit part of image */
+  int max_dig_h=0, max_dig_w=0; /* maximum height & width of digits found */
+  int widest_dig_is_one=0; /* set to one if the widest digit is a one */
+  digit_struct *digits=NULL; /* position of digits in image */
+  int found_pixels=0; /* how many pixels are already found */
+  color_struct d_color = {0, 0, 0, 0}; /* drawing color */
+  int compare; /* shall the image be compared to the last recognized one? */
+
+  /* options, the threshold is adapted to every image anew */
+  const options_struct *opt = &ctx->opt;
+  const command_struct *cmds = ctx->cmds;
+  int ncmds = ctx->ncmds;
+  unsigned int flags = opt->flags;
+  double thresh = opt->thresh;
+  luminance_t lt = opt->lt;
+  int need_pixels = opt->need_pixels;
+  int segment_fill = opt->segment_fill;
+  int min_segment = opt->min_segment;
+  dimensions_struct min_char_dims = opt->min_char_dims;
+  interval_struct expected_digits = opt->expected_digits;
+  int ignore_pixels = opt->ignore_pixels;
+  int one_ratio = opt->one_ratio;
+  int minus_ratio = opt->minus_ratio;
+  int dec_h_ratio = opt->dec_h_ratio;
+  int dec_w_ratio = opt->dec_w_ratio;
+  double spc_fac = opt->spc_fac;
+  const char *output_file = opt->output_file;
+  const char *output_fmt = opt->output_fmt;
+  const char *debug_image_file = opt->debug_image_file;
+
+  ctx->adapted = 0;
+  ctx->unchanged = 0;
+  /* an unchanged image keeps the result of the last one */
+  compare = flags & SKIP_UNCHANGED;
+  if(!compare) forget_result(ctx);
+  set_fg_color(opt->foreground);
+  set_bg_color(opt->background);
+  set_threads(opt->threads);
+
+  /* get image parameters */
+  if(frame) {
+    w = frame->w;
+    h = frame->h;
+  } else {
+    /* set the image we loaded as the current context image to work on */
+    imlib_context_set_image(image);
+    w = imlib_image_get_width();
+    h = imlib_image_get_height();
+  }
+  if((flags & DEBUG_OUTPUT) || (flags & PRINT_INFO)) {
+    fprintf(stderr, "image width: %d\nimage height: %d\n",w,h);
+  }
+
+  /* get minimum and maximum "value" values */
+  if((flags & DEBUG_OUTPUT) || (flags & PRINT_INFO)) {
+    double min, max;
+    if(frame) {
+      frame_minmaxval(frame, lt, &min, &max);
+    } else {
+      get_minmaxval(&image, lt, &min, &max);
+    }
+    fprintf(stderr, "%.2f <= lum <= %.2f (lum should be in [0,255])\n",
+                    min, max);
+  }
+
+  /* a bilevel image needs no threshold adaptation, any threshold between its
+   * two luminance values separates foreground from background, a frame of
+   * which only the crop area has been decoded cannot be checked before the
+   * crop command */
+  if(flags & BILEVEL_INPUT) {
+    thresh = BILEVEL_THRESHOLD;
+    flags = (flags | ABSOLUTE_THRESHOLD) & ~DO_ITERATIVE_THRESHOLD;
+    if(flags & VERBOSE) {
+      fprintf(stderr, "using bilevel fast path (forced), threshold %.2f\n",
+                      thresh);
+    }
+  } else if(frame && !copied && !frame->partial &&
+            !(flags & ABSOLUTE_THRESHOLD) && !remaps_lum(cmds, ncmds)) {
+    int lo, hi;
+    if(frame_bilevel(frame, lt, &lo, &hi)) {
+      thresh = (lo + hi) / 2.0 * 100.0 / MAXRGB;
+      flags = (flags | ABSOLUTE_THRESHOLD) & ~DO_ITERATIVE_THRESHOLD;
+      if(flags & VERBOSE) {
+        fprintf(stderr, "using bilevel fast path (luminance %d and %d),"
+                        " threshold %.2f\n", lo, hi, thresh);
+      }
+    }
+  }
+
+  /* process commands */
+  if(flags & VERBOSE) /* then print found commands */ {
+    if(ncmds < 1) {
+      fprintf(stderr, "no commands given, using image %s unmodified\n",
+                      imgfile);
+    } else {
+      fprintf(stderr, "got commands");
+      for(c=0; c<ncmds; c++) {
+        for(i=0; i<=cmds[c].nargs; i++) {
+          fprintf(stderr, " %s", cmds[c].argv[i]);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, " (argv[%d])", cmds[c].argi + i);
+          }
+        }
+      }
+      fprintf(stderr, "\n");
+    }
+  }
+  for(c=0; c<=ncmds; c++) {
+    const command_struct *cmd = (c < ncmds) ? cmds + c : NULL;
+    /* compare the region of interest after the geometric commands */
+    if(compare && (!cmd || (cmd->cmd != CMD_CROP &&
+       cmd->cmd != CMD_ROTATE && cmd->cmd != CMD_MIRROR &&
+       cmd->cmd != CMD_SHEAR))) {
+      compare = 0;
+      if(image) imlib_context_set_image(image);
+      if(region_unchanged(ctx, frame, opt->skip_tolerance)) {
+        if(flags & VERBOSE) {
+          fputs("image unchanged, repeating the last result\n", stderr);
+        }
+        ctx->unchanged = 1;
+        if(image) free_work_image(image, &loaded);
+        return ctx->ref_status;
+      }
+      forget_result(ctx);
+    }
+    if(!cmd) break;
+    /* only cropping works on frames, other commands need an image */
+    if(frame && cmd->cmd != CMD_CROP) {
+      image = image_from_frame(&frame);
+    }
+    switch(cmd->cmd) {
+      case CMD_DILATION:
+      case CMD_EROSION:
+      case CMD_OPENING:
+      case CMD_CLOSING:
+        if(flags & VERBOSE) {
+          if(cmd->nargs) {
+            fprintf(stderr, " processing %s %d", cmd->name, cmd->n[0]);
+            if(flags & DEBUG_OUTPUT) {
+              fprintf(stderr, " (from string %s)", cmd->argv[1]);
+            }
+            fprintf(stderr, "\n");
+          } else {
+            fprintf(stderr, " processing %s (1)\n", cmd->name);
+          }
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        if(cmd->cmd == CMD_DILATION) {
+          new_image = dilation(&image, thresh, lt, cmd->n[0]);
+        } else if(cmd->cmd == CMD_EROSION) {
+          new_image = erosion(&image, thresh, lt, cmd->n[0]);
+        } else if(cmd->cmd == CMD_OPENING) {
+          new_image = opening(&image, thresh, lt, cmd->n[0]);
+        } else {
+          new_image = closing(&image, thresh, lt, cmd->n[0]);
+        }
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_REMOVE_ISOLATED:
+        if(flags & VERBOSE) fputs(" processing remove_isolated\n", stderr);
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = remove_isolated(&image, thresh, lt);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_REMOVE_SMALL_BLOBS:
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing remove_small_blobs %d", cmd->n[0]);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, " (from string %s)", cmd->argv[1]);
+          }
+          fprintf(stderr, "\n");
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = remove_small_blobs(&image, thresh, lt, cmd->n[0]);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_MAKE_MONO:
+        if(flags & VERBOSE) fputs(" processing make_mono\n", stderr);
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = make_mono(&image, thresh, lt);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_WHITE_BORDER:
+        if(flags & VERBOSE) {
+          if(cmd->nargs) {
+            fprintf(stderr, " processing white_border %d", cmd->n[0]);
+            if(flags & DEBUG_OUTPUT) {
+              fprintf(stderr, " (from string %s)", cmd->argv[1]);
+            }
+            fprintf(stderr, "\n");
+          } else {
+            fputs(" processing white_border (1)\n", stderr);
+          }
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = white_border(&image, cmd->n[0]);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_SHEAR:
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing shear %d", cmd->n[0]);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, " (from string %s)", cmd->argv[1]);
+          }
+          fprintf(stderr, "\n");
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = shear(&image, cmd->n[0]);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_SET_PIXELS_FILTER:
+      case CMD_KEEP_PIXELS_FILTER:
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing %s %d", cmd->name, cmd->n[0]);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, " (from string %s)", cmd->argv[1]);
+          }
+          fprintf(stderr, "\n");
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        if(cmd->cmd == CMD_SET_PIXELS_FILTER) {
+          new_image = set_pixels_filter(&image, thresh, lt, cmd->n[0]);
+        } else {
+          new_image = keep_pixels_filter(&image, thresh, lt, cmd->n[0]);
+        }
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_DYNAMIC_THRESHOLD:
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing dynamic_threshold %d %d", cmd->n[0],
+                          cmd->n[1]);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr," (from strings %s and %s)", cmd->argv[1],
+                           cmd->argv[2]);
+          }
+          fprintf(stderr, "\n");
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = dynamic_threshold(&image, thresh, lt, cmd->n[0], cmd->n[1]);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_RGB_THRESHOLD:
+      case CMD_R_THRESHOLD:
+      case CMD_G_THRESHOLD:
+      case CMD_B_THRESHOLD:
+        if(flags & VERBOSE) fprintf(stderr, " processing %s\n", cmd->name);
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = make_mono(&image, thresh, cmd->cmd == CMD_R_THRESHOLD ?
+                              RED : cmd->cmd == CMD_G_THRESHOLD ? GREEN :
+                              cmd->cmd == CMD_B_THRESHOLD ? BLUE : MINIMUM);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_INVERT:
+        if(flags & VERBOSE) fputs(" processing invert\n", stderr);
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = invert(&image, thresh, lt);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_GRAY_STRETCH: {
+        double t1 = cmd->t[0], t2 = cmd->t[1];
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing gray_stretch %.2f %.2f", t1, t2);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr," (from strings %s and %s)", cmd->argv[1],
+                           cmd->argv[2]);
+          }
+          fprintf(stderr, "\n");
+        }
+        if(flags & ADJUST_GRAY) {
+          double min=-1.0, max=-1.0;
+          if(flags & VERBOSE) {
+            fprintf(stderr, " adjusting T1=%.2f and T2=%.2f to image\n",
+                            t1, t2);
+          }
+          get_minmaxval(&image, lt, &min, &max);
+          t1 = min + t1/100.0 * (max - min);
+          t2 = min + t2/100.0 * (max - min);
+          if(flags & VERBOSE) {
+            fprintf(stderr, " adjusted to T1=%.2f and T2=%.2f\n", t1, t2);
+          }
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = gray_stretch(&image, t1, t2, lt);
+        free_work_image(image, &loaded);
+        /* e.g., T1 and T2 adjusted to an image of one gray value */
+        if(!new_image) return no_result(ctx);
+        image = new_image;
+        break;
+      }
+      case CMD_GRAYSCALE:
+        if(flags & VERBOSE) fputs(" processing grayscale\n", stderr);
+        new_image = grayscale(&image, lt);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_CROP: {
+        int x = cmd->n[0], y = cmd->n[1];
+        int cw = cmd->n[2], ch = cmd->n[3]; /* crop width and height */
+        if(flags & VERBOSE) {
+          fprintf(stderr,
+                  " cropping from (%d,%d) to (%d,%d) [width %d, height %d]",
+                  x, y, x+cw, y+ch, cw, ch);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, " (from strings %s, %s, %s, and %s)",
+                    cmd->argv[1], cmd->argv[2], cmd->argv[3], cmd->argv[4]);
+          }
+          fprintf(stderr, "\n");
+        }
+        if(!(flags & ADAPT_AFTER_CROP)) {
+          if(frame) {
+            thresh = adapt_threshold_frame(frame, thresh, lt, flags, INITIAL,
+                                           &ctx->adapted);
+          } else {
+            thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                     &ctx->adapted);
+          }
+        }
+        /* a frame is cropped by narrowing its view, if possible */
+        if(frame && frame_crop(frame, x, y, cw, ch) < 0) {
+          image = image_from_frame(&frame);
+        }
+        if(frame) {
+          w = frame->w;
+          h = frame->h;
+        } else {
+          new_image = crop(&image, x, y, cw, ch);
+          free_work_image(image, &loaded);
+          image = new_image;
+          imlib_context_set_image(image);
+          /* get cropped image dimensions */
+          w = imlib_image_get_width();
+          h = imlib_image_get_height();
+        }
+        if((flags & DEBUG_OUTPUT) || (flags & VERBOSE)) {
+          fprintf(stderr, "  cropped image width: %d\n"
+                          "  cropped image height: %d\n", w, h);
+        }
+        /* get minimum and maximum "value" values in cropped image */
+        if((flags&DEBUG_OUTPUT) || (flags&PRINT_INFO) || (flags&VERBOSE)) {
+          double min, max;
+          if(frame) {
+            frame_minmaxval(frame, lt, &min, &max);
+          } else {
+            get_minmaxval(&image, lt, &min, &max);
+          }
+          fprintf(stderr, "  %.2f <= lum <= %.2f in cropped image"
+                          " (lum should be in [0,255])\n", min, max);
+        }
+        /* adapt threshold to cropped image */
+        if(frame) {
+          thresh = adapt_threshold_frame(frame, thresh, lt, flags, UPDATE,
+                                         &ctx->adapted);
+        } else {
+          thresh = adapt_threshold(&image, thresh, lt, flags, UPDATE,
+                                   &ctx->adapted);
+        }
+        break;
+      }
+      case CMD_ROTATE:
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing rotate %f", cmd->t[0]);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, " (from string %s)", cmd->argv[1]);
+          }
+          fprintf(stderr, "\n");
+        }
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        new_image = rotate(&image, cmd->t[0]);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      case CMD_MIRROR:
+        if(flags & VERBOSE) {
+          fprintf(stderr, " processing mirror %s\n", cmd->argv[1]);
+        }
+        new_image = mirror(&image, cmd->n[0] ? VERTICAL : HORIZONTAL);
+        free_work_image(image, &loaded);
+        image = new_image;
+        break;
+      default:
+        fprintf(stderr, " unknown command \"%s\"\n", cmd->argv[0]);
+        break;
+    }
+  }
+
+  /* the debug image and most output formats need an image */
+  if(frame && ((flags & USE_DEBUG_IMAGE) ||
+               (output_file && !is_pbm(output_fmt, output_file)))) {
+    image = image_from_frame(&frame);
+  }
+
+  /* assure we are working with the current image */
+  if(image) imlib_context_set_image(image);
+
+  /* write image to file if requested */
+  if(output_file) {
+    if(is_pbm(output_fmt, output_file)) {
+      /* a bilevel image is written directly from the runs of set pixels */
+      if(frame) {
+        thresh = adapt_threshold_frame(frame, thresh, lt, flags, INITIAL,
+                                       &ctx->adapted);
+        bitmap = &ctx->pool->bitmap;
+        init_bitmap_frame(bitmap, frame, thresh, lt);
+      } else {
+        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL,
+                                 &ctx->adapted);
+        bitmap = &ctx->pool->bitmap;
+        init_bitmap(bitmap, &image, thresh, lt);
+      }
+      rle = &ctx->pool->rle;
+      encode_rle(rle, bitmap);
+      rle_save_pbm(rle, output_file, flags);
+    } else {
+      save_image("output", image, output_fmt, output_file, flags);
+    }
+  }
+
+  /* stop if only image processing shall be done */
+  if(flags & PROCESS_ONLY) {
+    if(image) free_work_image(image, &loaded);
+    return 3;
+  }
+
+  /* adapt threshold to image (unless this is already done) */
+  if(frame) {
+    thresh = adapt_threshold_frame(frame, thresh, lt, flags, INITIAL,
+                                   &ctx->adapted);
+  } else {
+    thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL, &ctx->adapted);
+  }
+
+  if(flags & USE_DEBUG_IMAGE) {
+    /* copy processed image to debug image */
+    debug_image = make_mono(&image, thresh, lt);
+  }
+
+  /* threshold the image once and work on runs of set pixels afterwards */
+  if(!rle) {
+    bitmap = &ctx->pool->bitmap;
+    if(frame) {
+      init_bitmap_frame(bitmap, frame, thresh, lt);
+    } else {
+      init_bitmap(bitmap, &image, thresh, lt);
+    }
+    rle = &ctx->pool->rle;
+    encode_rle(rle, bitmap);
+  }
+
+  /* start image segmentation into possible characters / digits */
+  if (flags & DEBUG_OUTPUT) {
+    fputs("starting image segmentation\n", stderr);
+    fputs("starting horizontal partitioning\n", stderr);
+  }
+
+  if(flags & COMPONENT_SEGMENTS) {
+    potential_digits = segment_components(debug_image, image, rle,
+                                          ignore_pixels, &digits, flags);
+  } else {
+    potential_digits = segment_profiles(debug_image, image, rle,
+                                        ignore_pixels, &digits, flags);
+  }
+
+  if (flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "image segmentation found %d potential digits\n",
+            potential_digits);
+  }
+
+  /* image has been segmented into potential digits, ignore too small ones */
+  if (min_char_dims.w > 1 || min_char_dims.h > 1) {
+    int digit_count = 0, pos;
+    if (flags & DEBUG_OUTPUT) {
+      fputs("dropping too small potential digits\n", stderr);
+    }
+    /* count sufficiently large digits */
+    for (d = 0; d < potential_digits; d++) {
+      if (digits[d].x2 - digits[d].x1 >= min_char_dims.w &&
+          digits[d].y2 - digits[d].y1 >= min_char_dims.h) {
+        if (flags & DEBUG_OUTPUT) {
+          fprintf(stderr, " keeping sufficiently large digit %d\n", d);
+        }
+        digit_count += 1;
+      } else if (flags & DEBUG_OUTPUT) {
+        fprintf(stderr, " dropping too small potential digit %d\n", d);
+      }
+    }
+    if (flags & DEBUG_OUTPUT) {
+      fprintf(stderr, "keeping %d of %d potential digits\n", digit_count,
+              potential_digits);
+    }
+    /* at least one digit is required */
+    if (digit_count < 1) {
+      fputs(PROG ": error: no sufficiently large digits found\n", stderr);
+      if(image) free_work_image(image, &loaded);
+      if(flags & USE_DEBUG_IMAGE) {
+        free_work_image(debug_image, &loaded);
+      }
+      return 1;
+    }
+    /* ensure we do not try to keep more digits than we have found */
+    if(digit_count > potential_digits) {
+      fprintf(stderr,
+              PROG ": error: trying to keep more digits (%d) than found (%d)\n",
+              digit_count, potential_digits);
+      if(image) free_work_image(image, &loaded);
+      if(flags & USE_DEBUG_IMAGE) {
+        free_work_image(debug_image, &loaded);
+      }
+      return 99;
+    }
+    /* if potential digits are discarded, move remaining ones to the front */
+    if(digit_count < potential_digits) {
+      /* keep only sufficiently large digits */
+      pos = 0;
+      for (d = 0; d < potential_digits; d++) {
+        if (digits[d].x2 - digits[d].x1 >= min_char_dims.w &&
+            digits[d].y2 - digits[d].y1 >= min_char_dims.h) {
+          if (pos >= digit_count) {
+            fputs(PROG ": error copying digit information", stderr);
+            if(image) free_work_image(image, &loaded);
+            if(flags & USE_DEBUG_IMAGE) {
+              free_work_image(debug_image, &loaded);
+            }
+            return 99;
+          }
+          if(pos != d) digits[pos] = digits[d];
+          pos++;
+        }
+      }
+      potential_digits = digit_count;
+    }
+  }
+
+  /* check if expected number of digits have been found */
+  if ((expected_digits.min > -1) &&
+      ((potential_digits < expected_digits.min) ||
+       (potential_digits > expected_digits.max))) {
+    if (expected_digits.min != expected_digits.max) {
+      fprintf(stderr,
+              PROG ": expected between %d and %d digits, but found %d\n",
+              expected_digits.min, expected_digits.max, potential_digits);
+    } else {
+      fprintf(stderr, PROG ": expected %d digit%s, but found %d\n",
+              expected_digits.min, expected_digits.min > 1 ? "s" : "",
+              potential_digits);
+    }
+    if(image) free_work_image(image, &loaded);
+    if(flags & USE_DEBUG_IMAGE) {
+      save_image("debug", debug_image, output_fmt,debug_image_file,flags);
+      free_work_image(debug_image, &loaded);
+    }
+    return 1;
+  }
+
+  /* continue to work with the accepted number of characters / digits */
+  number_of_digits = potential_digits;
+  if (flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "image segmentation found %d digits\n", number_of_digits);
+  }
+
+  /* draw rectangles around accepted digits */
+  if(flags & USE_DEBUG_IMAGE) {
+    imlib_context_set_image(debug_image);
+    imlib_context_set_color(128,128,128,255); /* gray line */
+    for(d=0; d<number_of_digits; d++) {
+      imlib_image_draw_rectangle(digits[d].x1, digits[d].y1,
+          digits[d].x2-digits[d].x1, digits[d].y2-digits[d].y1);
+    }
+    imlib_context_set_image(image);
+  }
+
+  /* determine size of digit part of the image */
+  dig_w = digits[number_of_digits-1].x2 - digits[0].x1;
+  dig_h = digits[number_of_digits-1].y2 - digits[0].y1;
+  if (flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "total width of digit area is %d\n", dig_w);
+    fprintf(stderr, "total height of digit area is %d\n", dig_h);
+  }
+
+  /* determine maximum digit dimensions */
+  for(d=0; d<number_of_digits; d++) {
+    if(max_dig_w < digits[d].x2 - digits[d].x1)
+      max_dig_w = digits[d].x2 - digits[d].x1;
+    if(max_dig_h < digits[d].y2 - digits[d].y1)
+      max_dig_h = digits[d].y2 - digits[d].y1;
+  }
+  if(flags & DEBUG_OUTPUT)
+    fprintf(stderr, "digits are at most %d pixels wide and %d pixels high\n",
+                    max_dig_w, max_dig_h);
+
+  /* debug: write digit info to stderr */
+  if(flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "found %d digits\n", number_of_digits);
+    for(d=0; d<number_of_digits; d++) {
+      fprintf(stderr, "digit %d: (%d,%d) -> (%d,%d), width: %d (%5.2f%%) "
+                      "height: %d (%5.2f%%)\n",
+                      d,
+                      digits[d].x1, digits[d].y1, digits[d].x2, digits[d].y2,
+                      digits[d].x2 - digits[d].x1,
+                      ((digits[d].x2 - digits[d].x1) * 100.0) / dig_w,
+                      digits[d].y2 - digits[d].y1,
+                      ((digits[d].y2 - digits[d].y1) * 100.0) / dig_h
+             );
+      fprintf(stderr, "  height/width (int): ");
+      if(digits[d].x1 == digits[d].x2) {
+        fprintf(stderr, "NaN, max_dig_w/width (int): NaN, ");
+      } else {
+        fprintf(stderr, "%d, max_dig_w/width (int): %d, ",
+                       (digits[d].y2-digits[d].y1)/(digits[d].x2-digits[d].x1),
+                       max_dig_w / (digits[d].x2 - digits[d].x1)
+              );
+      }
+      fprintf(stderr, "max_dig_h/height (int): ");
+      if(digits[d].y1 == digits[d].y2) {
+        fprintf(stderr, "NaN\n");
+      } else {
+        fprintf(stderr, "%d\n",
+                        max_dig_h / (digits[d].y2 - digits[d].y1)
+               );
+      }
+    }
+  }
+
+  /* at this point the digit 1 can be identified, because it is smaller than
+   * the other digits */
+  if(flags & DEBUG_OUTPUT)
+    fputs("looking for digit 1\n",stderr);
+  for(d=0; d<number_of_digits; d++) {
+    /* skip digits too narrow for a segment */
+    if(digits[d].x2 - digits[d].x1 < min_segment) {
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " skipping too narrow digit %d with width %d\n", d,
+                digits[d].x2 - digits[d].x1);
+      continue;
+    }
+    /* if width of digit is less than 1/one_ratio of its height it is a 1
+     * (the default 1/3 is arbitarily chosen -- normally seven segment
+     * displays use digits that are 2 times as high as wide) */
+    if((digits[d].y2-digits[d].y1+0.5)/(digits[d].x2-digits[d].x1) > one_ratio){
+      if(flags & DEBUG_OUTPUT) {
+        fprintf(stderr, " digit %d is a 1 (height/width = %d/%d = (int) %d)\n",
+               d, digits[d].y2 - digits[d].y1, digits[d].x2 - digits[d].x1,
+               (digits[d].y2 - digits[d].y1) / (digits[d].x2 - digits[d].x1));
+      }
+      digits[d].digit = D_ONE;
+    }
+  }
+
+  /* area based recognition counts pixels using a summed-area table */
+  if(flags & AREA_SEGMENTS) {
+    bitmap_build_sat(bitmap);
+    /* yellow rectangle for checked decimal point areas */
+    d_color.R = d_color.G = d_color.A = 255;
+    d_color.B = 0;
+  }
+
+  /* identify a decimal point (or thousands separator) by relative size */
+  if(flags & DEBUG_OUTPUT)
+    fputs("looking for decimal points\n",stderr);
+  for(d=0; d<number_of_digits; d++) {
+    /* skip digits with zero width or height */
+    if((digits[d].x1 == digits[d].x2) || (digits[d].y1 == digits[d].y2)) {
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " skipping digit %d with zero width or height\n", d);
+      continue;
+    }
+    /* if height of a digit is less than 1/5 of the maximum digit height,
+     * and its width is less than 1/2 of the maximum digit width (the widest
+     * digit might be a one), assume it is a decimal point */
+    if((digits[d].digit == D_UNKNOWN) &&
+       (max_dig_h / (digits[d].y2 - digits[d].y1) > dec_h_ratio) &&
+       (max_dig_w / (digits[d].x2 - digits[d].x1) > dec_w_ratio) &&
+       (!(flags & AREA_SEGMENTS) ||
+        segment_area(&debug_image, bitmap, digits[d].x1, digits[d].y1,
+                     digits[d].x2, digits[d].y2, d_color, flags)
+        >= segment_fill)) {
+      digits[d].digit = D_DECIMAL;
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " digit %d is a decimal point\n", d);
+    }
+  }
+
+  /* identify a minus sign */
+  if(flags & DEBUG_OUTPUT)
+    fputs("looking for minus signs\n",stderr);
+  for(d=0; d<number_of_digits; d++) {
+    /* skip digits too short for a segment */
+    if(digits[d].y2 - digits[d].y1 < min_segment) {
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " skipping too short digit %d with height %d\n", d,
+                digits[d].y2 - digits[d].y1);
+      continue;
+    }
+    /* if height of digit is less than 1/minus_ratio of its height it is a 1
+     * (the default 1/3 is arbitarily chosen -- normally seven segment
+     * displays use digits that are 2 times as high as wide) */
+    if((digits[d].digit == D_UNKNOWN) &&
+       ((digits[d].x2-digits[d].x1)/(digits[d].y2-digits[d].y1)>=minus_ratio)) {
+      if(flags & DEBUG_OUTPUT) {
+        fprintf(stderr,
+               " digit %d is a minus (width/height = %d/%d = (int) %d)\n",
+               d, digits[d].x2 - digits[d].x1, digits[d].y2 - digits[d].y1,
+               (digits[d].x2 - digits[d].x1) / (digits[d].y2 - digits[d].y1));
+      }
+      digits[d].digit = D_MINUS;
+    }
+  }
+
+  /* If the widest digit is a one, decimal points may be of the same width,
+   * and may thus not be detected.  Now that minus signs have been selected,
+   * if the widest digit still is a one (i.e., no minus signs), then decimal
+   * separators may also be recognized by checking only the height, not the
+   * width. */
+  if(flags & DEBUG_OUTPUT)
+    fputs("checking for special case of a one as widest character\n",stderr);
+  /* check if the widest digit is a one */
+  for(d=0; d<number_of_digits; d++) {
+    /* skip digits with zero width or height */
+    if((digits[d].x1 == digits[d].x2) || (digits[d].y1 == digits[d].y2)) {
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " skipping digit %d with zero width or height\n", d);
+      continue;
+    }
+    if((digits[d].digit == D_ONE) && (digits[d].x2-digits[d].x1 >= max_dig_w)) {
+      widest_dig_is_one = 1;
+      if(flags & DEBUG_OUTPUT)
+        fputs(" widest digit is a one -> additional decimal point search\n",
+              stderr);
+      break;
+    }
+  }
+  if(!widest_dig_is_one) {
+    if(flags & DEBUG_OUTPUT)
+      fputs(" widest digit is not a one, skipping extra decimal point search\n",
+            stderr);
+  } else {
+    /* widest digit is a one, thus decimal seperators may have been missed:
+     * identify a decimal point (or thousands separator) by relative height */
+    if(flags & DEBUG_OUTPUT)
+      fputs("looking for decimal points again\n",stderr);
+    for(d=0; d<number_of_digits; d++) {
+      /* skip digits with zero width or height */
+      if((digits[d].x1 == digits[d].x2) || (digits[d].y1 == digits[d].y2)) {
+        if(flags & DEBUG_OUTPUT)
+          fprintf(stderr, " skipping digit %d with zero width or height\n", d);
+        continue;
+      }
+      /* if height of a digit is less than 1/5 of the maximum digit height,
+       * and its width is less than 1/2 of the maximum digit width (the widest
+       * digit might be a one), assume it is a decimal point */
+      if((digits[d].digit == D_UNKNOWN) &&
+         (max_dig_h / (digits[d].y2 - digits[d].y1) > dec_h_ratio) &&
+         (!(flags & AREA_SEGMENTS) ||
+          segment_area(&debug_image, bitmap, digits[d].x1, digits[d].y1,
+                       digits[d].x2, digits[d].y2, d_color, flags)
+          >= segment_fill)) {
+        digits[d].digit = D_DECIMAL;
+        if(flags & DEBUG_OUTPUT)
+          fprintf(stderr, " digit %d is a decimal point\n", d);
+      }
+    }
+  }
+
+  /* now the digits are located and they have to be identified */
+  if(flags & DEBUG_OUTPUT)
+    fprintf(stderr, "starting %s based recognition for remaining digits\n",
+                    (flags & AREA_SEGMENTS) ? "area" : "scanline");
+  /* iterate over digits */
+  for(d=0; d<number_of_digits; d++) {
+    int d_height=0; /* height of digit */
+    /* skip digits too small to contain a segment */
+    if((digits[d].x2 - digits[d].x1 < min_segment) ||
+       (digits[d].y2 - digits[d].y1 < min_segment)) {
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " skipping digit %d smaller than minimum segment\n", d);
+      continue;
+    }
+    /* skip already recognized digits */
+    if((digits[d].digit == D_UNKNOWN) && (flags & AREA_SEGMENTS)) {
+      int x1 = digits[d].x1, y1 = digits[d].y1;
+      int x2 = digits[d].x2, y2 = digits[d].y2;
+      int d_width = x2 - x1; /* width of digit */
+      int fill; /* percentage of segment area set */
+      d_height = y2 - y1;
+      /* check horizontal segments (central half of digit width, one third
+       * of digit height each) */
+      d_color.R = d_color.A = 255;
+      d_color.G = d_color.B = 0;
+      fill = segment_area(&debug_image, bitmap, x1 + d_width/4, y1,
+                          x2 - d_width/4, y1 + d_height/3, d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= HORIZ_UP; /* add upper segment */
+      }
+      d_color.G = d_color.A = 255;
+      d_color.R = d_color.B = 0;
+      fill = segment_area(&debug_image, bitmap, x1 + d_width/4,
+                          y1 + d_height/3, x2 - d_width/4, y1 + 2*d_height/3,
+                          d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= HORIZ_MID; /* add middle segment */
+      }
+      d_color.B = d_color.A = 255;
+      d_color.R = d_color.G = 0;
+      fill = segment_area(&debug_image, bitmap, x1 + d_width/4,
+                          y1 + 2*d_height/3, x2 - d_width/4, y2,
+                          d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= HORIZ_DOWN; /* add lower segment */
+      }
+      /* check upper vertical segments (half of digit width, band around the
+       * upper quarter of digit height) */
+      d_color.R = d_color.A = 255;
+      d_color.G = d_color.B = 0;
+      fill = segment_area(&debug_image, bitmap, x1, y1 + d_height/8,
+                          x1 + d_width/2, y1 + 3*d_height/8, d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= VERT_LEFT_UP; /* add upper left segment */
+      }
+      d_color.G = d_color.A = 255;
+      d_color.R = d_color.B = 0;
+      fill = segment_area(&debug_image, bitmap, x1 + d_width/2 + 1,
+                          y1 + d_height/8, x2, y1 + 3*d_height/8,
+                          d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= VERT_RIGHT_UP; /* add upper right segment */
+      }
+      /* check lower vertical segments (half of digit width, band around the
+       * lower quarter of digit height) */
+      d_color.R = d_color.A = 255;
+      d_color.G = d_color.B = 0;
+      fill = segment_area(&debug_image, bitmap, x1, y1 + 5*d_height/8,
+                          x1 + d_width/2, y1 + 7*d_height/8, d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= VERT_LEFT_DOWN; /* add lower left segment */
+      }
+      d_color.G = d_color.A = 255;
+      d_color.R = d_color.B = 0;
+      fill = segment_area(&debug_image, bitmap, x1 + d_width/2 + 1,
+                          y1 + 5*d_height/8, x2, y1 + 7*d_height/8,
+                          d_color, flags);
+      if(fill >= segment_fill) {
+        digits[d].digit |= VERT_RIGHT_DOWN; /* add lower right segment */
+      }
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, " digit %d has segments 0x%02x\n", d, digits[d].digit);
+    } else if(digits[d].digit == D_UNKNOWN) {
+      int middle = (digits[d].x1 + digits[d].x2) / 2;
+      int quarter = digits[d].y1 + (digits[d].y2 - digits[d].y1) / 4;
+      int three_quarters = digits[d].y1 + 3 * (digits[d].y2 - digits[d].y1) / 4;
+      found_pixels=0; /* how many pixels are already found */
+      d_height = digits[d].y2 - digits[d].y1;
+      /* check horizontal segments (vertical scan, x == middle) */
+      d_color.R = d_color.A = 255;
+      d_color.G = d_color.B = 0;
+      found_pixels = scanline(&debug_image, rle, middle, digits[d].y1,
+                              d_height/3, VERTICAL, d_color, flags);
+      if(found_pixels >= need_pixels) {
+        digits[d].digit |= HORIZ_UP; /* add upper segment */
+      }
+      d_color.G = d_color.A = 255;
+      d_color.R = d_color.B = 0;
+      found_pixels = scanline(&debug_image, rle, middle,
+                              digits[d].y1 + d_height/3, d_height/3, VERTICAL,
+                              d_color, flags);
+      if(found_pixels >= need_pixels) {
+        digits[d].digit |= HORIZ_MID; /* add middle segment */
+      }
+      d_color.B = d_color.A = 255;
+      d_color.R = d_color.G = 0;
+      found_pixels = scanline(&debug_image, rle, middle,
+                              digits[d].y1 + 2*d_height/3, d_height/3, VERTICAL,
+                              d_color, flags);
+      if(found_pixels >= need_pixels) {
+        digits[d].digit |= HORIZ_DOWN; /* add lower segment */
+      }
+      /* check upper vertical segments (horizontal scan, y == quarter) */
+      d_color.R = d_color.A = 255;
+      d_color.G = d_color.B = 0;
+      found_pixels = scanline(&debug_image, rle, digits[d].x1, quarter,
+                              (digits[d].x2 - digits[d].x1) / 2, HORIZONTAL,
+                              d_color, flags);
+      if (found_pixels >= need_pixels) {
+        digits[d].digit |= VERT_LEFT_UP; /* add upper left segment */
+      }
+      d_color.G = d_color.A = 255;
+      d_color.R = d_color.B = 0;
+      found_pixels = scanline(&debug_image, rle,
+                              (digits[d].x1 + digits[d].x2) / 2 + 1,
+                              quarter, (digits[d].x2 - digits[d].x1) / 2 - 1,
+                              HORIZONTAL, d_color, flags);
+      if (found_pixels >= need_pixels) {
+        digits[d].digit |= VERT_RIGHT_UP; /* add upper right segment */
+      }
+      /* check lower vertical segments (horizontal scan, y == three_quarters) */
+      d_color.R = d_color.A = 255;
+      d_color.G = d_color.B = 0;
+      found_pixels = scanline(&debug_image, rle, digits[d].x1,
+                              three_quarters, (digits[d].x2 - digits[d].x1) / 2,
+                              HORIZONTAL, d_color, flags);
+      if (found_pixels >= need_pixels) {
+        digits[d].digit |= VERT_LEFT_DOWN; /* add lower left segment */
+      }
+      d_color.G = d_color.A = 255;
+      d_color.R = d_color.B = 0;
+      found_pixels = scanline(&debug_image, rle,
+                              (digits[d].x1 + digits[d].x2) / 2 + 1,
+                              three_quarters, (digits[d].x2-digits[d].x1)/2 - 1,
+                              HORIZONTAL, d_color, flags);
+      if (found_pixels >= need_pixels) {
+        digits[d].digit |= VERT_RIGHT_DOWN; /* add lower right segment */
+      }
+    }
+  }
+
+  /* check spacing of digits when --print-spaces is given and there are more
+   * more than two digits
+  */
+  if ((flags & PRINT_SPACES) && (number_of_digits > 2)) {
+    int min_dst, avg_dst, dst_sum, cur_dst, base_dst, num_spc;
+    if (flags & DEBUG_OUTPUT) {
+      fputs("looking for white space\n", stderr);
+    }
+
+    /* determine distance between digits */
+    min_dst = dst_sum = digits[1].x2 - digits[0].x2;
+    if (flags & DEBUG_OUTPUT) {
+      fprintf(stderr, " distance between digits 0 and 1 is %d\n", min_dst);
+    }
+    for (i = 2; i < number_of_digits; i++) {
+      cur_dst = digits[i].x2 - digits[i-1].x2;
+      if (flags & DEBUG_OUTPUT) {
+        fprintf(stderr, " distance between digits %d and %d is %d\n",
+                       i-1, i, cur_dst);
+      }
+      if (cur_dst < min_dst) {
+        min_dst = cur_dst;
+      }
+      dst_sum += cur_dst;
+    }
+    avg_dst = dst_sum / (number_of_digits - 1);
+    base_dst = (flags & SPC_USE_AVG_DST) ? avg_dst : min_dst;
+    if (base_dst < 1) {
+      base_dst = 1;
+    }
+    if (flags & DEBUG_OUTPUT) {
+      fprintf(stderr, " minimum digit distance: %d\n", min_dst);
+      fprintf(stderr, " average digit distance: %d\n", avg_dst);
+      fprintf(stderr, " adding spaces for distance greater than: %d\n",
+                      (int) (spc_fac * base_dst));
+    }
+
+    /* determine number of spaces after each digit */
+    for (i = 0; i < (number_of_digits - 1); i++) {
+      num_spc = (int) ((digits[i+1].x2 - digits[i].x2) / (spc_fac * base_dst));
+      if (num_spc > 0) {
+        if (flags & DEBUG_OUTPUT) {
+          fprintf(stderr, " adding %d space character(s) after digit %d\n",
+                          num_spc, i);
+        }
+        digits[i].spaces = num_spc;
+      }
+    }
+  }
+
+  /* print found segments as ASCII art if debug output is enabled
+   * or ASCII art output is requested explicitely
+   * example digits known by ssocr:
+   *   _      _  _       _   _  _   _   _   _
+   *  | |  |  _| _| |_| |_  |_   | | | |_| |_|
+   *  |_|  | |_  _|   |  _| |_|  |   | |_|  _|
+  */
+  if(flags & (DEBUG_OUTPUT | ASCII_ART_SEGMENTS)) {
+    fputs("Display as seen by ssocr:\n", stderr);
+    /* top row */
+    for(i=0; i<number_of_digits; i++) {
+      fputc(' ', stderr);
+      fputc(' ', stderr);
+      digits[i].digit & HORIZ_UP ? fputc('_', stderr) : fputc(' ', stderr);
+      fputc(' ', stderr);
+      print_spaces(stderr, digits[i].spaces * 3);
+    }
+    fputc('\n', stderr);
+    /* middle row */
+    for(i=0; i<number_of_digits; i++) {
+      fputc(' ', stderr);
+      digits[i].digit & VERT_LEFT_UP ? fputc('|', stderr) : fputc(' ', stderr);
+      digits[i].digit & HORIZ_MID ? fputc('_', stderr) :
+        digits[i].digit == D_MINUS ? fputc('_', stderr) : fputc(' ', stderr);
+      digits[i].digit & VERT_RIGHT_UP ? fputc('|', stderr) : fputc(' ', stderr);
+      print_spaces(stderr, digits[i].spaces * 3);
+    }
+    fputc('\n', stderr);
+    /* bottom row */
+    for(i=0; i<number_of_digits; i++) {
+      fputc(' ', stderr);
+      digits[i].digit&VERT_LEFT_DOWN ? fputc('|', stderr) : fputc(' ', stderr);
+      digits[i].digit&HORIZ_DOWN ? fputc('_', stderr) : 
+        digits[i].digit == D_DECIMAL ? fputc('.', stderr) : fputc(' ', stderr);
+      digits[i].digit&VERT_RIGHT_DOWN ? fputc('|', stderr) : fputc(' ', stderr);
+      print_spaces(stderr, digits[i].spaces * 3);
+    }
+    fputs("\n\n", stderr);
+  }
+
+  /* characters to print */
+  if(flags & PRINT_AS_HEX) {
+    char hex[16];
+    for(i=0; i<number_of_digits; i++) {
+      if(i > 0) add_chars(ctx, ':', 1);
+      snprintf(hex, sizeof(hex), "%02x", digits[i].digit);
+      for(c=0; hex[c]; c++) add_chars(ctx, hex[c], 1);
+      add_chars(ctx, ' ', digits[i].spaces);
+    }
+  } else {
+    for(i=0; i<number_of_digits; i++) {
+      char ch = digit_char(ctx->charset_array, digits[i].digit);
+      if(ch == '_') unknown_digit++;
+      if(!((ch == '.') && (flags & OMIT_DECIMAL))) add_chars(ctx, ch, 1);
+      add_chars(ctx, ' ', digits[i].spaces);
+    }
+  }
+
+  if(flags & DEBUG_OUTPUT) {
+    fprintf(stderr, "thresholded image consists of %d runs of set pixels\n",
+            rle->nruns);
+  }
+
+  /* clean up, but keep the digits (in the buffer pool) in the context */
+  ctx->digits = digits;
+  ctx->ndigits = number_of_digits;
+  if(image) free_work_image(image, &loaded);
+  if(flags & USE_DEBUG_IMAGE) {
+    save_image("debug", debug_image, output_fmt, debug_image_file, flags);
+    free_work_image(debug_image, &loaded);
+  }
+
+  /* determin error code */
+  return unknown_digit ? 2 : 0;
+}
+
+/* set all options to their defaults */
+void ssocr_default_options(options_struct *opt)
+{
+  memset(opt, 0, sizeof(options_struct));
+  opt->thresh = THRESHOLD;
+  opt->flags = 0;
+  opt->lt = DEFAULT_LUM_FORMULA;
+  opt->charset = DEFAULT_CHARSET;
+  opt->need_pixels = NEED_PIXELS;
+  opt->segment_fill = SEGMENT_FILL;
+  opt->min_segment = MIN_SEGMENT;
+  opt->min_char_dims.w = MIN_CHAR_W;
+  opt->min_char_dims.h = MIN_CHAR_H;
+  opt->expected_digits.min = opt->expected_digits.max = NUMBER_OF_DIGITS;
+  opt->ignore_pixels = IGNORE_PIXELS;
+  opt->one_ratio = ONE_RATIO;
+  opt->minus_ratio = MINUS_RATIO;
+  opt->dec_h_ratio = DEC_H_RATIO;
+  opt->dec_w_ratio = DEC_W_RATIO;
+  opt->spc_fac = SPC_FAC;
+  opt->jpeg_scale = JPEG_SCALE;
+  opt->jobs = JOBS;
+  opt->threads = THREADS;
+  opt->backlog = STREAM_BACKLOG;
+  opt->queue_depth = PIPELINE_DEPTH;
+  opt->affinity[0] = opt->affinity[1] = opt->affinity[2] = -1;
+  opt->skip_tolerance = SKIP_TOLERANCE;
+  opt->foreground = SSOCR_DEFAULT_FOREGROUND;
+  opt->background = SSOCR_DEFAULT_BACKGROUND;
+}
+
+/* create a context using copies of the options and commands, the commands
+ * still refer to the argv given to ssocr_parse_commands() */
+ssocr_ctx_struct *ssocr_new_ctx(const options_struct *opt,
+                                const command_struct *cmds, int ncmds)
+{
+  ssocr_ctx_struct *ctx;
+
+  if(!(ctx = calloc(1, sizeof(ssocr_ctx_struct)))) {
+    perror(PROG ": ctx = calloc()");
+    exit(99);
+  }
+  ctx->opt = *opt;
+  if(ncmds > 0) {
+    if(!(ctx->cmds = calloc(ncmds, sizeof(command_struct)))) {
+      perror(PROG ": ctx->cmds = calloc()");
+      exit(99);
+    }
+    memcpy(ctx->cmds, cmds, ncmds * sizeof(command_struct));
+    ctx->ncmds = ncmds;
+  }
+  init_charset(opt->charset, ctx->charset_array);
+  ctx->text_size = 16;
+  if(!(ctx->text = calloc(ctx->text_size, sizeof(char)))) {
+    perror(PROG ": ctx->text = calloc()");
+    exit(99);
+  }
+  ctx->pool = new_buf_pool();
+  ctx->team = new_band_team(opt->threads);
+  return ctx;
+}
+
+/* free a context */
+void ssocr_free_ctx(ssocr_ctx_struct *ctx)
+{
+  int held = imlib_lock_held; /* is Imlib2 already used by this thread? */
+
+  if(!ctx) return;
+  /* the images of the buffer pool are freed using Imlib2 */
+  ssocr_lock_imlib();
+  free_buf_pool(ctx->pool);
+  if(!held) ssocr_unlock_imlib();
+  free_band_team(ctx->team);
+  free(ctx->cmds);
+  free(ctx->text);
+  free(ctx);
+}
+
+/* recognize the digits of an Imlib2 image (which is freed) or of a frame
+ * (which is not freed), the name is used for messages only,
+ * return the exit code for the image and fill result if not NULL */
+int ssocr_recognize(ssocr_ctx_struct *ctx, Imlib_Image image,
+                    frame_struct *frame, const char *name,
+                    ssocr_result_struct *result)
+{
+  unsigned long int allocations; /* buffers allocated before this image */
+  frame_struct copy; /* view of the pixels of image copied to the pool */
+  int status;
+
+  ctx->allocations = 0;
+  if(!image && !frame) {
+    fprintf(stderr, "%s: error: no image given\n", PROG);
+    status = no_result(ctx);
+  } else {
+    /* an Imlib2 image is used while holding the lock */
+    if(image) ssocr_lock_imlib();
+    set_buf_pool(ctx->pool);
+    set_band_team(ctx->team);
+    allocations = buf_allocations();
+    if(image && frame_suffices(ctx)) {
+      /* other threads may use Imlib2 while the copy is processed */
+      imlib_context_set_image(image);
+      image_to_frame(&copy);
+      imlib_free_image_and_decache();
+      ssocr_unlock_imlib();
+      status = process_image(ctx, NULL, &copy, 1, name);
+    } else {
+      status = process_image(ctx, image, frame, 0, name);
+    }
+    if(!ctx->unchanged) ctx->ref_status = status;
+    ctx->allocations = buf_allocations() - allocations;
+    set_buf_pool(NULL);
+    set_band_team(NULL);
+    ssocr_unlock_imlib();
+    if(ctx->opt.flags & DEBUG_OUTPUT) {
+      fprintf(stderr, "allocated %lu buffers and images for this image\n",
+              ctx->allocations);
+    }
+  }
+  if(result) {
+    result->status = status;
+    result->allocations = ctx->allocations;
+    result->unchanged = ctx->unchanged;
+    result->ndigits = ctx->ndigits;
+    result->digits = ctx->digits;
+    result->text = ctx->text;
+  }
+  return status;
+}
+
+/* recognize the digits of w x h pixels in memory owned by the caller without
+ * converting them, rows are stride bytes apart, fmt is any frame format but
+ * FRAME_PAL8, the chroma plane of FRAME_NV12 follows the h rows of luma,
+ * return the exit code for the image and fill result if not NULL */
+int ssocr_recognize_buffer(ssocr_ctx_struct *ctx, const unsigned char *pixels,
+                           frame_fmt_t fmt, int w, int h, size_t stride,
+                           ssocr_result_struct *result)
+{
+  frame_struct frame; /* view of the caller's pixels */
+  size_t row_len = 0; /* minimum number of bytes of a row */
+
+  if(fmt != FRAME_PAL8 && w > 0) row_len = frame_row_len(fmt, w);
+  if(!pixels || w < 1 || h < 1 || row_len == 0 || stride < row_len) {
+    fprintf(stderr, "%s: error: invalid pixel buffer\n", PROG);
+    if(result) {
+      result->status = no_result(ctx);
+      result->allocations = 0;
+      result->unchanged = 0;
+      result->ndigits = 0;
+      result->digits = ctx->digits;
+      result->text = ctx->text;
+    }
+    return 99;
+  }
+  memset(&frame, 0, sizeof(frame));
+  frame.fmt = fmt;
+  frame.w = w;
+  frame.h = h;
+  frame.stride = stride;
+  frame.data = pixels;
+  if(fmt == FRAME_NV12) frame.uv = pixels + (size_t)h * stride;
+  return ssocr_recognize(ctx, NULL, &frame, "buffer", result);
+}
@@ -0,0 +1,119 @@
+/* Seven Segment Optical Character Recognition Library */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* The recognition of ssocr as a library: a context holds the options, the
+ * parsed commands, and all state of recognizing one image, thus different
+ * contexts can be used concurrently by different threads.  Images are given
+ * as Imlib2 images, as frames, or as pixel buffers owned by the caller.
+ * Functions report errors by returning an exit code as described in the
+ * EXIT STATUS section of the manual page, only failing memory allocation
+ * terminates the process.  Imlib2 is used by one thread at a time.
+ *
+ * Needs <X11/Xlib.h>, <Imlib2.h>, and <stdio.h> to be included before. */
+
+#ifndef SSOCR2_LIBSSOCR_H
+#define SSOCR2_LIBSSOCR_H
+
+#include "defines.h"        /* defines and enums */
+#include "ssocr.h"          /* options, commands, digits */
+#include "frame.h"          /* frames */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* result of recognizing an image, the memory belongs to the context and is
+ * valid until the next image is recognized with that context */
+typedef struct {
+  int status;                 /* exit code for this image */
+  int ndigits;                /* number of accepted digits */
+  const digit_struct *digits; /* positions and segments of accepted digits */
+  const char *text;           /* recognized characters as printed by ssocr */
+  unsigned long int allocations; /* buffers and images allocated for it */
+  int unchanged;              /* is it the result of the last image repeated? */
+} ssocr_result_struct;
+
+/* options, commands, and state of recognition for one thread */
+typedef struct ssocr_ctx_s {
+  options_struct opt;         /* options used for every image */
+  command_struct *cmds;       /* image processing commands */
+  int ncmds;                  /* number of commands */
+  char charset_array[CHARSET_MAX + 1]; /* character of every digit */
+  int adapted;                /* has the threshold been adapted to image? */
+  digit_struct *digits;       /* digits of the last image */
+  int ndigits;                /* number of digits of the last image */
+  char *text;                 /* characters recognized in the last image */
+  size_t text_len;            /* length of text */
+  size_t text_size;           /* allocated memory for text */
+  struct buf_pool_s *pool;    /* memory reused from image to image */
+  struct band_team_s *team;   /* threads processing bands of an image */
+  unsigned long int allocations; /* buffers allocated for the last image */
+  int unchanged;              /* has the last image been skipped? */
+  int ref_valid;              /* is there a reference image to compare to? */
+  int ref_w, ref_h;           /* dimensions of the reference region */
+  unsigned long long int ref_hash; /* hash of the reference luminance */
+  int ref_status;             /* exit code for the reference image */
+} ssocr_ctx_struct;
+
+/* functions */
+
+/* set all options to their defaults */
+void ssocr_default_options(options_struct *opt);
+
+/* parse the image processing commands argv[first] to argv[last-1],
+ * store them in newly allocated memory, return the number of commands or -1
+ * after printing an error message, if end is not NULL, stop at the first
+ * argument that is not a command and store its index in end,
+ * the commands refer to argv, which must not be changed */
+int ssocr_parse_commands(char **argv, int first, int last,
+                         command_struct **cmds_ptr, int *end);
+
+/* create a context using copies of the options and commands, the commands
+ * still refer to the argv given to ssocr_parse_commands() */
+ssocr_ctx_struct *ssocr_new_ctx(const options_struct *opt,
+                                const command_struct *cmds, int ncmds);
+
+/* free a context */
+void ssocr_free_ctx(ssocr_ctx_struct *ctx);
+
+/* recognize the digits of an Imlib2 image (which is freed) or of a frame
+ * (which is not freed), the name is used for messages only,
+ * return the exit code for the image and fill result if not NULL */
+int ssocr_recognize(ssocr_ctx_struct *ctx, Imlib_Image image,
+                    frame_struct *frame, const char *name,
+                    ssocr_result_struct *result);
+
+/* recognize the digits of w x h pixels in memory owned by the caller without
+ * converting them, rows are stride bytes apart, fmt is any frame format but
+ * FRAME_PAL8, the chroma plane of FRAME_NV12 follows the h rows of luma,
+ * return the exit code for the image and fill result if not NULL */
+int ssocr_recognize_buffer(ssocr_ctx_struct *ctx, const unsigned char *pixels,
+                           frame_fmt_t fmt, int w, int h, size_t stride,
+                           ssocr_result_struct *result);
+
+/* acquire the Imlib2 lock before using Imlib2 outside of the library */
+void ssocr_lock_imlib(void);
+
+/* release the Imlib2 lock, unless it is not held */
+void ssocr_unlock_imlib(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SSOCR2_LIBSSOCR_H */
@@ -0,0 +1,215 @@
+/* Seven Segment Optical Character Recognition MJPEG Stream Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* FILE, getc, fprintf, perror */
+#include <stdlib.h>         /* calloc, realloc, free, exit */
+#include <setjmp.h>         /* setjmp, longjmp */
+
+/* JPEG decoding */
+#include <jpeglib.h>
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "mjpeg.h"          /* MJPEG streams */
+
+/* JPEG markers needed to find the end of an image */
+#define MJPEG_EOI 0xD9      /* end of image */
+#define MJPEG_SOS 0xDA      /* start of scan, followed by entropy coded data */
+#define MJPEG_RST0 0xD0     /* first restart marker inside entropy coded data */
+#define MJPEG_RST7 0xD7     /* last restart marker */
+#define MJPEG_TEM 0x01      /* marker without parameters */
+
+/* functions */
+
+/* print a fatal libjpeg error and continue with the next frame */
+static void mjpeg_error_exit(j_common_ptr cinfo)
+{
+  mjpeg_error_struct *err = (mjpeg_error_struct *) cinfo->err;
+
+  (*cinfo->err->output_message)(cinfo);
+  longjmp(err->env, 1);
+}
+
+/* print a libjpeg message, e.g., a warning about corrupt data */
+static void mjpeg_output_message(j_common_ptr cinfo)
+{
+  char msg[JMSG_LENGTH_MAX];
+
+  (*cinfo->err->format_message)(cinfo, msg);
+  fprintf(stderr, "%s: JPEG: %s\n", PROG, msg);
+}
+
+/* create the stream state with a decompressor producing grayscale or color
+ * frames downscaled by 1/scale_denom (1, 2, 4, or 8) */
+mjpeg_struct *new_mjpeg(int scale_denom, int color)
+{
+  mjpeg_struct *mjpeg;
+
+  if(!(mjpeg = calloc(1, sizeof(mjpeg_struct)))) {
+    perror(PROG ": mjpeg = calloc()");
+    exit(99);
+  }
+  mjpeg->cinfo.err = jpeg_std_error(&mjpeg->err.pub);
+  mjpeg->err.pub.error_exit = mjpeg_error_exit;
+  mjpeg->err.pub.output_message = mjpeg_output_message;
+  jpeg_create_decompress(&mjpeg->cinfo);
+  mjpeg->scale_denom = scale_denom;
+  mjpeg->color = color;
+  return mjpeg;
+}
+
+/* free stream state including the decompressor */
+void free_mjpeg(mjpeg_struct *mjpeg)
+{
+  if(!mjpeg) return;
+  jpeg_destroy_decompress(&mjpeg->cinfo);
+  free(mjpeg->data);
+  free(mjpeg);
+}
+
+/* append one byte to the compressed data of the current frame */
+static void mjpeg_put(mjpeg_struct *mjpeg, int c)
+{
+  if(mjpeg->size >= mjpeg->data_size) {
+    unsigned char *data;
+    size_t size = mjpeg->data_size ? 2 * mjpeg->data_size : BUFSIZ;
+    if(!(data = realloc(mjpeg->data, size))) {
+      perror(PROG ": mjpeg->data = realloc()");
+      exit(99);
+    }
+    mjpeg->data = data;
+    mjpeg->data_size = size;
+  }
+  mjpeg->data[mjpeg->size++] = c;
+}
+
+/* read one JPEG image from the stream by following its marker structure,
+ * return 1 if an image has been read, 0 at the end of the stream,
+ * or -1 on error */
+static int mjpeg_read_image(FILE *stream, mjpeg_struct *mjpeg)
+{
+  int c, hi, lo, scan = 0;
+  size_t len;
+
+  /* skip anything before the SOI marker, e.g., multipart boundaries */
+  mjpeg->size = 0;
+  c = getc(stream);
+  for(;;) {
+    if(c == EOF) return 0;
+    if(c != MJPEG_SOI_0) {
+      c = getc(stream);
+    } else if((c = getc(stream)) == MJPEG_SOI_1) {
+      break;
+    }
+  }
+  mjpeg_put(mjpeg, MJPEG_SOI_0);
+  mjpeg_put(mjpeg, MJPEG_SOI_1);
+
+  for(;;) {
+    if((c = getc(stream)) == EOF) return -1;
+    /* entropy coded data is copied up to the next marker */
+    if(scan && c != 0xFF) {
+      mjpeg_put(mjpeg, c);
+      continue;
+    }
+    if(c != 0xFF) return -1;
+    while((c = getc(stream)) == 0xFF); /* skip fill bytes */
+    if(c == EOF) return -1;
+    mjpeg_put(mjpeg, 0xFF);
+    mjpeg_put(mjpeg, c);
+    if(scan && c == 0x00) continue; /* stuffed 0xFF byte of entropy data */
+    if(c == MJPEG_EOI) return 1;
+    if((c >= MJPEG_RST0 && c <= MJPEG_RST7) || c == MJPEG_TEM) continue;
+    /* any other marker starts a segment with a length field */
+    scan = (c == MJPEG_SOS);
+    if((hi = getc(stream)) == EOF || (lo = getc(stream)) == EOF) return -1;
+    mjpeg_put(mjpeg, hi);
+    mjpeg_put(mjpeg, lo);
+    len = (hi << 8) | lo;
+    if(len < 2) return -1;
+    for(len -= 2; len > 0; len--) {
+      if((c = getc(stream)) == EOF) return -1;
+      mjpeg_put(mjpeg, c);
+    }
+  }
+}
+
+/* decode the compressed data of the current frame into frame,
+ * return 1 on success or 2 if the image could not be decoded */
+static int mjpeg_decode(mjpeg_struct *mjpeg, frame_struct *frame)
+{
+  struct jpeg_decompress_struct *cinfo = &mjpeg->cinfo;
+  JSAMPROW row;
+  size_t stride, size;
+
+  if(setjmp(mjpeg->err.env)) {
+    /* the decompressor is reset and can be used for the next frame */
+    jpeg_abort_decompress(cinfo);
+    return 2;
+  }
+  jpeg_mem_src(cinfo, mjpeg->data, mjpeg->size);
+  jpeg_read_header(cinfo, TRUE);
+  /* libjpeg skips color conversion (and, for YCbCr, chroma) for grayscale
+   * output, and downscaling is done by a reduced size inverse DCT */
+  cinfo->out_color_space = mjpeg->color ? JCS_RGB : JCS_GRAYSCALE;
+  cinfo->scale_num = 1;
+  cinfo->scale_denom = mjpeg->scale_denom;
+  jpeg_start_decompress(cinfo);
+
+  stride = (size_t)cinfo->output_width * cinfo->output_components;
+  size = stride * cinfo->output_height;
+  if(size > frame->buf_size) {
+    unsigned char *buf;
+    if(!(buf = realloc(frame->buf, size))) {
+      perror(PROG ": frame->buf = realloc()");
+      exit(99);
+    }
+    frame->buf = buf;
+    frame->buf_size = size;
+  }
+  while(cinfo->output_scanline < cinfo->output_height) {
+    row = frame->buf + (size_t)cinfo->output_scanline * stride;
+    jpeg_read_scanlines(cinfo, &row, 1);
+  }
+
+  frame->fmt = mjpeg->color ? FRAME_RGB24 : FRAME_GRAY8;
+  frame->w = cinfo->output_width;
+  frame->h = cinfo->output_height;
+  frame->x0 = frame->y0 = 0;
+  frame->stride = stride;
+  frame->data = frame->buf;
+  jpeg_finish_decompress(cinfo);
+  return 1;
+}
+
+/* read and decode the next JPEG image of a stream into frame, reusing the
+ * memory of the frame, return 1 if a frame has been read, 0 at the end of the
+ * stream, -1 on error, or 2 if the image could not be decoded */
+int mjpeg_read_frame(FILE *stream, mjpeg_struct *mjpeg, frame_struct *frame)
+{
+  int ret;
+
+  if((ret = mjpeg_read_image(stream, mjpeg)) <= 0) return ret;
+  return mjpeg_decode(mjpeg, frame);
+}
@@ -0,0 +1,66 @@
+/* Seven Segment Optical Character Recognition MJPEG Stream Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_MJPEG_H
+#define SSOCR2_MJPEG_H
+
+/* the first two bytes of every JPEG image (SOI marker) */
+#define MJPEG_SOI_0 0xFF
+#define MJPEG_SOI_1 0xD8
+
+#ifdef HAVE_LIBJPEG
+
+/* libjpeg needs stdio.h and setjmp.h is needed for error recovery */
+#include <stdio.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+
+/* libjpeg error handling that allows to continue with the next frame */
+typedef struct {
+  struct jpeg_error_mgr pub;  /* standard libjpeg error handling */
+  jmp_buf env;                /* return here on a fatal decoding error */
+} mjpeg_error_struct;
+
+/* state of an MJPEG stream, i.e., a stream of concatenated JPEG images */
+typedef struct {
+  struct jpeg_decompress_struct cinfo; /* decompressor reused for all frames */
+  mjpeg_error_struct err;     /* error handling of decompressor */
+  int scale_denom;            /* downscale frames by 1/scale_denom */
+  int color;                  /* decode RGB instead of grayscale? */
+  unsigned char *data;        /* compressed data of current frame */
+  size_t size;                /* bytes of compressed data */
+  size_t data_size;           /* size of allocated memory for data */
+} mjpeg_struct;
+
+/* functions */
+
+/* create the stream state with a decompressor producing grayscale or color
+ * frames downscaled by 1/scale_denom (1, 2, 4, or 8) */
+mjpeg_struct *new_mjpeg(int scale_denom, int color);
+
+/* free stream state including the decompressor */
+void free_mjpeg(mjpeg_struct *mjpeg);
+
+/* read and decode the next JPEG image of a stream into frame, reusing the
+ * memory of the frame, return 1 if a frame has been read, 0 at the end of the
+ * stream, -1 on error, or 2 if the image could not be decoded */
+int mjpeg_read_frame(FILE *stream, mjpeg_struct *mjpeg, frame_struct *frame);
+
+#endif /* HAVE_LIBJPEG */
+
+#endif /* SSOCR2_MJPEG_H */
@@ -0,0 +1,331 @@
+/* Seven Segment Optical Character Recognition Streaming Pipeline */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifdef __linux__
+#define _GNU_SOURCE         /* pthread_setaffinity_np, CPU_SET */
+#endif
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdatomic.h>      /* atomic_load_explicit, atomic_store_explicit */
+#include <stdio.h>          /* printf, fprintf, fflush, perror */
+#include <stdlib.h>         /* calloc, realloc, free, exit */
+#include <string.h>         /* strlen, memcpy, strerror */
+#include <time.h>           /* nanosleep */
+
+/* threads */
+#include <pthread.h>        /* pthread_create, pthread_join */
+#ifdef __linux__
+#include <sched.h>          /* cpu_set_t, CPU_ZERO, CPU_SET */
+#endif
+
+/* my headers */
+#include "defines.h"        /* PROG, VERBOSE, PIPELINE_* */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "libssocr.h"       /* recognition */
+#include "pipeline.h"       /* streaming pipeline */
+
+/* alignment of the queue indices (a cache line) */
+#define PIPELINE_ALIGN 64
+
+/* a frame travelling through the pipeline */
+typedef struct {
+  frame_struct *frame;        /* frame buffer, reused for every frame */
+  unsigned long int index;    /* number of the frame in the stream */
+  int ret;                    /* result of decoding (pipeline_decode_fn) */
+  int status;                 /* exit code for the frame */
+  unsigned long int allocations; /* buffers and images allocated for it */
+  int unchanged;              /* is the result the one of the last frame? */
+  char *text;                 /* recognized digits */
+  size_t size;                /* allocated memory for text */
+} pipeline_item_struct;
+
+/* bounded queue of items for one producer and one consumer thread, head and
+ * tail count the items pushed and popped and are on different cache lines */
+typedef struct {
+  pipeline_item_struct **items; /* ring buffer */
+  unsigned long int size;     /* number of items that fit into the queue */
+  _Alignas(PIPELINE_ALIGN)
+  _Atomic unsigned long int head; /* items pushed, changed by the producer */
+  _Alignas(PIPELINE_ALIGN)
+  _Atomic unsigned long int tail; /* items popped, changed by the consumer */
+} spsc_struct;
+
+/* the pipeline of one stream */
+typedef struct {
+  spsc_struct empty;          /* from output to decoder */
+  spsc_struct decoded;        /* from decoder to processor */
+  spsc_struct done;           /* from processor to output */
+  struct ssocr_ctx_s *ctx;    /* options and commands */
+  const char *name;           /* name of the stream */
+  pipeline_decode_fn decode;  /* decoder of the stream */
+  void *arg;                  /* argument of decode */
+} pipeline_struct;
+
+/* functions */
+
+/* wait a little for the neighboring stage */
+static void pipeline_wait(void)
+{
+  struct timespec ts;
+
+  ts.tv_sec = 0;
+  ts.tv_nsec = PIPELINE_POLL * 1000L;
+  nanosleep(&ts, NULL);
+}
+
+/* initialize a queue for size items */
+static void init_spsc(spsc_struct *q, unsigned long int size)
+{
+  if(!(q->items = calloc(size, sizeof(pipeline_item_struct *)))) {
+    perror(PROG ": items = calloc()");
+    exit(99);
+  }
+  q->size = size;
+  atomic_init(&q->head, 0);
+  atomic_init(&q->tail, 0);
+}
+
+/* producer: append an item, waiting while the queue is full */
+static void spsc_push(spsc_struct *q, pipeline_item_struct *item)
+{
+  unsigned long int head = atomic_load_explicit(&q->head,
+                                                memory_order_relaxed);
+
+  while(head - atomic_load_explicit(&q->tail, memory_order_acquire) >=
+        q->size) {
+    pipeline_wait();
+  }
+  q->items[head % q->size] = item;
+  /* the item is stored before the consumer sees the new head */
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);
+}
+
+/* consumer: remove the oldest item, waiting while the queue is empty */
+static pipeline_item_struct *spsc_pop(spsc_struct *q)
+{
+  unsigned long int tail = atomic_load_explicit(&q->tail,
+                                                memory_order_relaxed);
+  pipeline_item_struct *item;
+
+  while(atomic_load_explicit(&q->head, memory_order_acquire) == tail) {
+    pipeline_wait();
+  }
+  item = q->items[tail % q->size];
+  /* the item is taken before the producer sees the new tail */
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+  return item;
+}
+
+/* bind thread to cpu (unless cpu is negative) */
+static void set_affinity(pthread_t thread, int cpu, const char *stage)
+{
+#ifdef __linux__
+  cpu_set_t set;
+  int err;
+
+  if(cpu < 0) return;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if((err = pthread_setaffinity_np(thread, sizeof(set), &set))) {
+    fprintf(stderr, "%s: warning: could not bind %s stage to CPU %d: %s\n",
+                    PROG, stage, cpu, strerror(err));
+  }
+#else
+  (void) thread;
+  if(cpu >= 0) {
+    fprintf(stderr, "%s: warning: could not bind %s stage to CPU %d: not"
+                    " supported\n", PROG, stage, cpu);
+  }
+#endif
+}
+
+/* decoder stage: decode frames into empty items until the end of the stream,
+ * the last item passed on carries the end or the error */
+static void *decode_stage(void *arg)
+{
+  pipeline_struct *p = arg;
+  pipeline_item_struct *item;
+  unsigned long int index = 0;
+  int ret;
+
+  /* the item belongs to the next stage after it has been pushed */
+  do {
+    item = spsc_pop(&p->empty);
+    item->ret = ret = p->decode(p->arg, item->frame);
+    item->index = index++;
+    spsc_push(&p->decoded, item);
+  } while(ret > 0);
+  return NULL;
+}
+
+/* processor stage: recognize the digits of every decoded frame */
+static void *process_stage(void *arg)
+{
+  pipeline_struct *p = arg;
+  pipeline_item_struct *item;
+  ssocr_result_struct res; /* digits recognized in a frame */
+  size_t len;
+  char *tmp;
+  int ret;
+
+  do {
+    item = spsc_pop(&p->decoded);
+    ret = item->ret;
+    if(ret == 1) {
+      if(p->ctx->opt.flags & VERBOSE) {
+        fprintf(stderr, "processing frame %lu\n", item->index);
+      }
+      item->status = ssocr_recognize(p->ctx, NULL, item->frame, p->name,
+                                     &res);
+      item->allocations = res.allocations;
+      item->unchanged = res.unchanged;
+      /* the result belongs to the context, keep a copy with the frame */
+      len = strlen(res.text) + 1;
+      if(len > item->size) {
+        if(!(tmp = realloc(item->text, len))) {
+          perror(PROG ": text = realloc()");
+          exit(99);
+        }
+        item->text = tmp;
+        item->size = len;
+      }
+      memcpy(item->text, res.text, len);
+    }
+    spsc_push(&p->done, item);
+  } while(ret > 0);
+  return NULL;
+}
+
+/* process every frame returned by decode with the options and commands of
+ * ctx, using ctx->opt.queue_depth items and the CPUs in ctx->opt.affinity,
+ * print one line per frame with frame index, recognized digits, and exit code
+ * for the frame, the name is used for messages only,
+ * return the exit code for the stream */
+int run_pipeline(struct ssocr_ctx_s *ctx, const char *name,
+                 pipeline_decode_fn decode, void *arg)
+{
+  pipeline_struct p;
+  pipeline_item_struct *items, *item;
+  pthread_t decoder, processor;
+  int depth = ctx->opt.queue_depth;
+  unsigned long int allocations = 0; /* buffers and images of all frames */
+  unsigned long int last = 0; /* last frame allocating buffers or images */
+  unsigned long int unchanged = 0; /* frames skipped as unchanged */
+  int i, err, ret;
+#ifdef __linux__
+  cpu_set_t old_set; /* CPUs of the calling thread */
+  int have_old_set = 0;
+#endif
+
+  p.ctx = ctx;
+  p.name = name;
+  p.decode = decode;
+  p.arg = arg;
+  if(depth < 1) depth = PIPELINE_DEPTH;
+  if(!(items = calloc(depth, sizeof(pipeline_item_struct)))) {
+    perror(PROG ": items = calloc()");
+    exit(99);
+  }
+  /* every queue can hold all items, initially all are empty */
+  init_spsc(&p.empty, depth);
+  init_spsc(&p.decoded, depth);
+  init_spsc(&p.done, depth);
+  for(i = 0; i < depth; i++) {
+    items[i].frame = new_frame();
+    spsc_push(&p.empty, items + i);
+  }
+  if(ctx->opt.flags & VERBOSE) {
+    fprintf(stderr, "pipelining up to %d frames\n", depth);
+  }
+
+  err = pthread_create(&decoder, NULL, decode_stage, &p);
+  if(!err) {
+    set_affinity(decoder, ctx->opt.affinity[0], "decoder");
+    err = pthread_create(&processor, NULL, process_stage, &p);
+  }
+  if(err) {
+    fprintf(stderr, "%s: error: could not start pipeline thread: %s\n",
+                    PROG, strerror(err));
+    exit(99);
+  }
+  set_affinity(processor, ctx->opt.affinity[1], "processor");
+#ifdef __linux__
+  if(ctx->opt.affinity[2] >= 0) {
+    have_old_set = !pthread_getaffinity_np(pthread_self(), sizeof(old_set),
+                                           &old_set);
+  }
+#endif
+  set_affinity(pthread_self(), ctx->opt.affinity[2], "output");
+
+  /* output stage: print the result lines in stream order */
+  while((item = spsc_pop(&p.done))->ret > 0) {
+    if(item->ret > 1) {
+      /* a corrupt JPEG image is skipped */
+      fprintf(stderr, "%s: error: could not decode frame %lu\n", PROG,
+                      item->index);
+      printf("%lu\t\t99\n", item->index);
+    } else {
+      if(item->unchanged) unchanged++;
+      /* with --changes-only an unchanged frame prints nothing */
+      if(!item->unchanged || !(ctx->opt.flags & CHANGES_ONLY)) {
+        printf("%lu\t%s\t%d\n", item->index, item->text, item->status);
+      }
+      if(item->allocations) {
+        allocations += item->allocations;
+        last = item->index;
+      }
+    }
+    fflush(stdout);
+    spsc_push(&p.empty, item);
+  }
+  ret = item->ret;
+  if(ret < 0) {
+    fprintf(stderr, "%s: error: could not read frame %lu of stream %s\n",
+                    PROG, item->index, name);
+  }
+  if(ctx->opt.flags & VERBOSE) {
+    fprintf(stderr, "allocated %lu buffers and images, the last ones for frame"
+                    " %lu\n", allocations, last);
+    if(ctx->opt.flags & SKIP_UNCHANGED) {
+      fprintf(stderr, "%lu unchanged frames have not been recognized\n",
+                      unchanged);
+    }
+  }
+
+  pthread_join(decoder, NULL);
+  pthread_join(processor, NULL);
+#ifdef __linux__
+  if(have_old_set) {
+    pthread_setaffinity_np(pthread_self(), sizeof(old_set), &old_set);
+  }
+#endif
+  for(i = 0; i < depth; i++) {
+    free_frame(items[i].frame);
+    free(items[i].text);
+  }
+  free(items);
+  free(p.empty.items);
+  free(p.decoded.items);
+  free(p.done.items);
+
+  return (ret < 0) ? 99 : 0;
+}
@@ -0,0 +1,48 @@
+/* Seven Segment Optical Character Recognition Streaming Pipeline */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* The streaming pipeline processes the frames of one stream in three stages
+ * running on threads of their own: the decoder reads and decodes frames, the
+ * processor recognizes the digits, and the calling thread prints the result
+ * lines.  The stages are connected by bounded lock-free single producer
+ * single consumer queues carrying a fixed set of preallocated items, each
+ * with a frame buffer that is reused for every frame it carries.  Empty
+ * items return from the output stage to the decoder.  Thus decoding frame
+ * N+1 overlaps recognizing frame N and printing the result of frame N-1.
+ *
+ * Needs "frame.h" to be included before. */
+
+#ifndef SSOCR2_PIPELINE_H
+#define SSOCR2_PIPELINE_H
+
+/* decode the next frame of a stream into frame, reusing the memory of the
+ * frame, return 1 if a frame has been read, 2 if the frame could not be
+ * decoded (it is skipped), 0 at the end of the stream, or -1 on error */
+typedef int (*pipeline_decode_fn)(void *arg, frame_struct *frame);
+
+/* functions */
+
+/* process every frame returned by decode with the options and commands of
+ * ctx, using ctx->opt.queue_depth items and the CPUs in ctx->opt.affinity,
+ * print one line per frame with frame index, recognized digits, and exit code
+ * for the frame, the name is used for messages only,
+ * return the exit code for the stream */
+int run_pipeline(struct ssocr_ctx_s *ctx, const char *name,
+                 pipeline_decode_fn decode, void *arg);
+
+#endif /* SSOCR2_PIPELINE_H */
@@ -0,0 +1,186 @@
+/* Seven Segment Optical Character Recognition PNG Loading Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* FILE, fopen, fread, fclose, perror */
+#include <stdlib.h>         /* malloc, free, exit */
+#include <string.h>         /* memcpy */
+
+/* PNG decoding (includes setjmp.h) */
+#include <png.h>
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "pngload.h"        /* PNG loading */
+
+/* number of bytes of the PNG signature */
+#define PNG_SIG_BYTES 8
+
+/* functions */
+
+/* give up on errors without printing anything, Imlib2 shall try */
+static void png_quiet_error(png_structp png, png_const_charp msg)
+{
+  (void) msg;
+  png_longjmp(png, 1);
+}
+
+/* ignore warnings, like Imlib2 does */
+static void png_quiet_warning(png_structp png, png_const_charp msg)
+{
+  (void) png;
+  (void) msg;
+}
+
+/* decode a non-interlaced PNG file row by row into a frame, keeping palette
+ * images as palette indices, if roi is not NULL, only the crop area roi
+ * (x, y, w, h as given to the crop command) is stored and decoding stops
+ * after its last row, *partial is set if this has been done (the frame must
+ * be cropped to roi before using it then), return NULL if the file is not
+ * supported (Imlib2 shall try) */
+frame_struct *png_load_file(const char *filename, const int *roi,
+                            int *partial)
+{
+  FILE *f;
+  unsigned char sig[PNG_SIG_BYTES];
+  png_structp png;
+  png_infop info;
+  png_uint_32 width, height;
+  int bit_depth, color_type, interlace, channels;
+  int x, y, w, h, r;
+  size_t stride;
+  frame_struct *frame;
+  unsigned char * volatile row = NULL; /* one row of the whole image */
+
+  *partial = 0;
+  if(!(f = fopen(filename, "rb"))) return NULL;
+  if(fread(sig, 1, PNG_SIG_BYTES, f) != PNG_SIG_BYTES ||
+     png_sig_cmp(sig, 0, PNG_SIG_BYTES) != 0) {
+    fclose(f);
+    return NULL;
+  }
+  if(!(png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL,
+                                    png_quiet_error, png_quiet_warning))) {
+    fclose(f);
+    return NULL;
+  }
+  if(!(info = png_create_info_struct(png))) {
+    png_destroy_read_struct(&png, NULL, NULL);
+    fclose(f);
+    return NULL;
+  }
+  frame = new_frame();
+  if(setjmp(png_jmpbuf(png))) {
+    png_destroy_read_struct(&png, &info, NULL);
+    free(row);
+    free_frame(frame);
+    fclose(f);
+    return NULL;
+  }
+  png_init_io(png, f);
+  png_set_sig_bytes(png, PNG_SIG_BYTES);
+  png_read_info(png, info);
+  png_get_IHDR(png, info, &width, &height, &bit_depth, &color_type,
+               &interlace, NULL, NULL);
+  /* rows of interlaced images are complete only after the last pass */
+  if(interlace != PNG_INTERLACE_NONE) png_longjmp(png, 1);
+
+  /* decode to 8 bit gray, RGB, or palette indices, like Imlib2 ignoring the
+   * alpha channel (and transparency of palette entries) */
+  if(bit_depth == 16) png_set_strip_16(png);
+  if(color_type == PNG_COLOR_TYPE_PALETTE && bit_depth < 8)
+    png_set_packing(png);
+  if(color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+    png_set_expand_gray_1_2_4_to_8(png);
+  if(color_type & PNG_COLOR_MASK_ALPHA) png_set_strip_alpha(png);
+  png_read_update_info(png, info);
+  channels = png_get_channels(png, info);
+  if(channels != 1 && channels != 3) png_longjmp(png, 1);
+  if(color_type == PNG_COLOR_TYPE_PALETTE) {
+    png_colorp palette;
+    int i, n;
+    if(!png_get_PLTE(png, info, &palette, &n)) png_longjmp(png, 1);
+    /* unused entries stay black */
+    for(i = 0; i < n && i <= MAXRGB; i++) {
+      frame->palette[i][0] = palette[i].red;
+      frame->palette[i][1] = palette[i].green;
+      frame->palette[i][2] = palette[i].blue;
+    }
+  }
+
+  /* decode only rows up to the last one needed and store only the crop area */
+  x = y = 0;
+  w = width;
+  h = height;
+  if(roi) {
+    x = roi[0];
+    y = roi[1];
+    w = roi[2];
+    h = roi[3];
+    if(crop_rect(width, height, &x, &y, &w, &h) < 0) {
+      x = y = 0;
+      w = width;
+      h = height;
+    } else {
+      *partial = 1;
+    }
+  }
+  stride = (size_t)w * channels;
+  frame->buf_size = stride * h;
+  if(!(frame->buf = malloc(frame->buf_size))) {
+    perror(PROG ": frame->buf = malloc()");
+    exit(99);
+  }
+  if(w < (int)width && !(row = malloc((size_t)width * channels))) {
+    perror(PROG ": row = malloc()");
+    exit(99);
+  }
+  for(r = 0; r < y + h; r++) {
+    if(!row) {
+      /* whole rows are stored, rows above the crop area are overwritten */
+      png_read_row(png, frame->buf + (size_t)(r < y ? 0 : r - y) * stride,
+                   NULL);
+    } else {
+      png_read_row(png, row, NULL);
+      if(r >= y) {
+        memcpy(frame->buf + (size_t)(r - y) * stride, row + (size_t)x * channels,
+               stride);
+      }
+    }
+  }
+  /* the rest of the image is not decoded at all */
+  png_destroy_read_struct(&png, &info, NULL);
+  free(row);
+  fclose(f);
+
+  frame->fmt = (color_type == PNG_COLOR_TYPE_PALETTE) ? FRAME_PAL8 :
+               (channels == 1) ? FRAME_GRAY8 : FRAME_RGB24;
+  frame->data = frame->buf;
+  frame->stride = stride;
+  frame->w = width;
+  frame->h = height;
+  frame->x0 = -x;
+  frame->y0 = -y;
+  frame->partial = *partial;
+  return frame;
+}
@@ -0,0 +1,33 @@
+/* Seven Segment Optical Character Recognition PNG Loading Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_PNGLOAD_H
+#define SSOCR2_PNGLOAD_H
+
+/* functions */
+
+/* decode a non-interlaced PNG file row by row into a frame, keeping palette
+ * images as palette indices, if roi is not NULL, only the crop area roi
+ * (x, y, w, h as given to the crop command) is stored and decoding stops
+ * after its last row, *partial is set if this has been done (the frame must
+ * be cropped to roi before using it then), return NULL if the file is not
+ * supported (Imlib2 shall try) */
+frame_struct *png_load_file(const char *filename, const int *roi,
+                            int *partial);
+
+#endif /* SSOCR2_PNGLOAD_H */
@@ -0,0 +1,275 @@
+/* Seven Segment Optical Character Recognition PNM Loading Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* FILE, getc, fread, perror */
+#include <stdlib.h>         /* realloc, exit */
+
+/* memory mapping */
+#include <sys/types.h>      /* off_t */
+#include <sys/stat.h>       /* fstat */
+#include <sys/mman.h>       /* mmap, munmap */
+#include <fcntl.h>          /* open */
+#include <unistd.h>         /* close */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "pnm.h"            /* PNM loading */
+
+/* limit for image dimensions to rule out overflows */
+#define PNM_MAX_DIM 65535
+
+/* limit for the header (including comments) of an image read from a stream */
+#define PNM_MAX_HEADER 4096
+
+/* functions */
+
+/* is c a white space character as defined by the netpbm formats? */
+static int pnm_space(int c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
+}
+
+/* skip white space and comments, then parse an unsigned decimal number,
+ * return -1 on error */
+static long pnm_number(const unsigned char *p, size_t size, size_t *pos)
+{
+  long n = 0;
+  int digits = 0;
+
+  while(*pos < size) {
+    if(pnm_space(p[*pos])) {
+      (*pos)++;
+    } else if(p[*pos] == '#') {
+      while(*pos < size && p[*pos] != '\n' && p[*pos] != '\r') (*pos)++;
+    } else {
+      break;
+    }
+  }
+  while(*pos < size && p[*pos] >= '0' && p[*pos] <= '9') {
+    n = 10 * n + (p[*pos] - '0');
+    if(n > PNM_MAX_DIM) return -1;
+    (*pos)++;
+    digits++;
+  }
+  return digits ? n : -1;
+}
+
+/* parse the header of a binary PNM image, set the format, dimensions, and
+ * row stride, and the offset of the pixel data in pos, return 1 on success,
+ * 0 if the header is incomplete, or -1 if the image is not supported */
+static int pnm_header(const unsigned char *p, size_t size, frame_fmt_t *fmt,
+                      long *w, long *h, size_t *stride, size_t *pos)
+{
+  long maxval = MAXRGB;
+
+  if(size < 2) return (size == 0 || p[0] == 'P') ? 0 : -1;
+  if(p[0] != 'P') return -1;
+  switch(p[1]) {
+    case '4': *fmt = FRAME_MONO1; break;
+    case '5': *fmt = FRAME_GRAY8; break;
+    case '6': *fmt = FRAME_RGB24; break;
+    default: return -1; /* ASCII variants are left to Imlib2 */
+  }
+  *pos = 2;
+  /* a number at the end of the data may continue in data not yet read */
+  if((*w = pnm_number(p, size, pos)) <= 0 || *pos >= size) {
+    return (*pos >= size) ? 0 : -1;
+  }
+  if((*h = pnm_number(p, size, pos)) <= 0 || *pos >= size) {
+    return (*pos >= size) ? 0 : -1;
+  }
+  if(*fmt != FRAME_MONO1) {
+    maxval = pnm_number(p, size, pos);
+    if(*pos >= size) return 0;
+  }
+  /* only 8 bit samples can be used directly */
+  if(maxval != MAXRGB) return -1;
+  /* exactly one white space character separates header and pixel data */
+  if(!pnm_space(p[*pos])) return -1;
+  (*pos)++;
+  switch(*fmt) {
+    case FRAME_MONO1: *stride = (*w + 7) / 8; break;
+    case FRAME_GRAY8: *stride = *w; break;
+    default: *stride = 3 * *w; break;
+  }
+  return 1;
+}
+
+/* parse the header of a binary PNM image and fill in a new frame,
+ * return NULL if the image is not supported */
+static frame_struct *pnm_parse(const unsigned char *p, size_t size)
+{
+  frame_struct *frame;
+  frame_fmt_t fmt;
+  size_t pos, stride;
+  long w, h;
+
+  if(pnm_header(p, size, &fmt, &w, &h, &stride, &pos) != 1) return NULL;
+  if(size - pos < stride * h) return NULL;
+
+  frame = new_frame();
+  frame->fmt = fmt;
+  frame->w = w;
+  frame->h = h;
+  frame->stride = stride;
+  frame->data = p + pos;
+  return frame;
+}
+
+/* find the binary PBM, PGM, or PPM image at the start of data read from a
+ * stream, white space before the image is skipped and its length stored in
+ * start, return the length of the image including its header, 0 if more data
+ * is needed, or -1 if the data is not a supported image */
+long pnm_frame_length(const unsigned char *p, size_t size, size_t *start)
+{
+  frame_fmt_t fmt;
+  size_t pos, stride;
+  long w, h;
+  int ret;
+
+  for(*start = 0; *start < size && pnm_space(p[*start]); (*start)++);
+  ret = pnm_header(p + *start, size - *start, &fmt, &w, &h, &stride, &pos);
+  if(ret < 0) return -1;
+  /* comments are allowed, but an endless header is not an image */
+  if(ret == 0) return (size - *start > PNM_MAX_HEADER) ? -1 : 0;
+  if(size - *start - pos < stride * h) return 0;
+  return pos + stride * h;
+}
+
+/* memory map a binary PBM, PGM, or PPM file and return a frame viewing its
+ * pixel data, return NULL if the file is not supported (Imlib2 shall try) */
+frame_struct *pnm_load_file(const char *filename)
+{
+  frame_struct *frame;
+  struct stat st;
+  void *map;
+  int fd;
+
+  if((fd = open(filename, O_RDONLY)) < 0) return NULL;
+  if(fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size < 3) {
+    close(fd);
+    return NULL;
+  }
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) return NULL;
+  if(!(frame = pnm_parse(map, st.st_size))) {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+  frame->map = map;
+  frame->map_len = st.st_size;
+  return frame;
+}
+
+/* return a frame viewing the pixel data of a binary PBM, PGM, or PPM image in
+ * memory, the frame takes ownership of buf (allocated by malloc) on success,
+ * return NULL if the image is not supported (buf is not changed then) */
+frame_struct *pnm_load_buffer(unsigned char *buf, size_t size)
+{
+  frame_struct *frame;
+
+  if(!(frame = pnm_parse(buf, size))) return NULL;
+  frame->buf = buf;
+  frame->buf_size = size;
+  return frame;
+}
+
+/* skip white space and comments in a stream, then read an unsigned decimal
+ * number, the single character following the number is consumed as well,
+ * return -1 on error */
+static long pnm_read_number(FILE *stream)
+{
+  long n = 0;
+  int c, digits = 0;
+
+  while((c = getc(stream)) != EOF) {
+    if(c == '#') {
+      while((c = getc(stream)) != EOF && c != '\n' && c != '\r');
+    } else if(!pnm_space(c)) {
+      break;
+    }
+  }
+  for(; c >= '0' && c <= '9'; c = getc(stream)) {
+    n = 10 * n + (c - '0');
+    if(n > PNM_MAX_DIM) return -1;
+    digits++;
+  }
+  /* exactly one white space character ends the number */
+  if(!digits || !pnm_space(c)) return -1;
+  return n;
+}
+
+/* read the next binary PBM, PGM, or PPM image of a stream into frame,
+ * reusing the memory of the frame, return 1 if a frame has been read,
+ * 0 at the end of the stream, or -1 on error */
+int pnm_read_frame(FILE *stream, frame_struct *frame)
+{
+  frame_fmt_t fmt;
+  long w, h, maxval = MAXRGB;
+  size_t stride, size;
+  int c;
+
+  /* ignore white space between frames */
+  while((c = getc(stream)) != EOF && pnm_space(c));
+  if(c == EOF) return 0;
+  if(c != 'P') return -1;
+  switch(getc(stream)) {
+    case '4': fmt = FRAME_MONO1; break;
+    case '5': fmt = FRAME_GRAY8; break;
+    case '6': fmt = FRAME_RGB24; break;
+    default: return -1;
+  }
+  if((w = pnm_read_number(stream)) <= 0) return -1;
+  if((h = pnm_read_number(stream)) <= 0) return -1;
+  if(fmt != FRAME_MONO1) {
+    maxval = pnm_read_number(stream);
+  }
+  if(maxval != MAXRGB) return -1;
+  switch(fmt) {
+    case FRAME_MONO1: stride = (w + 7) / 8; break;
+    case FRAME_GRAY8: stride = w; break;
+    default: stride = 3 * w; break;
+  }
+  size = stride * h;
+  if(size > frame->buf_size) {
+    unsigned char *buf;
+    if(!(buf = realloc(frame->buf, size))) {
+      perror(PROG ": frame->buf = realloc()");
+      exit(99);
+    }
+    frame->buf = buf;
+    frame->buf_size = size;
+  }
+  if(fread(frame->buf, 1, size, stream) != size) return -1;
+
+  frame->fmt = fmt;
+  frame->w = w;
+  frame->h = h;
+  frame->x0 = frame->y0 = 0;
+  frame->stride = stride;
+  frame->data = frame->buf;
+  return 1;
+}
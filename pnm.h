@@ -0,0 +1,44 @@
+/* Seven Segment Optical Character Recognition PNM Loading Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_PNM_H
+#define SSOCR2_PNM_H
+
+/* functions */
+
+/* memory map a binary PBM, PGM, or PPM file and return a frame viewing its
+ * pixel data, return NULL if the file is not supported (Imlib2 shall try) */
+frame_struct *pnm_load_file(const char *filename);
+
+/* return a frame viewing the pixel data of a binary PBM, PGM, or PPM image in
+ * memory, the frame takes ownership of buf (allocated by malloc) on success,
+ * return NULL if the image is not supported (buf is not changed then) */
+frame_struct *pnm_load_buffer(unsigned char *buf, size_t size);
+
+/* find the binary PBM, PGM, or PPM image at the start of data read from a
+ * stream, white space before the image is skipped and its length stored in
+ * start, return the length of the image including its header, 0 if more data
+ * is needed, or -1 if the data is not a supported image */
+long pnm_frame_length(const unsigned char *p, size_t size, size_t *start);
+
+/* read the next binary PBM, PGM, or PPM image of a stream into frame,
+ * reusing the memory of the frame, return 1 if a frame has been read,
+ * 0 at the end of the stream, or -1 on error */
+int pnm_read_frame(FILE *stream, frame_struct *frame);
+
+#endif /* SSOCR2_PNM_H */
@@ -0,0 +1,242 @@
+/* Seven Segment Optical Character Recognition Worker Pool */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* standard things */
+#include <stdio.h>          /* fputs, fflush, perror, fprintf */
+#include <stdlib.h>         /* calloc, free, exit */
+#include <string.h>         /* strerror */
+
+/* threads */
+#include <pthread.h>        /* pthread_create, pthread_join, pthread_mutex_* */
+
+/* my headers */
+#include "defines.h"        /* PROG */
+#include "pool.h"           /* worker pool */
+
+/* functions */
+
+/* print the result of a finished task and free it */
+static void print_task(pool_task_struct *task)
+{
+  if(task->result) fputs(task->result, stdout);
+  fflush(stdout);
+  free(task->result);
+  free(task->name);
+  free(task);
+}
+
+/* take the oldest task from the worker's own deque or, if that is empty,
+ * steal the newest task from the deque of another worker,
+ * return NULL if all deques are empty */
+static pool_task_struct *take_task(pool_struct *pool, int id)
+{
+  pool_task_struct *task = NULL;
+  pool_deque_struct *dq;
+  int i, k;
+
+  for(i = 0; i < pool->nthreads && !task; i++) {
+    k = (id + i) % pool->nthreads;
+    dq = pool->deques + k;
+    pthread_mutex_lock(&dq->lock);
+    if(dq->count > 0) {
+      if(k == id) {
+        task = dq->tasks[dq->head];
+        dq->head = (dq->head + 1) % pool->window;
+      } else {
+        task = dq->tasks[(dq->head + dq->count - 1) % pool->window];
+      }
+      dq->count--;
+    }
+    pthread_mutex_unlock(&dq->lock);
+  }
+  return task;
+}
+
+/* mark a task as finished and print all results that are due */
+static void finish_task(pool_struct *pool, pool_task_struct *task)
+{
+  pool_task_struct **slot;
+
+  pthread_mutex_lock(&pool->lock);
+  task->done = 1;
+  if(!pool->ordered) {
+    pool->slots[task->seq % pool->window] = NULL;
+    print_task(task);
+    pool->inflight--;
+  } else {
+    /* print results in input order, the first unprinted task may still be
+     * unfinished even though later ones are finished already */
+    slot = pool->slots + pool->next_print % pool->window;
+    while(*slot && (*slot)->done) {
+      print_task(*slot);
+      *slot = NULL;
+      pool->next_print++;
+      pool->inflight--;
+      slot = pool->slots + pool->next_print % pool->window;
+    }
+  }
+  pthread_cond_broadcast(&pool->done_cond);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+/* worker thread: process tasks until the pool is closed and empty */
+static void *pool_worker(void *arg)
+{
+  pool_worker_struct *worker = arg;
+  pool_struct *pool = worker->pool;
+  pool_task_struct *task;
+
+  while(1) {
+    pthread_mutex_lock(&pool->lock);
+    while(!pool->queued && !pool->closing) {
+      pthread_cond_wait(&pool->work_cond, &pool->lock);
+    }
+    if(!pool->queued) {
+      pthread_mutex_unlock(&pool->lock);
+      break;
+    }
+    /* a task is reserved, it has been pushed before queued was increased */
+    pool->queued--;
+    pthread_mutex_unlock(&pool->lock);
+    /* another worker may take the task just found, retry then */
+    do {
+      task = take_task(pool, worker->id);
+    } while(!task);
+    pool->work(task, pool->arg, worker->id);
+    finish_task(pool, task);
+  }
+  return NULL;
+}
+
+/* start nthreads worker threads calling work(task, arg, worker) for every
+ * task, at most window tasks are unfinished or wait to be printed in input
+ * order (unless ordered is 0, then results are printed as soon as available) */
+pool_struct *new_pool(int nthreads, int window, int ordered,
+                      pool_work_fn work, const void *arg)
+{
+  pool_struct *pool;
+  int i, err;
+
+  if(!(pool = calloc(1, sizeof(pool_struct)))) {
+    perror(PROG ": pool = calloc()");
+    exit(99);
+  }
+  pool->nthreads = nthreads;
+  pool->window = window;
+  pool->ordered = ordered;
+  pool->work = work;
+  pool->arg = arg;
+  if(!(pool->threads = calloc(nthreads, sizeof(pthread_t))) ||
+     !(pool->workers = calloc(nthreads, sizeof(pool_worker_struct))) ||
+     !(pool->deques = calloc(nthreads, sizeof(pool_deque_struct))) ||
+     !(pool->slots = calloc(window, sizeof(pool_task_struct *)))) {
+    perror(PROG ": pool = calloc()");
+    exit(99);
+  }
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work_cond, NULL);
+  pthread_cond_init(&pool->done_cond, NULL);
+  for(i = 0; i < nthreads; i++) {
+    pthread_mutex_init(&pool->deques[i].lock, NULL);
+    /* every deque can hold all tasks of the window */
+    pool->deques[i].tasks = calloc(window, sizeof(pool_task_struct *));
+    if(!pool->deques[i].tasks) {
+      perror(PROG ": deque = calloc()");
+      exit(99);
+    }
+  }
+  for(i = 0; i < nthreads; i++) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].id = i;
+    err = pthread_create(pool->threads + i, NULL, pool_worker,
+                         pool->workers + i);
+    if(err) {
+      fprintf(stderr, "%s: error: could not start worker thread: %s\n", PROG,
+                      strerror(err));
+      exit(99);
+    }
+  }
+  return pool;
+}
+
+/* add a task processing the named image (or data), the pool takes ownership
+ * of name, wait while window tasks are unfinished or unprinted */
+void pool_submit(pool_struct *pool, char *name, void *data)
+{
+  pool_task_struct *task;
+  pool_deque_struct *dq;
+
+  if(!(task = calloc(1, sizeof(pool_task_struct)))) {
+    perror(PROG ": task = calloc()");
+    exit(99);
+  }
+  task->name = name;
+  task->data = data;
+
+  pthread_mutex_lock(&pool->lock);
+  while(pool->inflight >= pool->window) {
+    pthread_cond_wait(&pool->done_cond, &pool->lock);
+  }
+  task->seq = pool->next_seq++;
+  pool->slots[task->seq % pool->window] = task;
+  pool->inflight++;
+  pthread_mutex_unlock(&pool->lock);
+
+  /* distribute tasks round-robin, idle workers steal from busy ones */
+  dq = pool->deques + task->seq % pool->nthreads;
+  pthread_mutex_lock(&dq->lock);
+  dq->tasks[(dq->head + dq->count) % pool->window] = task;
+  dq->count++;
+  pthread_mutex_unlock(&dq->lock);
+
+  pthread_mutex_lock(&pool->lock);
+  pool->queued++;
+  pthread_cond_signal(&pool->work_cond);
+  pthread_mutex_unlock(&pool->lock);
+}
+
+/* wait until all tasks have been processed and printed, stop the worker
+ * threads, and free the pool */
+void free_pool(pool_struct *pool)
+{
+  int i;
+
+  if(!pool) return;
+  pthread_mutex_lock(&pool->lock);
+  while(pool->inflight > 0) {
+    pthread_cond_wait(&pool->done_cond, &pool->lock);
+  }
+  pool->closing = 1;
+  pthread_cond_broadcast(&pool->work_cond);
+  pthread_mutex_unlock(&pool->lock);
+  for(i = 0; i < pool->nthreads; i++) {
+    pthread_join(pool->threads[i], NULL);
+  }
+  for(i = 0; i < pool->nthreads; i++) {
+    pthread_mutex_destroy(&pool->deques[i].lock);
+    free(pool->deques[i].tasks);
+  }
+  pthread_cond_destroy(&pool->done_cond);
+  pthread_cond_destroy(&pool->work_cond);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->slots);
+  free(pool->deques);
+  free(pool->workers);
+  free(pool->threads);
+  free(pool);
+}
@@ -0,0 +1,90 @@
+/* Seven Segment Optical Character Recognition Worker Pool */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_POOL_H
+#define SSOCR2_POOL_H
+
+#include <pthread.h>        /* pthread_t, pthread_mutex_t, pthread_cond_t */
+
+/* an image of a batch processed by a worker thread */
+typedef struct {
+  unsigned long int seq;    /* position of the image in the batch */
+  char *name;               /* file name of the image */
+  void *data;               /* data of the submitter for the worker */
+  char *result;             /* output line for the image, set by the worker */
+  int done;                 /* has the worker finished the image? */
+} pool_task_struct;
+
+/* function processing one task, called by the worker threads with the index
+ * of the calling worker */
+typedef void (*pool_work_fn)(pool_task_struct *task, const void *arg,
+                             int worker);
+
+/* tasks of one worker, taken from the head by the worker itself and stolen
+ * from the tail by other workers */
+typedef struct {
+  pthread_mutex_t lock;     /* protects the deque */
+  pool_task_struct **tasks; /* ring buffer of tasks */
+  int head;                 /* index of the oldest task */
+  int count;                /* number of tasks in the deque */
+} pool_deque_struct;
+
+/* a worker thread and its deque */
+typedef struct {
+  struct pool_s *pool;      /* pool the worker belongs to */
+  int id;                   /* index of the worker's deque */
+} pool_worker_struct;
+
+/* worker threads processing the images of a batch */
+typedef struct pool_s {
+  int nthreads;             /* number of worker threads */
+  int window;               /* maximum number of unfinished or unprinted tasks */
+  int ordered;              /* print results in input order? */
+  pool_work_fn work;        /* function processing a task */
+  const void *arg;          /* argument of the work function */
+  pthread_t *threads;       /* worker threads */
+  pool_worker_struct *workers; /* per-thread data */
+  pool_deque_struct *deques; /* one deque of tasks per worker */
+  pool_task_struct **slots; /* reorder buffer, task seq is at seq % window */
+  pthread_mutex_t lock;     /* protects the following members */
+  pthread_cond_t work_cond; /* signaled when a task has been queued */
+  pthread_cond_t done_cond; /* signaled when a task has been printed */
+  int queued;               /* tasks queued, but not yet taken by a worker */
+  int inflight;             /* tasks submitted, but not yet printed */
+  int closing;              /* no more tasks will be submitted */
+  unsigned long int next_seq; /* sequence number of the next task */
+  unsigned long int next_print; /* sequence number of next task to print */
+} pool_struct;
+
+/* functions */
+
+/* start nthreads worker threads calling work(task, arg, worker) for every
+ * task, at most window tasks are unfinished or wait to be printed in input
+ * order (unless ordered is 0, then results are printed as soon as available) */
+pool_struct *new_pool(int nthreads, int window, int ordered,
+                      pool_work_fn work, const void *arg);
+
+/* add a task processing the named image (or data), the pool takes ownership
+ * of name, wait while window tasks are unfinished or unprinted */
+void pool_submit(pool_struct *pool, char *name, void *data);
+
+/* wait until all tasks have been processed and printed, stop the worker
+ * threads, and free the pool */
+void free_pool(pool_struct *pool);
+
+#endif /* SSOCR2_POOL_H */
@@ -0,0 +1,564 @@
+/* Seven Segment Optical Character Recognition Run-Length Encoding Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* FILE, fopen, fprintf, perror */
+#include <stdlib.h>         /* calloc, free, exit */
+
+/* string manipulation */
+#include <string.h>         /* strcmp, memset */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "imgproc.h"        /* get_lum, is_pixel_set, clip */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+#include "rle.h"            /* run-length encoding */
+#include "bufpool.h"        /* buffer pool */
+
+/* global variables */
+extern _Thread_local int ssocr_foreground;
+extern _Thread_local int ssocr_background;
+
+/* functions */
+
+/* make rle an empty run-length encoded image, reusing its memory */
+static void empty_rle(rle_struct *rle, int w, int h)
+{
+  rle->w = w;
+  rle->h = h;
+  rle->row = buf_zero(&rle->row_buf, h + 1, sizeof(int));
+  rle->runs = rle->runs_buf.mem;
+  rle->nruns = 0;
+  rle->size = rle->runs_buf.size / sizeof(run_struct);
+}
+
+/* append run x1 -> x2 to the row currently being constructed */
+static void add_run(rle_struct *rle, int x1, int x2)
+{
+  if(rle->nruns >= rle->size) {
+    rle->runs = buf_reserve(&rle->runs_buf, rle->size ? 2 * rle->size : 64,
+                            sizeof(run_struct));
+    rle->size = rle->runs_buf.size / sizeof(run_struct);
+  }
+  rle->runs[rle->nruns].x1 = x1;
+  rle->runs[rle->nruns].x2 = x2;
+  rle->nruns++;
+}
+
+/* run-length encode a thresholded image */
+rle_struct *new_rle(bitmap_struct *bitmap)
+{
+  rle_struct *rle;
+
+  if(!(rle = calloc(1, sizeof(rle_struct)))) {
+    perror(PROG ": rle = calloc()");
+    exit(99);
+  }
+  encode_rle(rle, bitmap);
+  return rle;
+}
+
+/* run-length encode a thresholded image into rle like new_rle(), reusing its
+ * memory, rle must be zeroed before its first use */
+void encode_rle(rle_struct *rle, bitmap_struct *bitmap)
+{
+  int x, y, bx, n;
+  int start; /* start of current run, -1 if outside of a run */
+
+  empty_rle(rle, bitmap->w, bitmap->h);
+  for(y = 0; y < bitmap->h; y++) {
+    rle->row[y] = rle->nruns;
+    start = -1;
+    for(bx = 0; bx < bitmap->bw; bx++) {
+      const unsigned char *bits = bitmap_block_row(bitmap, bx, y);
+      x = bx * BITMAP_BLOCK;
+      n = (bitmap->w - x < BITMAP_BLOCK) ? bitmap->w - x : BITMAP_BLOCK;
+      for(; n > 0; n--, x++, bits++) {
+        if(*bits && start < 0) {
+          start = x;
+        } else if(!*bits && start >= 0) {
+          add_run(rle, start, x - 1);
+          start = -1;
+        }
+      }
+    }
+    if(start >= 0) {
+      add_run(rle, start, bitmap->w - 1);
+    }
+  }
+  rle->row[bitmap->h] = rle->nruns;
+}
+
+/* free the memory of a run-length encoded image, but not the image itself */
+void clear_rle(rle_struct *rle)
+{
+  free_buf(&rle->row_buf);
+  free_buf(&rle->runs_buf);
+  rle->row = NULL;
+  rle->runs = NULL;
+  rle->nruns = rle->size = 0;
+}
+
+/* free a run-length encoded image */
+void free_rle(rle_struct *rle)
+{
+  if(!rle) return;
+  clear_rle(rle);
+  free(rle);
+}
+
+/* return 1 if the pixel at (x,y) is set, 0 otherwise */
+int rle_pixel(rle_struct *rle, int x, int y)
+{
+  int lo, hi, mid;
+
+  if(x < 0 || y < 0 || x >= rle->w || y >= rle->h) {
+    return 0;
+  }
+  /* binary search for the last run starting at or left of x */
+  lo = rle->row[y];
+  hi = rle->row[y+1] - 1;
+  while(lo <= hi) {
+    mid = (lo + hi) / 2;
+    if(rle->runs[mid].x1 > x) {
+      hi = mid - 1;
+    } else if(rle->runs[mid].x2 < x) {
+      lo = mid + 1;
+    } else {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* store the number of set pixels of columns x0 to x1-1 in cols (x1-x0
+ * entries), only the runs of every row touching these columns are examined,
+ * diff (x1-x0+1 entries) gets +1 at the start and -1 after the end of every
+ * run */
+void rle_col_profile_range(rle_struct *rle, int x0, int x1, int *cols,
+                           int *diff)
+{
+  int y, i, lo, hi, mid, sum;
+
+  if(x1 <= x0) return;
+  memset(diff, 0, (x1 - x0 + 1) * sizeof(int));
+  for(y = 0; y < rle->h; y++) {
+    /* find the first run of the row ending at or right of x0 */
+    lo = rle->row[y];
+    hi = rle->row[y+1];
+    while(lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      if(rle->runs[mid].x2 < x0) lo = mid + 1; else hi = mid;
+    }
+    for(i = lo; i < rle->row[y+1] && rle->runs[i].x1 < x1; i++) {
+      diff[(rle->runs[i].x1 > x0) ? rle->runs[i].x1 - x0 : 0]++;
+      diff[(rle->runs[i].x2 < x1) ? rle->runs[i].x2 + 1 - x0 : x1 - x0]--;
+    }
+  }
+  for(i = 0, sum = 0; i < x1 - x0; i++) {
+    sum += diff[i];
+    cols[i] = sum;
+  }
+}
+
+/* add the union of the runs of rows y-1, y, and y+1 of src, each widened by
+ * one pixel to the left and right, as next row to dst */
+static void dilate_row(rle_struct *src, rle_struct *dst, int y)
+{
+  int pos[3], end[3]; /* next and end run index in each source row */
+  int i, best, x1, x2, have_run = 0, cur1 = 0, cur2 = 0;
+
+  for(i = 0; i < 3; i++) {
+    int r = clip(y - 1 + i, 0, src->h - 1);
+    if(y - 1 + i == r) {
+      pos[i] = src->row[r];
+      end[i] = src->row[r+1];
+    } else {
+      pos[i] = end[i] = 0;
+    }
+  }
+  /* merge the three sorted rows, joining overlapping or touching runs */
+  while(1) {
+    best = -1;
+    for(i = 0; i < 3; i++) {
+      if(pos[i] < end[i] && (best < 0 ||
+         src->runs[pos[i]].x1 < src->runs[pos[best]].x1)) {
+        best = i;
+      }
+    }
+    if(best < 0) break;
+    x1 = (src->runs[pos[best]].x1 > 0) ? src->runs[pos[best]].x1 - 1 : 0;
+    x2 = (src->runs[pos[best]].x2 < src->w - 1) ? src->runs[pos[best]].x2 + 1
+                                                : src->w - 1;
+    pos[best]++;
+    if(have_run && x1 <= cur2 + 1) {
+      if(x2 > cur2) cur2 = x2;
+    } else {
+      if(have_run) add_run(dst, cur1, cur2);
+      cur1 = x1;
+      cur2 = x2;
+      have_run = 1;
+    }
+  }
+  if(have_run) add_run(dst, cur1, cur2);
+}
+
+/* add the intersection of the runs of rows y-1, y, and y+1 of src, each
+ * narrowed by one pixel at the left and right, as next row to dst */
+static void erode_row(rle_struct *src, rle_struct *dst, int y)
+{
+  int pos[3], end[3]; /* next and end run index in each source row */
+  int i, x1, x2;
+
+  /* pixels at the image border do not have 9 neighbors inside the image */
+  if(y < 1 || y > src->h - 2) return;
+  for(i = 0; i < 3; i++) {
+    pos[i] = src->row[y - 1 + i];
+    end[i] = src->row[y + i];
+  }
+  while(pos[0] < end[0] && pos[1] < end[1] && pos[2] < end[2]) {
+    /* intersection of the current run of every row */
+    x1 = src->runs[pos[0]].x1;
+    x2 = src->runs[pos[0]].x2;
+    for(i = 1; i < 3; i++) {
+      if(src->runs[pos[i]].x1 > x1) x1 = src->runs[pos[i]].x1;
+      if(src->runs[pos[i]].x2 < x2) x2 = src->runs[pos[i]].x2;
+    }
+    if(x1 + 1 <= x2 - 1) {
+      add_run(dst, x1 + 1, x2 - 1);
+    }
+    /* advance the run ending first, it cannot intersect anything else */
+    for(i = 0; i < 3; i++) {
+      if(src->runs[pos[i]].x2 == x2) {
+        pos[i]++;
+        break;
+      }
+    }
+  }
+}
+
+/* filter rle into dst with a 3x3 neighborhood like set_pixels_filter(),
+ * mask 1 is dilation, mask 9 is erosion, no other masks are supported */
+void rle_filter(rle_struct *rle, rle_struct *dst, int mask)
+{
+  int y;
+
+  if(mask != 1 && mask != 9) {
+    fprintf(stderr, "%s: error: rle_filter(): unsupported mask %d\n", PROG,
+            mask);
+    exit(99);
+  }
+  empty_rle(dst, rle->w, rle->h);
+  for(y = 0; y < rle->h; y++) {
+    dst->row[y] = dst->nruns;
+    if(mask == 1) {
+      dilate_row(rle, dst, y);
+    } else {
+      erode_row(rle, dst, y);
+    }
+  }
+  dst->row[rle->h] = dst->nruns;
+}
+
+/* store the pixels that are set when an image drawn from rle in foreground
+ * and background color is thresholded again in dst */
+static void rethreshold(rle_struct *rle, rle_struct *dst, int fg_set,
+                        int bg_set)
+{
+  int y, i, x;
+
+  empty_rle(dst, rle->w, rle->h);
+  for(y = 0; y < rle->h; y++) {
+    dst->row[y] = dst->nruns;
+    if(fg_set && bg_set) {
+      add_run(dst, 0, rle->w - 1);
+    } else if(fg_set) {
+      for(i = rle->row[y]; i < rle->row[y+1]; i++) {
+        add_run(dst, rle->runs[i].x1, rle->runs[i].x2);
+      }
+    } else if(bg_set) {
+      /* complement of the runs */
+      x = 0;
+      for(i = rle->row[y]; i < rle->row[y+1]; i++) {
+        if(rle->runs[i].x1 > x) add_run(dst, x, rle->runs[i].x1 - 1);
+        x = rle->runs[i].x2 + 1;
+      }
+      if(x < rle->w) add_run(dst, x, rle->w - 1);
+    }
+  }
+  dst->row[rle->h] = dst->nruns;
+}
+
+/* return 1 if a pixel of gray value v is set at the given threshold */
+static int gray_is_set(int v, double thresh, luminance_t lt)
+{
+  Imlib_Color color;
+
+  color.red = color.green = color.blue = v;
+  color.alpha = 255;
+  return is_pixel_set(get_lum(&color, lt), thresh);
+}
+
+/* apply dilation (mask 1) or erosion (mask 9) iter times to an image,
+ * the result is identical to set_pixels_filter_iter() */
+Imlib_Image rle_filter_image(Imlib_Image *source_image, double thresh,
+                             luminance_t lt, int mask, int iter)
+{
+  Imlib_Image new_image; /* construct filtered image here */
+  Imlib_Image current_image; /* save image pointer */
+  buf_pool_struct *pool = get_buf_pool();
+  rle_struct *rle, *tmp, *swap; /* the runs of the pool used alternately */
+  int fg_set, bg_set; /* are drawn fore- and background pixels set? */
+  int i;
+
+  /* save pointer to current image */
+  current_image = imlib_context_get_image();
+
+  init_bitmap(&pool->cmd_bitmap, source_image, thresh, lt);
+  rle = pool->cmd_rle;
+  tmp = pool->cmd_rle + 1;
+  encode_rle(rle, &pool->cmd_bitmap);
+
+  /* every iteration thresholds the image drawn by the previous one */
+  fg_set = gray_is_set(ssocr_foreground, thresh, lt);
+  bg_set = gray_is_set(ssocr_background, thresh, lt);
+  for(i = 0; i < iter; i++) {
+    if(i > 0 && !(fg_set && !bg_set)) {
+      rethreshold(rle, tmp, fg_set, bg_set);
+      swap = rle;
+      rle = tmp;
+      tmp = swap;
+    }
+    rle_filter(rle, tmp, mask);
+    swap = rle;
+    rle = tmp;
+    tmp = swap;
+  }
+
+  /* draw the image, or keep it unchanged for no iterations */
+  if(iter > 0) {
+    new_image = rle_to_image(rle, source_image);
+  } else {
+    imlib_context_set_image(*source_image);
+    new_image = pool_clone_image();
+  }
+
+  /* restore image from before function call */
+  imlib_context_set_image(current_image);
+
+  /* return filtered image */
+  return new_image;
+}
+
+/* draw run-length encoded image in fore- and background color into a copy
+ * of source_image (of the same dimensions) */
+Imlib_Image rle_to_image(rle_struct *rle, Imlib_Image *source_image)
+{
+  Imlib_Image new_image; /* construct image here */
+  Imlib_Image current_image; /* save image pointer */
+  DATA32 *data, fg, bg;
+  int i, x, y;
+
+  /* save pointer to current image */
+  current_image = imlib_context_get_image();
+
+  imlib_context_set_image(*source_image);
+  new_image = pool_clone_image();
+  imlib_context_set_image(new_image);
+  data = imlib_image_get_data();
+  fg = 0xff000000 | (ssocr_foreground << 16) | (ssocr_foreground << 8)
+       | ssocr_foreground;
+  bg = 0xff000000 | (ssocr_background << 16) | (ssocr_background << 8)
+       | ssocr_background;
+  for(y = 0; y < rle->h; y++) {
+    DATA32 *row = data + (size_t)y * rle->w;
+    x = 0;
+    for(i = rle->row[y]; i < rle->row[y+1]; i++) {
+      for(; x < rle->runs[i].x1; x++) row[x] = bg;
+      for(; x <= rle->runs[i].x2; x++) row[x] = fg;
+    }
+    for(; x < rle->w; x++) row[x] = bg;
+  }
+  imlib_image_put_back_data(data);
+
+  /* restore image from before function call */
+  imlib_context_set_image(current_image);
+
+  return new_image;
+}
+
+/* find representative of the set containing run i, halving the path */
+static int find_root(int *parent, int i)
+{
+  while(parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+/* label the 8-connected components of set pixels, store the component number
+ * of every run in labels (nruns entries), components are numbered from 0 in
+ * the order of their first run, return number of components */
+int rle_label(rle_struct *rle, int *labels)
+{
+  int *parent; /* union-find forest over the runs */
+  int y, a, b, ra, rb, n;
+
+  parent = pool_buf(BUF_PARENT, rle->nruns, sizeof(int));
+  for(a = 0; a < rle->nruns; a++) {
+    parent[a] = a;
+  }
+  /* join runs of neighboring rows that touch, including diagonally */
+  for(y = 1; y < rle->h; y++) {
+    a = rle->row[y-1];
+    b = rle->row[y];
+    while(a < rle->row[y] && b < rle->row[y+1]) {
+      if(rle->runs[a].x1 <= rle->runs[b].x2 + 1 &&
+         rle->runs[b].x1 <= rle->runs[a].x2 + 1) {
+        ra = find_root(parent, a);
+        rb = find_root(parent, b);
+        /* the smaller run index becomes the root */
+        if(ra < rb) {
+          parent[rb] = ra;
+        } else if(rb < ra) {
+          parent[ra] = rb;
+        }
+      }
+      /* advance the run ending first */
+      if(rle->runs[a].x2 < rle->runs[b].x2) {
+        a++;
+      } else {
+        b++;
+      }
+    }
+  }
+  /* every root is the first run of its component */
+  n = 0;
+  for(a = 0; a < rle->nruns; a++) {
+    ra = find_root(parent, a);
+    if(ra == a) {
+      labels[a] = n++;
+    } else {
+      labels[a] = labels[ra];
+    }
+  }
+  return n;
+}
+
+/* return bounding box and size of every one of the n components, the memory
+ * belongs to the buffer pool and is valid until the next call */
+blob_struct *rle_blobs(rle_struct *rle, const int *labels, int n)
+{
+  blob_struct *blobs;
+  int y, i;
+
+  blobs = pool_buf_zero(BUF_BLOBS, n, sizeof(blob_struct));
+  for(y = 0; y < rle->h; y++) {
+    for(i = rle->row[y]; i < rle->row[y+1]; i++) {
+      blob_struct *b = blobs + labels[i];
+      if(b->area == 0) {
+        b->x1 = rle->runs[i].x1;
+        b->x2 = rle->runs[i].x2;
+        b->y1 = b->y2 = y;
+      } else {
+        if(rle->runs[i].x1 < b->x1) b->x1 = rle->runs[i].x1;
+        if(rle->runs[i].x2 > b->x2) b->x2 = rle->runs[i].x2;
+        b->y2 = y;
+      }
+      b->area += rle->runs[i].x2 - rle->runs[i].x1 + 1;
+    }
+  }
+  return blobs;
+}
+
+/* store a copy without the components of less than area pixels in dst */
+void rle_remove_small_blobs(rle_struct *rle, rle_struct *dst, int area)
+{
+  blob_struct *blobs;
+  int *labels;
+  int n, y, i;
+
+  labels = pool_buf(BUF_LABELS, rle->nruns, sizeof(int));
+  n = rle_label(rle, labels);
+  blobs = rle_blobs(rle, labels, n);
+  empty_rle(dst, rle->w, rle->h);
+  for(y = 0; y < rle->h; y++) {
+    dst->row[y] = dst->nruns;
+    for(i = rle->row[y]; i < rle->row[y+1]; i++) {
+      if(blobs[labels[i]].area >= area) {
+        add_run(dst, rle->runs[i].x1, rle->runs[i].x2);
+      }
+    }
+  }
+  dst->row[rle->h] = dst->nruns;
+}
+
+/* write run-length encoded image as binary PBM file (- is STDOUT),
+ * set pixels are written in the foreground color */
+void rle_save_pbm(rle_struct *rle, const char *filename, unsigned int flags)
+{
+  FILE *f;
+  unsigned char *line; /* one row of packed bits, 1 is black */
+  int y, i, x, bpl = (rle->w + 7) / 8;
+  int invert = (ssocr_foreground == SSOCR_WHITE);
+
+  if(flags & VERBOSE)
+    fprintf(stderr, "writing output image to file %s\n", filename);
+  if(strcmp("-", filename) == 0) {
+    f = stdout;
+  } else if(!(f = fopen(filename, "wb"))) {
+    fprintf(stderr, "%s: error saving image file %s\n", PROG, filename);
+    perror(PROG ": fopen()");
+    return;
+  }
+  if(!(line = calloc(bpl ? bpl : 1, 1))) {
+    perror(PROG ": line = calloc()");
+    exit(99);
+  }
+  fprintf(f, "P4\n%d %d\n", rle->w, rle->h);
+  for(y = 0; y < rle->h; y++) {
+    memset(line, 0, bpl);
+    for(i = rle->row[y]; i < rle->row[y+1]; i++) {
+      for(x = rle->runs[i].x1; x <= rle->runs[i].x2; x++) {
+        line[x >> 3] |= 0x80 >> (x & 7);
+      }
+    }
+    if(invert) {
+      for(x = 0; x < bpl; x++) line[x] = ~line[x];
+      /* padding bits at the end of the row stay zero */
+      if(rle->w & 7) line[bpl-1] &= 0xff << (8 - (rle->w & 7));
+    }
+    fwrite(line, 1, bpl, f);
+  }
+  free(line);
+  if(f != stdout) {
+    if(fclose(f) != 0) {
+      fprintf(stderr, "%s: error saving image file %s\n", PROG, filename);
+      perror(PROG ": fclose()");
+    }
+  } else {
+    fflush(f);
+  }
+}
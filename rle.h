@@ -0,0 +1,100 @@
+/* Seven Segment Optical Character Recognition Run-Length Encoding Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* Needs "buffer.h" to be included before. */
+
+#ifndef SSOCR2_RLE_H
+#define SSOCR2_RLE_H
+
+/* a run of set pixels from x1 to x2 (both included) */
+typedef struct {
+  int x1, x2;
+} run_struct;
+
+/* run-length encoded thresholded image
+ * the runs of row y are runs[row[y]] to runs[row[y+1]-1], sorted by x,
+ * neither overlapping nor touching each other */
+typedef struct {
+  int w, h;           /* image dimensions in pixels */
+  int *row;           /* index of first run of each row, h+1 entries */
+  run_struct *runs;   /* runs of all rows */
+  int nruns;          /* number of runs */
+  int size;           /* number of runs that fit into allocated memory */
+  buf_struct row_buf; /* memory of row */
+  buf_struct runs_buf; /* memory of runs */
+} rle_struct;
+
+/* bounding box and number of pixels of a connected component */
+typedef struct {
+  int x1, y1, x2, y2; /* bounding box, both corners included */
+  int area;           /* number of set pixels */
+} blob_struct;
+
+/* functions */
+
+/* run-length encode a thresholded image */
+rle_struct *new_rle(bitmap_struct *bitmap);
+
+/* run-length encode a thresholded image into rle like new_rle(), reusing its
+ * memory, rle must be zeroed before its first use */
+void encode_rle(rle_struct *rle, bitmap_struct *bitmap);
+
+/* free the memory of a run-length encoded image, but not the image itself */
+void clear_rle(rle_struct *rle);
+
+/* free a run-length encoded image */
+void free_rle(rle_struct *rle);
+
+/* return 1 if the pixel at (x,y) is set, 0 otherwise */
+int rle_pixel(rle_struct *rle, int x, int y);
+
+/* store the number of set pixels of columns x0 to x1-1 in cols (x1-x0
+ * entries), using diff (x1-x0+1 entries) as scratch memory */
+void rle_col_profile_range(rle_struct *rle, int x0, int x1, int *cols,
+                           int *diff);
+
+/* filter rle into dst with a 3x3 neighborhood like set_pixels_filter(),
+ * mask 1 is dilation, mask 9 is erosion, no other masks are supported */
+void rle_filter(rle_struct *rle, rle_struct *dst, int mask);
+
+/* apply dilation (mask 1) or erosion (mask 9) iter times to an image,
+ * the result is identical to set_pixels_filter_iter() */
+Imlib_Image rle_filter_image(Imlib_Image *source_image, double thresh,
+                             luminance_t lt, int mask, int iter);
+
+/* draw run-length encoded image in fore- and background color into a copy
+ * of source_image (of the same dimensions) */
+Imlib_Image rle_to_image(rle_struct *rle, Imlib_Image *source_image);
+
+/* label the 8-connected components of set pixels, store the component number
+ * of every run in labels (nruns entries), components are numbered from 0 in
+ * the order of their first run, return number of components */
+int rle_label(rle_struct *rle, int *labels);
+
+/* return bounding box and size of every one of the n components, the memory
+ * belongs to the buffer pool and is valid until the next call */
+blob_struct *rle_blobs(rle_struct *rle, const int *labels, int n);
+
+/* store a copy without the components of less than area pixels in dst */
+void rle_remove_small_blobs(rle_struct *rle, rle_struct *dst, int area);
+
+/* write run-length encoded image as binary PBM file (- is STDOUT),
+ * set pixels are written in the foreground color */
+void rle_save_pbm(rle_struct *rle, const char *filename, unsigned int flags);
+
+#endif /* SSOCR2_RLE_H */
@@ -0,0 +1,342 @@
+/* Seven Segment Optical Character Recognition Daemon and Client */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* standard things */
+#include <errno.h>          /* errno, EINTR, ECONNABORTED, EAGAIN */
+#include <stdint.h>         /* uint32_t, int32_t */
+#include <stdio.h>          /* fprintf, fflush, perror, clearerr */
+#include <stdlib.h>         /* malloc, calloc, free, exit */
+#include <string.h>         /* memcpy, memset, strlen */
+
+/* sockets and file descriptors */
+#include <fcntl.h>          /* open, O_RDONLY, O_DIRECTORY */
+#include <signal.h>         /* signal, SIGPIPE, SIG_IGN */
+#include <sys/socket.h>     /* socket, bind, listen, accept, sendmsg, ... */
+#include <sys/stat.h>       /* lstat, S_ISSOCK */
+#include <sys/time.h>       /* struct timeval */
+#include <sys/un.h>         /* struct sockaddr_un */
+#include <unistd.h>         /* read, write, close, dup, dup2, fchdir, unlink */
+
+/* my headers */
+#include "defines.h"        /* PROG, VERBOSE, MAX_REQUEST, REQUEST_TIMEOUT */
+#include "server.h"         /* daemon and client */
+
+/* functions */
+
+/* fill the address of the Unix domain socket path,
+ * return 0 on success or -1 if the path is too long */
+static int socket_address(const char *path, struct sockaddr_un *addr)
+{
+  size_t len = strlen(path);
+
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+  if(len >= sizeof(addr->sun_path)) {
+    fprintf(stderr, "%s: error: socket path %s is too long\n", PROG, path);
+    return -1;
+  }
+  memcpy(addr->sun_path, path, len + 1);
+  return 0;
+}
+
+/* read exactly len bytes, return 0 on success or -1 on error or end of file */
+static int read_all(int fd, void *buf, size_t len)
+{
+  unsigned char *p = buf;
+  ssize_t n;
+
+  while(len > 0) {
+    n = read(fd, p, len);
+    if(n < 0 && errno == EINTR) continue;
+    if(n <= 0) return -1;
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+/* write exactly len bytes, return 0 on success or -1 on error */
+static int write_all(int fd, const void *buf, size_t len)
+{
+  const unsigned char *p = buf;
+  ssize_t n;
+
+  while(len > 0) {
+    n = write(fd, p, len);
+    if(n < 0 && errno == EINTR) continue;
+    if(n <= 0) return -1;
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+/* receive a request, i.e., the file descriptors and the arguments,
+ * return the number of arguments or -1 if the request is invalid,
+ * args and argv are allocated and need to be freed */
+static int receive_request(int conn, int *fds, char **args_ptr,
+                           char ***argv_ptr)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union { /* control message holding the file descriptors */
+    char buf[CMSG_SPACE(REQUEST_FDS * sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  uint32_t len; /* length of the arguments */
+  char *args, **argv;
+  ssize_t n;
+  int i, nfds = 0, argc = 0;
+
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = &len;
+  iov.iov_len = sizeof(len);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  do {
+    n = recvmsg(conn, &msg, 0);
+  } while(n < 0 && errno == EINTR);
+  if(n <= 0) return -1;
+  for(cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      memcpy(fds, CMSG_DATA(cmsg),
+             ((nfds < REQUEST_FDS) ? nfds : REQUEST_FDS) * sizeof(int));
+    }
+  }
+  /* the rest of the length may arrive later */
+  if(nfds != REQUEST_FDS ||
+     read_all(conn, (unsigned char *)&len + n, sizeof(len) - n) < 0 ||
+     len == 0 || len > MAX_REQUEST) {
+    for(i = 0; i < nfds && i < REQUEST_FDS; i++) close(fds[i]);
+    return -1;
+  }
+
+  if(!(args = malloc(len))) {
+    perror(PROG ": args = malloc()");
+    exit(99);
+  }
+  if(read_all(conn, args, len) < 0 || args[len-1] != '\0') {
+    free(args);
+    for(i = 0; i < REQUEST_FDS; i++) close(fds[i]);
+    return -1;
+  }
+  for(i = 0; i < (int)len; i++) {
+    if(args[i] == '\0') argc++;
+  }
+  if(!(argv = calloc(argc + 1, sizeof(char *)))) {
+    perror(PROG ": argv = calloc()");
+    exit(99);
+  }
+  argv[0] = args;
+  for(i = 0, argc = 1; i < (int)len - 1; i++) {
+    if(args[i] == '\0') argv[argc++] = args + i + 1;
+  }
+  *args_ptr = args;
+  *argv_ptr = argv;
+  return argc;
+}
+
+/* use the given standard input, output, error, and working directory */
+static void redirect(const int *fds)
+{
+  int i;
+
+  fflush(stdout);
+  fflush(stderr);
+  for(i = 0; i < 3; i++) {
+    dup2(fds[i], i);
+  }
+  if(fchdir(fds[3]) < 0) perror(PROG ": fchdir()");
+  clearerr(stdin);
+  clearerr(stdout);
+  clearerr(stderr);
+}
+
+/* listen on the Unix domain socket path and answer one request after the
+ * other with handler, return only on error with exit code 99 */
+int serve(const char *path, unsigned int flags, request_fn handler)
+{
+  struct sockaddr_un addr;
+  struct stat st;
+  int saved[REQUEST_FDS]; /* the daemon's own file descriptors */
+  int fds[REQUEST_FDS]; /* file descriptors of the client */
+  int sock, conn, argc, i;
+  char *args, **argv;
+  int32_t status;
+  unsigned long int count = 0; /* number of requests */
+  struct timeval timeout; /* for receiving a request and answering it */
+
+  if(socket_address(path, &addr) < 0) return 99;
+  /* a client going away must not terminate the daemon */
+  signal(SIGPIPE, SIG_IGN);
+  /* replace the socket of an earlier daemon, but no other kind of file */
+  if(lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(path);
+  if((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+     bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+     listen(sock, SOMAXCONN) < 0) {
+    fprintf(stderr, "%s: error: could not listen on socket %s\n", PROG, path);
+    perror(PROG ": socket()");
+    return 99;
+  }
+  for(i = 0; i < 3; i++) {
+    saved[i] = dup(i);
+  }
+  saved[3] = open(".", O_RDONLY | O_DIRECTORY);
+  for(i = 0; i < REQUEST_FDS; i++) {
+    if(saved[i] < 0) {
+      perror(PROG ": could not keep standard file descriptors");
+      return 99;
+    }
+  }
+  timeout.tv_sec = REQUEST_TIMEOUT;
+  timeout.tv_usec = 0;
+  if(flags & VERBOSE) {
+    fprintf(stderr, "listening on socket %s\n", path);
+  }
+
+  while(1) {
+    if((conn = accept(sock, NULL, NULL)) < 0) {
+      if(errno == EINTR || errno == ECONNABORTED) continue;
+      perror(PROG ": accept()");
+      break;
+    }
+    /* a client that stalls must not block the following clients */
+    if(setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                  sizeof(timeout)) < 0 ||
+       setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                  sizeof(timeout)) < 0) {
+      perror(PROG ": setsockopt()");
+      close(conn);
+      continue;
+    }
+    if((argc = receive_request(conn, fds, &args, &argv)) < 0) {
+      if(errno == EAGAIN || errno == EWOULDBLOCK) {
+        fprintf(stderr, "%s: warning: dropping client sending no request"
+                        " within %d seconds\n", PROG, REQUEST_TIMEOUT);
+      } else {
+        fprintf(stderr, "%s: warning: ignoring invalid request\n", PROG);
+      }
+      close(conn);
+      continue;
+    }
+    count++;
+    /* the output of the request goes to the client */
+    redirect(fds);
+    status = handler(argc, argv);
+    redirect(saved);
+    for(i = 0; i < REQUEST_FDS; i++) {
+      close(fds[i]);
+    }
+    if(write_all(conn, &status, sizeof(status)) < 0) {
+      fprintf(stderr, "%s: warning: could not answer request %lu\n", PROG,
+                      count);
+    }
+    close(conn);
+    if(flags & VERBOSE) {
+      fprintf(stderr, "request %lu with %d arguments, exit code %d\n", count,
+                      argc, (int) status);
+    }
+    free(argv);
+    free(args);
+  }
+  close(sock);
+  return 99;
+}
+
+/* send argv to the daemon listening on the Unix domain socket path,
+ * return the exit code received from the daemon, or 99 on error */
+int client(const char *path, int argc, char **argv)
+{
+  struct sockaddr_un addr;
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union { /* control message holding the file descriptors */
+    char buf[CMSG_SPACE(REQUEST_FDS * sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  int fds[REQUEST_FDS] = {0, 1, 2, -1}; /* stdin, stdout, stderr, and cwd */
+  int sock, i;
+  size_t len = 0, l;
+  char *args;
+  uint32_t n;
+  int32_t status = 99;
+
+  if(socket_address(path, &addr) < 0) return 99;
+  for(i = 0; i < argc; i++) {
+    len += strlen(argv[i]) + 1;
+  }
+  if(len > MAX_REQUEST) {
+    fprintf(stderr, "%s: error: arguments are too long for the daemon\n",
+                    PROG);
+    return 99;
+  }
+  if(!(args = malloc(len))) {
+    perror(PROG ": args = malloc()");
+    exit(99);
+  }
+  for(i = 0, len = 0; i < argc; i++) {
+    l = strlen(argv[i]) + 1;
+    memcpy(args + len, argv[i], l);
+    len += l;
+  }
+  if((fds[3] = open(".", O_RDONLY | O_DIRECTORY)) < 0) {
+    perror(PROG ": could not open working directory");
+    free(args);
+    return 99;
+  }
+  if((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+     connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    fprintf(stderr, "%s: error: could not connect to daemon at %s\n", PROG,
+                    path);
+    perror(PROG ": connect()");
+    if(sock >= 0) close(sock);
+    close(fds[3]);
+    free(args);
+    return 99;
+  }
+
+  n = len;
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = &n;
+  iov.iov_len = sizeof(n);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+  if(sendmsg(sock, &msg, 0) != (ssize_t) sizeof(n) ||
+     write_all(sock, args, len) < 0 ||
+     read_all(sock, &status, sizeof(status)) < 0) {
+    fprintf(stderr, "%s: error: no answer from daemon at %s\n", PROG, path);
+    status = 99;
+  }
+  close(sock);
+  close(fds[3]);
+  free(args);
+
+  return status;
+}
@@ -0,0 +1,46 @@
+/* Seven Segment Optical Character Recognition Daemon and Client */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* A request consists of the arguments of ssocr, the client's standard input,
+ * output, and error, and its working directory.  The client sends the length
+ * of the arguments as a uint32_t together with the four file descriptors
+ * (SCM_RIGHTS), followed by the NUL terminated arguments.  The daemon uses
+ * the file descriptors while handling the request, thus the client's output
+ * is exactly that of ssocr, and answers with the exit code as an int32_t. */
+
+#ifndef SSOCR2_SERVER_H
+#define SSOCR2_SERVER_H
+
+/* number of file descriptors sent with a request */
+#define REQUEST_FDS 4
+
+/* function answering a request like main() answers a command line,
+ * returns the exit code */
+typedef int (*request_fn)(int argc, char **argv);
+
+/* functions */
+
+/* listen on the Unix domain socket path and answer one request after the
+ * other with handler, return only on error with exit code 99 */
+int serve(const char *path, unsigned int flags, request_fn handler);
+
+/* send argv to the daemon listening on the Unix domain socket path,
+ * return the exit code received from the daemon, or 99 on error */
+int client(const char *path, int argc, char **argv);
+
+#endif /* SSOCR2_SERVER_H */
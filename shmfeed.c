@@ -0,0 +1,139 @@
+/* Seven Segment Optical Character Recognition Shared Memory Frame Producer */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* A reference producer for the shared memory frame ring read by ssocr -k:
+ * it writes binary PNM images to a ring like a capture process writes the
+ * frames of a camera, e.g.:
+ *
+ *   shmfeed -r 100 /ssocr-test image.pgm &
+ *   ssocr -k -d -1 /ssocr-test
+ *
+ * shmfeed waits until ssocr has processed all frames before it removes the
+ * ring. */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* fprintf, perror */
+#include <stdlib.h>         /* atoi, calloc, free, exit */
+#include <string.h>         /* memcpy */
+
+/* option parsing */
+#include <unistd.h>         /* getopt */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "pnm.h"            /* PNM loading */
+#include "shmring.h"        /* shared memory frame ring */
+
+/* slots of the ring by default */
+#define SHMFEED_SLOTS 4
+
+/* print usage */
+static void shmfeed_usage(const char *name, FILE *f)
+{
+  fprintf(f, "Usage: %s [-v] [-n SLOTS] [-r REPEAT] NAME IMAGE...\n", name);
+  fprintf(f, "Write the binary PNM IMAGEs REPEAT times to the shared memory"
+             " frame ring NAME\n(e.g., /ssocr-test) of SLOTS slots (default"
+             " %d) for ssocr -k NAME.\n", SHMFEED_SLOTS);
+}
+
+int main(int argc, char **argv)
+{
+  shm_ring_struct *ring;
+  shm_frame_struct *f; /* frame in a slot of the ring */
+  frame_struct **images;
+  size_t size = 0; /* bytes of pixel data of the largest image */
+  unsigned long int seq = 0; /* sequence number of a frame */
+  int nslots = SHMFEED_SLOTS, repeat = 1, verbose = 0;
+  int nimages, c, i, r;
+
+  while((c = getopt(argc, argv, "hvn:r:")) != -1) {
+    switch(c) {
+      case 'v':
+        verbose = 1;
+        break;
+      case 'n':
+        nslots = atoi(optarg);
+        break;
+      case 'r':
+        repeat = atoi(optarg);
+        break;
+      case 'h':
+        shmfeed_usage(argv[0], stdout);
+        exit(0);
+      default:
+        shmfeed_usage(argv[0], stderr);
+        exit(2);
+    }
+  }
+  if(argc - optind < 2 || nslots < 1 || repeat < 0) {
+    shmfeed_usage(argv[0], stderr);
+    exit(2);
+  }
+
+  /* the slots are large enough for every image */
+  nimages = argc - optind - 1;
+  if(!(images = calloc(nimages, sizeof(frame_struct *)))) {
+    perror("shmfeed: images = calloc()");
+    exit(99);
+  }
+  for(i = 0; i < nimages; i++) {
+    if(!(images[i] = pnm_load_file(argv[optind + 1 + i]))) {
+      fprintf(stderr, "shmfeed: error: %s is no binary PNM image\n",
+                      argv[optind + 1 + i]);
+      exit(99);
+    }
+    if(images[i]->stride * images[i]->h > size) {
+      size = images[i]->stride * images[i]->h;
+    }
+  }
+  if(!(ring = shm_ring_create(argv[optind], nslots, size))) exit(99);
+  if(verbose) {
+    fprintf(stderr, "writing %d images %d times to shared memory %s\n",
+                    nimages, repeat, argv[optind]);
+  }
+
+  for(r = 0; r < repeat; r++) {
+    for(i = 0; i < nimages; i++) {
+      f = shm_ring_reserve(ring);
+      f->w = images[i]->w;
+      f->h = images[i]->h;
+      f->fmt = images[i]->fmt;
+      f->stride = images[i]->stride;
+      f->seq = seq++;
+      memcpy(shm_ring_data(f), images[i]->data,
+             images[i]->stride * images[i]->h);
+      shm_ring_publish(ring);
+    }
+  }
+  shm_ring_close(ring);
+  if(verbose) {
+    fprintf(stderr, "%lu frames have been processed\n", seq);
+  }
+  free_shm_ring(ring);
+  for(i = 0; i < nimages; i++) {
+    free_frame(images[i]);
+  }
+  free(images);
+
+  exit(0);
+}
@@ -0,0 +1,257 @@
+/* Seven Segment Optical Character Recognition Shared Memory Frame Ring */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* standard things */
+#include <stdatomic.h>      /* atomic_load_explicit, atomic_store_explicit */
+#include <stdint.h>         /* uint32_t, uint64_t, UINT32_MAX */
+#include <stdio.h>          /* fprintf, perror */
+#include <stdlib.h>         /* calloc, free, exit */
+#include <string.h>         /* strdup */
+#include <time.h>           /* nanosleep */
+
+/* shared memory */
+#include <fcntl.h>          /* O_CREAT, O_RDWR */
+#include <sys/mman.h>       /* shm_open, shm_unlink, mmap, munmap */
+#include <sys/stat.h>       /* fstat */
+#include <unistd.h>         /* ftruncate, close */
+
+/* my headers */
+#include "defines.h"        /* PROG, SHM_RING_POLL */
+#include "shmring.h"        /* shared memory frame ring */
+
+/* offset of the first slot */
+#define SHM_RING_SLOTS \
+  ((sizeof(shm_ring_header_struct) + SHM_RING_ALIGN - 1) / SHM_RING_ALIGN * \
+   SHM_RING_ALIGN)
+
+/* functions */
+
+/* wait a little for the other side of the ring */
+static void shm_ring_wait(void)
+{
+  struct timespec ts;
+
+  ts.tv_sec = 0;
+  ts.tv_nsec = SHM_RING_POLL * 1000L;
+  nanosleep(&ts, NULL);
+}
+
+/* map the shared memory object fd of a ring of len bytes,
+ * return NULL on error */
+static shm_ring_struct *shm_ring_map(const char *name, int fd, size_t len)
+{
+  shm_ring_struct *ring;
+  void *map;
+
+  map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(map == MAP_FAILED) {
+    fprintf(stderr, "%s: error: could not map shared memory %s\n", PROG,
+                    name);
+    perror(PROG ": mmap()");
+    return NULL;
+  }
+  if(!(ring = calloc(1, sizeof(shm_ring_struct))) ||
+     !(ring->name = strdup(name))) {
+    perror(PROG ": ring = calloc()");
+    exit(99);
+  }
+  ring->hdr = map;
+  ring->slots = (unsigned char *) map + SHM_RING_SLOTS;
+  ring->map_len = len;
+  return ring;
+}
+
+/* create a ring of nslots slots with room for frame_size bytes of pixel data
+ * each, replacing an existing ring of the same name, return NULL on error */
+shm_ring_struct *shm_ring_create(const char *name, unsigned int nslots,
+                                 size_t frame_size)
+{
+  shm_ring_struct *ring;
+  shm_ring_header_struct *hdr;
+  size_t slot_size, len;
+  int fd;
+
+  slot_size = (SHM_RING_ALIGN + frame_size + SHM_RING_ALIGN - 1) /
+              SHM_RING_ALIGN * SHM_RING_ALIGN;
+  if(nslots < 1 || slot_size > UINT32_MAX) {
+    fprintf(stderr, "%s: error: invalid size of shared memory ring\n", PROG);
+    return NULL;
+  }
+  len = SHM_RING_SLOTS + nslots * slot_size;
+  shm_unlink(name);
+  if((fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600)) < 0 ||
+     ftruncate(fd, len) < 0) {
+    fprintf(stderr, "%s: error: could not create shared memory %s\n", PROG,
+                    name);
+    perror(PROG ": shm_open()");
+    if(fd >= 0) {
+      close(fd);
+      shm_unlink(name);
+    }
+    return NULL;
+  }
+  ring = shm_ring_map(name, fd, len);
+  close(fd);
+  if(!ring) {
+    shm_unlink(name);
+    return NULL;
+  }
+  ring->owner = 1;
+  /* the memory of a new shared memory object is zero */
+  hdr = ring->hdr;
+  hdr->version = SHM_RING_VERSION;
+  hdr->slots = nslots;
+  hdr->slot_size = slot_size;
+  atomic_store_explicit(&hdr->magic, SHM_RING_MAGIC, memory_order_release);
+  return ring;
+}
+
+/* attach to the ring created by a producer, return NULL on error */
+shm_ring_struct *shm_ring_attach(const char *name)
+{
+  shm_ring_struct *ring;
+  shm_ring_header_struct *hdr;
+  struct stat st;
+  int fd;
+
+  if((fd = shm_open(name, O_RDWR, 0)) < 0 || fstat(fd, &st) < 0) {
+    fprintf(stderr, "%s: error: could not open shared memory %s\n", PROG,
+                    name);
+    perror(PROG ": shm_open()");
+    if(fd >= 0) close(fd);
+    return NULL;
+  }
+  if((size_t) st.st_size < SHM_RING_SLOTS) {
+    fprintf(stderr, "%s: error: shared memory %s is not a frame ring\n",
+                    PROG, name);
+    close(fd);
+    return NULL;
+  }
+  ring = shm_ring_map(name, fd, st.st_size);
+  close(fd);
+  if(!ring) return NULL;
+  hdr = ring->hdr;
+  if(atomic_load_explicit(&hdr->magic, memory_order_acquire) !=
+     SHM_RING_MAGIC || hdr->version != SHM_RING_VERSION ||
+     hdr->slots < 1 || hdr->slot_size <= SHM_RING_ALIGN ||
+     hdr->slot_size % SHM_RING_ALIGN != 0 ||
+     (ring->map_len - SHM_RING_SLOTS) / hdr->slot_size < hdr->slots) {
+    fprintf(stderr, "%s: error: shared memory %s is not a frame ring\n",
+                    PROG, name);
+    free_shm_ring(ring);
+    return NULL;
+  }
+  return ring;
+}
+
+/* bytes of pixel data that fit into a slot */
+size_t shm_ring_frame_size(const shm_ring_struct *ring)
+{
+  return ring->hdr->slot_size - SHM_RING_ALIGN;
+}
+
+/* pixel data of a frame returned by shm_ring_reserve() or shm_ring_next() */
+unsigned char *shm_ring_data(shm_frame_struct *frame)
+{
+  return (unsigned char *) frame + SHM_RING_ALIGN;
+}
+
+/* slot of frame number n */
+static shm_frame_struct *shm_ring_slot(shm_ring_struct *ring, uint64_t n)
+{
+  shm_ring_header_struct *hdr = ring->hdr;
+
+  return (shm_frame_struct *)
+         (ring->slots + (size_t)(n % hdr->slots) * hdr->slot_size);
+}
+
+/* producer: wait for a free slot and return it */
+shm_frame_struct *shm_ring_reserve(shm_ring_struct *ring)
+{
+  shm_ring_header_struct *hdr = ring->hdr;
+  /* only the producer changes head */
+  uint64_t head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+
+  /* the consumer is done with a slot when it has incremented tail */
+  while(head - atomic_load_explicit(&hdr->tail, memory_order_acquire) >=
+        hdr->slots) {
+    shm_ring_wait();
+  }
+  return shm_ring_slot(ring, head);
+}
+
+/* producer: make the slot returned by shm_ring_reserve() available */
+void shm_ring_publish(shm_ring_struct *ring)
+{
+  shm_ring_header_struct *hdr = ring->hdr;
+  uint64_t head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+
+  /* the frame is written before the consumer sees the new head */
+  atomic_store_explicit(&hdr->head, head + 1, memory_order_release);
+}
+
+/* producer: mark the end of the frames and wait until all are processed */
+void shm_ring_close(shm_ring_struct *ring)
+{
+  shm_ring_header_struct *hdr = ring->hdr;
+  uint64_t head = atomic_load_explicit(&hdr->head, memory_order_relaxed);
+
+  atomic_store_explicit(&hdr->closed, 1, memory_order_release);
+  while(atomic_load_explicit(&hdr->tail, memory_order_acquire) != head) {
+    shm_ring_wait();
+  }
+}
+
+/* consumer: wait for the next frame and return it, return NULL after the last
+ * frame of a closed ring, the frame stays valid until shm_ring_release() */
+shm_frame_struct *shm_ring_next(shm_ring_struct *ring)
+{
+  shm_ring_header_struct *hdr = ring->hdr;
+  /* only the consumer changes tail */
+  uint64_t tail = atomic_load_explicit(&hdr->tail, memory_order_relaxed);
+
+  while(atomic_load_explicit(&hdr->head, memory_order_acquire) == tail) {
+    /* the producer closes the ring after publishing the last frame */
+    if(atomic_load_explicit(&hdr->closed, memory_order_acquire) &&
+       atomic_load_explicit(&hdr->head, memory_order_acquire) == tail) {
+      return NULL;
+    }
+    shm_ring_wait();
+  }
+  return shm_ring_slot(ring, tail);
+}
+
+/* consumer: return the slot of the frame returned by shm_ring_next() */
+void shm_ring_release(shm_ring_struct *ring)
+{
+  shm_ring_header_struct *hdr = ring->hdr;
+  uint64_t tail = atomic_load_explicit(&hdr->tail, memory_order_relaxed);
+
+  /* the frame has been processed before the producer sees the new tail */
+  atomic_store_explicit(&hdr->tail, tail + 1, memory_order_release);
+}
+
+/* unmap the ring, the producer also removes the shared memory object */
+void free_shm_ring(shm_ring_struct *ring)
+{
+  if(!ring) return;
+  munmap(ring->hdr, ring->map_len);
+  if(ring->owner) shm_unlink(ring->name);
+  free(ring->name);
+  free(ring);
+}
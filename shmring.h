@@ -0,0 +1,113 @@
+/* Seven Segment Optical Character Recognition Shared Memory Frame Ring */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* A ring of fixed-size frame slots in POSIX shared memory, written by one
+ * producer (e.g., a capture process) and read by one consumer (ssocr)
+ * without locks or copies.  The ring starts with a header, followed by the
+ * slots.  Every slot starts with the description of its frame, the pixel
+ * data follows at offset SHM_RING_ALIGN.  The producer fills the slot of
+ * frame head and then increments head, the consumer processes the slot of
+ * frame tail in place and then increments tail.  head and tail count the
+ * frames since the creation of the ring, the slot of a frame is its number
+ * modulo the number of slots.  The producer waits while all slots are
+ * occupied, the consumer waits while all slots are free, the consumer stops
+ * after the last frame if the producer has closed the ring. */
+
+#ifndef SSOCR2_SHMRING_H
+#define SSOCR2_SHMRING_H
+
+#include <stdatomic.h>      /* _Atomic */
+#include <stddef.h>         /* size_t */
+#include <stdint.h>         /* uint32_t, uint64_t */
+
+/* identifies an initialized ring ("ssoc") */
+#define SHM_RING_MAGIC 0x636f7373UL
+
+/* version of the layout of the ring */
+#define SHM_RING_VERSION 1
+
+/* alignment of the slots and of the pixel data in a slot (a cache line) */
+#define SHM_RING_ALIGN 64
+
+/* header of the ring, head and tail are on different cache lines */
+typedef struct {
+  _Atomic uint32_t magic;     /* SHM_RING_MAGIC after initialization */
+  uint32_t version;           /* SHM_RING_VERSION */
+  uint32_t slots;             /* number of slots */
+  uint32_t slot_size;         /* bytes per slot, a multiple of SHM_RING_ALIGN */
+  _Atomic uint32_t closed;    /* has the producer written the last frame? */
+  _Alignas(SHM_RING_ALIGN)
+  _Atomic uint64_t head;      /* frames written by the producer */
+  _Alignas(SHM_RING_ALIGN)
+  _Atomic uint64_t tail;      /* frames processed by the consumer */
+} shm_ring_header_struct;
+
+/* description of the frame at the start of a slot */
+typedef struct {
+  uint32_t w;                 /* width in pixels */
+  uint32_t h;                 /* height in pixels */
+  uint32_t fmt;               /* pixel format (frame_fmt_t) */
+  uint32_t stride;            /* bytes from one row to the next */
+  uint64_t seq;               /* sequence number set by the producer */
+} shm_frame_struct;
+
+/* a ring mapped into this process */
+typedef struct {
+  shm_ring_header_struct *hdr; /* start of the mapping */
+  unsigned char *slots;       /* first slot */
+  size_t map_len;             /* length of the mapping */
+  char *name;                 /* name of the shared memory object */
+  int owner;                  /* has this process created the ring? */
+} shm_ring_struct;
+
+/* functions */
+
+/* create a ring of nslots slots with room for frame_size bytes of pixel data
+ * each, replacing an existing ring of the same name, return NULL on error */
+shm_ring_struct *shm_ring_create(const char *name, unsigned int nslots,
+                                 size_t frame_size);
+
+/* attach to the ring created by a producer, return NULL on error */
+shm_ring_struct *shm_ring_attach(const char *name);
+
+/* bytes of pixel data that fit into a slot */
+size_t shm_ring_frame_size(const shm_ring_struct *ring);
+
+/* pixel data of a frame returned by shm_ring_reserve() or shm_ring_next() */
+unsigned char *shm_ring_data(shm_frame_struct *frame);
+
+/* producer: wait for a free slot and return it */
+shm_frame_struct *shm_ring_reserve(shm_ring_struct *ring);
+
+/* producer: make the slot returned by shm_ring_reserve() available */
+void shm_ring_publish(shm_ring_struct *ring);
+
+/* producer: mark the end of the frames and wait until all are processed */
+void shm_ring_close(shm_ring_struct *ring);
+
+/* consumer: wait for the next frame and return it, return NULL after the last
+ * frame of a closed ring, the frame stays valid until shm_ring_release() */
+shm_frame_struct *shm_ring_next(shm_ring_struct *ring);
+
+/* consumer: return the slot of the frame returned by shm_ring_next() */
+void shm_ring_release(shm_ring_struct *ring);
+
+/* unmap the ring, the producer also removes the shared memory object */
+void free_shm_ring(shm_ring_struct *ring);
+
+#endif /* SSOCR2_SHMRING_H */
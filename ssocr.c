@@ -25,10 +25,10 @@
 #include <limits.h>         /* INT_MAX */
 #include <stdint.h>         /* SIZE_MAX */
 #include <stdio.h>          /* puts, printf, BUFSIZ, perror, FILE */
-#include <stdlib.h>         /* exit */
+#include <stdlib.h>         /* exit, strtol */
 
 /* string manipulation */
-#include <string.h>         /* memcpy, strchr, strdup, strlen */
+#include <string.h>         /* memcpy, strchr, strcmp, strdup, strtok */
 
 /* option parsing */
 #include <getopt.h>         /* getopt */
@@ -43,22 +43,83 @@
 #include "imgproc.h"        /* image processing */
 #include "help.h"           /* online help */
 #include "charset.h"        /* character set selection and printing */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "buffer.h"         /* reusable buffers */
+#include "bitmap.h"         /* thresholded bitmap */
+#include "rle.h"            /* run-length encoding */
+#include "pnm.h"            /* PNM loading */
+#include "pngload.h"        /* PNG loading */
+#include "gif.h"            /* GIF loading */
+#include "y4m.h"            /* YUV4MPEG2 streams */
+#include "mjpeg.h"          /* MJPEG streams */
+#include "pool.h"           /* worker threads */
+#include "libssocr.h"       /* recognition */
+#include "server.h"         /* daemon and client */
+#include "streams.h"        /* multi-stream server */
+#include "shmring.h"        /* shared memory frame ring */
+#include "pipeline.h"       /* streaming pipeline */
 
-/* global variables */
-int ssocr_foreground = SSOCR_DEFAULT_FOREGROUND;
-int ssocr_background = SSOCR_DEFAULT_BACKGROUND;
+/* global variables, set by options and used by the library */
+extern _Thread_local int ssocr_foreground;
+extern _Thread_local int ssocr_background;
+
+/* Imlib2 1.10.0 and later can decode images from memory */
+#if defined(IMLIB2_VERSION_MAJOR) && defined(IMLIB2_VERSION_MINOR)
+#if (IMLIB2_VERSION_MAJOR > 1) || \
+    ((IMLIB2_VERSION_MAJOR == 1) && (IMLIB2_VERSION_MINOR >= 10))
+#define SSOCR_LOAD_IMAGE_MEM
+#endif
+#endif
+
+/* values of long options without a short option, above any character */
+#define OPT_CHANGES_ONLY 256
 
 /* functions */
 
-/* copy image from stdin to a temporary file and return the filename */
-static char * tmp_imgfile(unsigned int flags)
+/* read all data from stdin into a buffer, return buffer and set size */
+static unsigned char * read_stdin(size_t *size)
+{
+  unsigned char *buf = NULL, *tmp;
+  size_t buf_size = 0, len = 0;
+  ssize_t read_count;
+
+  do {
+    /* grow the buffer exponentially to keep the number of copies low */
+    if(len == buf_size) {
+      size_t new_size = buf_size ? 2 * buf_size : 16 * BUFSIZ;
+      if(new_size <= buf_size) {
+        fputs(PROG ": error: size_t overflow (memory for image data)\n",
+              stderr);
+        exit(99);
+      }
+      if(!(tmp = realloc(buf, new_size))) {
+        perror(PROG ": could not allocate memory for image data");
+        exit(99);
+      }
+      buf = tmp;
+      buf_size = new_size;
+    }
+    read_count = read(STDIN_FILENO, buf + len, buf_size - len);
+    if(read_count > 0) len += read_count;
+  } while(read_count > 0);
+  if(read_count < 0) {
+    perror(PROG ": could not read image from standard input");
+    exit(99);
+  }
+  *size = len;
+  return buf;
+}
+
+#ifndef SSOCR_LOAD_IMAGE_MEM
+/* copy image data to a temporary file and return the filename */
+static char * tmp_imgfile(const unsigned char *data, size_t size,
+                          unsigned int flags)
 {
   char *dir;
   char *name;
   size_t pattern_len;
   int handle;
-  unsigned char buf[BUFSIZ];
-  ssize_t read_count = 0, write_count = 0;
+  ssize_t write_count = 0;
   size_t pat_suffix_len = strlen(DIR_SEP TMP_FILE_PATTERN);
   size_t dir_len;
 
@@ -98,63 +159,23 @@ static char * tmp_imgfile(unsigned int flags)
     exit(99);
   }
 
-  /* copy image data from stdin to tmp file */
-  while((read_count = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
-    write_count = write(handle, buf, read_count);
+  /* copy image data to tmp file */
+  while(size > 0) {
+    write_count = write(handle, data, size);
     if (write_count <= 0) break;
+    data += write_count;
+    size -= write_count;
   }
   close(handle); /* filehandle is no longer needed, Imlib2 uses filename */
-  if(read_count < 0) {
-    perror(PROG ": could not read image from standard input");
-    exit(99);
-  }
-  if(write_count <= 0) {
+  if(size > 0) {
     perror(PROG ": could not copy image data to temporary file");
     unlink(name);
     exit(99);
   }
-  
-  return name;
-}
-
-/* return number of foreground pixels in a scanline */
-static unsigned int scanline(Imlib_Image *debug_image,
-                             int x, int y, int len, direction_t dir,
-                             color_struct d_color, double thresh,
-                             luminance_t lt, unsigned int flags)
-{
-  Imlib_Color imlib_color, debug_color;
-  int lum, i, ix=x, iy=y, start, end;
-  unsigned int found_pixels = 0;
-  start = (dir == HORIZONTAL) ? x : y;
-  end = start + len;
-  debug_color.red = d_color.R;
-  debug_color.green = d_color.G;
-  debug_color.blue = d_color.B;
-  debug_color.alpha = d_color.A;
-  for (i = start; i <= end; i++) {
-    if (dir == HORIZONTAL) ix = i;
-    else iy = i;
-    imlib_image_query_pixel(ix, iy, &imlib_color);
-    lum = get_lum(&imlib_color, lt);
-    if(is_pixel_set(lum, thresh)) {
-      if(flags & USE_DEBUG_IMAGE) {
-        draw_color_pixel(debug_image, ix, iy, debug_color);
-      }
-      found_pixels++;
-    }
-  }
-  return found_pixels;
-}
 
-/* print given number of space characters to given stream */
-static void print_spaces(FILE *f, int n)
-{
-  int i;
-  for (i = 0; i < n; i++) {
-    fputc(' ', f);
-  }
+  return name;
 }
+#endif /* SSOCR_LOAD_IMAGE_MEM */
 
 /* parse dimensions given as a string in the format "WxH" */
 static int parse_width_height(const char *s, dimensions_struct *d)
@@ -241,35 +262,525 @@ static int parse_interval(const char *s, interval_struct *i) {
   return 0;
 }
 
-/*** main() ***/
+/* parse the CPUs of the pipeline stages given as up to PIPELINE_STAGES
+ * numbers separated by commas, an empty entry leaves a stage unbound */
+static int parse_affinity(const char *s, int *cpus)
+{
+  int stage;
+  char *end;
+  long int cpu;
 
-int main(int argc, char **argv)
+  for(stage = 0; stage < PIPELINE_STAGES; stage++) {
+    cpus[stage] = -1;
+  }
+  for(stage = 0; stage < PIPELINE_STAGES; stage++) {
+    if(*s != ',' && *s != '\0') {
+      cpu = strtol(s, &end, 10);
+      if(end == s || cpu < 0 || cpu > INT_MAX) {
+        fputs(PROG ": error: invalid CPU in affinity specification\n", stderr);
+        return 1;
+      }
+      cpus[stage] = (int) cpu;
+      s = end;
+    }
+    if(*s == '\0') return 0;
+    if(*s != ',') break;
+    s++;
+  }
+  fputs(PROG ": error: invalid affinity specification\n", stderr);
+  return 1;
+}
+
+/* parse the tolerance for skipping unchanged frames */
+static int parse_skip(const char *s, int *tolerance)
+{
+  char *end;
+  long int tol;
+
+  tol = strtol(s, &end, 10);
+  if(end == s || *end != '\0' || tol < 0 || tol > INT_MAX) {
+    fputs(PROG ": error: invalid tolerance for skipping unchanged frames\n",
+          stderr);
+    return 1;
+  }
+  *tolerance = (int) tol;
+  return 0;
+}
+
+/* do the options or commands need color information? */
+static int need_color(const options_struct *opt, const command_struct *cmds,
+                      int ncmds)
+{
+  int c;
+
+  if(opt->lt != REC601 && opt->lt != REC709 && opt->lt != LINEAR) return 1;
+  for(c = 0; c < ncmds; c++) {
+    switch(cmds[c].cmd) {
+      case CMD_RGB_THRESHOLD:
+      case CMD_R_THRESHOLD:
+      case CMD_G_THRESHOLD:
+      case CMD_B_THRESHOLD:
+        return 1;
+      default:
+        break;
+    }
+  }
+  return 0;
+}
+
+#ifdef HAVE_LIBPNG
+/* return the crop area if only this part of an image needs to be decoded,
+ * i.e., cropping is the first command and neither threshold adaptation nor
+ * image information needs the whole image, or NULL otherwise */
+static const int *png_roi(const options_struct *opt,
+                          const command_struct *cmds, int ncmds)
+{
+  if(ncmds < 1 || cmds[0].cmd != CMD_CROP) return NULL;
+  if(!(opt->flags & (ADAPT_AFTER_CROP | ABSOLUTE_THRESHOLD | BILEVEL_INPUT)))
+    return NULL;
+  if(opt->flags & (DEBUG_OUTPUT | PRINT_INFO)) return NULL;
+  return cmds[0].n;
+}
+#endif
+
+#ifdef HAVE_LIBJPEG
+/* can frames be downscaled without changing the meaning of options and
+ * commands, i.e., do no options or commands use pixel coordinates or sizes? */
+static int can_scale(const options_struct *opt, const command_struct *cmds,
+                     int ncmds)
+{
+  int c;
+
+  if(opt->need_pixels != NEED_PIXELS || opt->min_segment != MIN_SEGMENT ||
+     opt->min_char_dims.w != MIN_CHAR_W || opt->min_char_dims.h != MIN_CHAR_H ||
+     opt->ignore_pixels != IGNORE_PIXELS) {
+    return 0;
+  }
+  for(c = 0; c < ncmds; c++) {
+    switch(cmds[c].cmd) {
+      case CMD_CROP:
+      case CMD_SHEAR:
+      case CMD_WHITE_BORDER:
+      case CMD_DYNAMIC_THRESHOLD:
+      case CMD_REMOVE_SMALL_BLOBS:
+        return 0;
+      default:
+        break;
+    }
+  }
+  return 1;
+}
+#endif
+
+/* a stream of frames read by the decoder stage of the pipeline */
+typedef struct {
+  FILE *stream;               /* file, FIFO, or STDIN */
+  y4m_struct *y4m;            /* YUV4MPEG2 stream parameters, or NULL */
+#ifdef HAVE_LIBJPEG
+  mjpeg_struct *mjpeg;        /* MJPEG decompressor, or NULL */
+#endif
+  int color;                  /* decode color frames? */
+} stream_source_struct;
+
+/* decode the next frame of a stream source (pipeline_decode_fn) */
+static int decode_stream(void *arg, frame_struct *frame)
+{
+  stream_source_struct *src = arg;
+
+#ifdef HAVE_LIBJPEG
+  if(src->mjpeg) return mjpeg_read_frame(src->stream, src->mjpeg, frame);
+#endif
+  if(src->y4m) return y4m_read_frame(src->stream, src->y4m, frame,
+                                     src->color);
+  return pnm_read_frame(src->stream, frame);
+}
+
+/* process every frame of a stream of binary PNM images, a YUV4MPEG2 stream,
+ * or an MJPEG stream read from a file or FIFO (- is STDIN), print one line
+ * per frame with frame index, recognized digits, and exit code for the frame,
+ * return the exit code for the stream */
+static int process_stream(ssocr_ctx_struct *ctx, const char *filename)
+{
+  const options_struct *opt = &ctx->opt;
+  const command_struct *cmds = ctx->cmds;
+  int ncmds = ctx->ncmds;
+  FILE *stream;
+  stream_source_struct src; /* read by the decoder stage */
+  y4m_struct *y4m = NULL; /* YUV4MPEG2 stream parameters */
+#ifdef HAVE_LIBJPEG
+  mjpeg_struct *mjpeg = NULL; /* MJPEG decompressor */
+#endif
+  int status, c, color = 0;
+
+  if(strcmp("-", filename) == 0) {
+    stream = stdin;
+  } else if(!(stream = fopen(filename, "rb"))) {
+    fprintf(stderr, "%s: error: could not open stream %s\n", PROG, filename);
+    perror(PROG ": fopen()");
+    return 99;
+  }
+
+  /* a YUV4MPEG2 stream provides the luma plane of every frame */
+  if((c = getc(stream)) != EOF) ungetc(c, stream);
+  if(c == Y4M_SIGNATURE[0]) {
+    if(!(y4m = y4m_read_header(stream))) {
+      fprintf(stderr, "%s: error: unsupported YUV4MPEG2 stream %s\n", PROG,
+                      filename);
+      if(stream != stdin) fclose(stream);
+      return 99;
+    }
+    color = need_color(opt, cmds, ncmds);
+    if(opt->flags & VERBOSE) {
+      fprintf(stderr, "reading YUV4MPEG2 stream of %dx%d pixels, colorspace"
+                      " %s, using %s\n", y4m->w, y4m->h, y4m->colorspace,
+                      color ? "color" : "luma only");
+    }
+  }
+
+  /* an MJPEG stream is a sequence of JPEG images */
+  if(c == MJPEG_SOI_0) {
+#ifdef HAVE_LIBJPEG
+    int scale = opt->jpeg_scale;
+    if(scale > 1 && !can_scale(opt, cmds, ncmds)) {
+      fprintf(stderr, "%s: warning: ignoring --jpeg-scale=%d, options or"
+                      " commands use pixel sizes\n", PROG, scale);
+      scale = 1;
+    }
+    color = need_color(opt, cmds, ncmds);
+    mjpeg = new_mjpeg(scale, color);
+    if(opt->flags & VERBOSE) {
+      fprintf(stderr, "reading MJPEG stream, scaled by 1/%d, using %s\n",
+                      scale, color ? "color" : "grayscale");
+    }
+#else
+    fprintf(stderr, "%s: error: MJPEG stream %s not supported without"
+                    " libjpeg\n", PROG, filename);
+    if(stream != stdin) fclose(stream);
+    return 99;
+#endif
+  }
+
+  /* decode, recognize, and print on separate threads */
+  src.stream = stream;
+  src.y4m = y4m;
+#ifdef HAVE_LIBJPEG
+  src.mjpeg = mjpeg;
+#endif
+  src.color = color;
+  status = run_pipeline(ctx, filename, decode_stream, &src);
+  free_y4m(y4m);
+#ifdef HAVE_LIBJPEG
+  free_mjpeg(mjpeg);
+#endif
+  if(stream != stdin) fclose(stream);
+
+  return status;
+}
+
+/* process every frame written by a capture process to the shared memory
+ * frame ring name in place, print one line per frame with the sequence number
+ * of the frame, recognized digits, and exit code for the frame, return the
+ * exit code for the ring */
+static int process_shm(ssocr_ctx_struct *ctx, const char *name)
+{
+  shm_ring_struct *ring;
+  shm_frame_struct *f; /* frame in a slot of the ring */
+  ssocr_result_struct res; /* digits recognized in a frame */
+  unsigned long int frames = 0;
+  unsigned long int unchanged = 0; /* frames skipped as unchanged */
+  size_t size;
+  int status;
+
+  if(!(ring = shm_ring_attach(name))) return 99;
+  if(ctx->opt.flags & VERBOSE) {
+    fprintf(stderr, "reading frames of up to %lu bytes from shared memory"
+                    " %s\n", (unsigned long int) shm_ring_frame_size(ring),
+                    name);
+  }
+  while((f = shm_ring_next(ring))) {
+    /* a frame must fit into its slot, NV12 adds half as many chroma rows */
+    size = (size_t) f->stride * f->h;
+    if(f->fmt == FRAME_NV12) size += (size_t) f->stride * ((f->h + 1) / 2);
+    if(f->fmt > FRAME_NV12 || f->fmt == FRAME_PAL8 ||
+       size > shm_ring_frame_size(ring)) {
+      fprintf(stderr, "%s: error: invalid frame %lu in shared memory %s\n",
+                      PROG, (unsigned long int) f->seq, name);
+      printf("%lu\t\t99\n", (unsigned long int) f->seq);
+    } else {
+      status = ssocr_recognize_buffer(ctx, shm_ring_data(f), f->fmt, f->w,
+                                      f->h, f->stride, &res);
+      if(res.unchanged) unchanged++;
+      /* with --changes-only an unchanged frame prints nothing */
+      if(!res.unchanged || !(ctx->opt.flags & CHANGES_ONLY)) {
+        printf("%lu\t%s\t%d\n", (unsigned long int) f->seq, res.text,
+                                  status);
+      }
+    }
+    fflush(stdout);
+    shm_ring_release(ring);
+    frames++;
+  }
+  if(ctx->opt.flags & VERBOSE) {
+    fprintf(stderr, "end of shared memory %s after %lu frames\n", name,
+                    frames);
+    if(ctx->opt.flags & SKIP_UNCHANGED) {
+      fprintf(stderr, "%lu unchanged frames have not been recognized\n",
+                      unchanged);
+    }
+  }
+  free_shm_ring(ring);
+
+  return 0;
+}
+
+/* load an image file (- is STDIN) either as a frame decoded without Imlib2
+ * or as an Imlib2 image, return 0 on success or 99 after printing an error */
+static int load_image(const char *filename, const options_struct *opt,
+                      const command_struct *cmds, int ncmds,
+                      Imlib_Image *image, frame_struct **frame)
 {
-  Imlib_Image image=NULL; /* an image handle */
-  Imlib_Image new_image=NULL; /* a temporary image handle */
-  Imlib_Image debug_image=NULL; /* DEBUG */
   Imlib_Load_Error load_error=0; /* save Imlib2 error code on image I/O*/
-  char *imgfile=NULL; /* filename of image file */
-  int use_tmpfile=0; /* flag to know if temporary image file is used */
+  unsigned int flags = opt->flags;
+#ifdef HAVE_LIBPNG
+  int partial; /* was only the crop area of a PNG image decoded? */
+#else
+  (void) cmds;
+  (void) ncmds;
+#endif
+
+  *image = NULL;
+  *frame = NULL;
+  if(strcmp("-", filename) == 0) /* read image from stdin? */ {
+    unsigned char *data;
+    size_t size;
+    data = read_stdin(&size);
+    if(flags & DEBUG_OUTPUT) {
+      fprintf(stderr, "read %lu bytes of image data from stdin\n",
+                      (unsigned long) size);
+    }
+    /* binary PNM data is used in place, the frame keeps the buffer */
+    if((*frame = pnm_load_buffer(data, size))) {
+      if(flags & DEBUG_OUTPUT)
+        fputs("using PNM pixel data from stdin directly\n", stderr);
+    } else {
+      ssocr_lock_imlib();
+#ifdef SSOCR_LOAD_IMAGE_MEM
+      if(flags & VERBOSE)
+        fputs("loading image from memory\n", stderr);
+      *image = imlib_load_image_mem(filename, data, size);
+      if(!*image) {
+        load_error = IMLIB_LOAD_ERROR_UNKNOWN;
+      }
+#else
+      char *tmpfile;
+      if(flags & VERBOSE)
+        fprintf(stderr, "using temporary file to hold data from stdin\n");
+      tmpfile = tmp_imgfile(data, size, flags);
+      if(flags & VERBOSE) {
+        fprintf(stderr, "loading image %s\n", tmpfile);
+      }
+      *image = imlib_load_image_with_error_return(tmpfile, &load_error);
+      if(flags & VERBOSE)
+        fprintf(stderr, "removing temporary image file %s\n", tmpfile);
+      unlink(tmpfile);
+      free(tmpfile);
+#endif
+      free(data);
+    }
+  } else {
+    if(flags & VERBOSE) {
+      fprintf(stderr, "loading image %s\n", filename);
+    }
+    /* binary PNM files are memory mapped and used without Imlib2 */
+    if((*frame = pnm_load_file(filename))) {
+      if(flags & DEBUG_OUTPUT)
+        fprintf(stderr, "using PNM pixel data of %s directly\n", filename);
+#ifdef HAVE_LIBPNG
+    } else if((*frame = png_load_file(filename, png_roi(opt, cmds, ncmds),
+                                      &partial))) {
+      if(flags & VERBOSE) {
+        if(partial) {
+          fprintf(stderr, "decoded only the crop area of PNG image %s\n",
+                          filename);
+        } else {
+          fprintf(stderr, "decoded PNG image %s without Imlib2\n", filename);
+        }
+      }
+#endif
+    } else if((*frame = gif_load_file(filename))) {
+      if(flags & VERBOSE)
+        fprintf(stderr, "decoded GIF image %s without Imlib2\n", filename);
+    } else {
+      ssocr_lock_imlib();
+      *image = imlib_load_image_with_error_return(filename, &load_error);
+    }
+  }
+  if(!*image && !*frame) {
+    fprintf(stderr, "%s: error: could not load image %s\n", PROG, filename);
+    report_imlib_error(load_error);
+    return 99;
+  }
+  return 0;
+}
+
+/* process one image of a parallel batch in a worker thread using the context
+ * of the worker, the output line is collected in memory and printed by the
+ * pool */
+static void batch_work(pool_task_struct *task, const void *arg, int worker)
+{
+  ssocr_ctx_struct *ctx = ((ssocr_ctx_struct * const *) arg)[worker];
+  ssocr_result_struct res; /* digits recognized in the image */
+  Imlib_Image image; /* image loaded with Imlib2 */
+  frame_struct *frame; /* image decoded without Imlib2 */
+  FILE *out; /* output line of this image */
+  size_t size;
+  int status;
+
+  if(!(out = open_memstream(&task->result, &size))) {
+    perror(PROG ": open_memstream()");
+    exit(99);
+  }
+  /* every image writes the same output image file */
+  if(ctx->opt.output_file) ssocr_lock_imlib();
+  fprintf(out, "%s\t", task->name);
+  if(load_image(task->name, &ctx->opt, ctx->cmds, ctx->ncmds,
+                &image, &frame)) {
+    fprintf(out, "\t99\n");
+  } else {
+    status = ssocr_recognize(ctx, image, frame, task->name, &res);
+    fprintf(out, "%s\t%d\n", res.text, status);
+    free_frame(frame);
+  }
+  ssocr_unlock_imlib();
+  fclose(out);
+}
+
+/* process every image file given as argument and then every image file named
+ * in the file list (- is STDIN, one file name per line) with the same options
+ * and commands, print one line per image with file name, recognized digits,
+ * and exit code for the image (using opt->jobs worker threads in parallel,
+ * each with its own copy of the context), return the exit code for the batch */
+static int process_batch(ssocr_ctx_struct *ctx, char **files, int nfiles,
+                         const char *list)
+{
+  const options_struct *opt = &ctx->opt;
+  ssocr_result_struct res; /* digits recognized in an image */
+  ssocr_ctx_struct **ctxs = NULL; /* one context per worker thread */
+  FILE *stream = NULL;
+  Imlib_Image image; /* image loaded with Imlib2 */
+  frame_struct *frame; /* image decoded without Imlib2 */
+  char *line = NULL; /* line of file list, reused for every line */
+  size_t line_size = 0;
+  ssize_t len;
+  const char *imgfile;
+  char *name;
+  int i, status, ret = 0;
+  pool_struct *pool = NULL; /* worker threads */
+
+  if(list) {
+    if(strcmp("-", list) == 0) {
+      stream = stdin;
+    } else if(!(stream = fopen(list, "r"))) {
+      fprintf(stderr, "%s: error: could not open file list %s\n", PROG, list);
+      perror(PROG ": fopen()");
+      return 99;
+    }
+  }
+
+  if(opt->jobs > 1) {
+    if(!(ctxs = calloc(opt->jobs, sizeof(ssocr_ctx_struct *)))) {
+      perror(PROG ": ctxs = calloc()");
+      exit(99);
+    }
+    for(i = 0; i < opt->jobs; i++) {
+      ctxs[i] = ssocr_new_ctx(opt, ctx->cmds, ctx->ncmds);
+    }
+    pool = new_pool(opt->jobs, opt->jobs * JOB_WINDOW,
+                    !(opt->flags & UNORDERED_OUTPUT), batch_work, ctxs);
+    if(opt->flags & VERBOSE) {
+      fprintf(stderr, "processing images with %d worker threads\n",
+                      opt->jobs);
+    }
+  }
+
+  for(i = 0; ; ) {
+    if(i < nfiles) {
+      imgfile = files[i++];
+    } else if(stream && (len = getline(&line, &line_size, stream)) >= 0) {
+      /* one file name per line, empty lines are ignored */
+      while(len > 0 && (line[len-1] == '\n' || line[len-1] == '\r')) {
+        line[--len] = '\0';
+      }
+      if(len == 0) continue;
+      imgfile = line;
+    } else {
+      break;
+    }
+    if(pool) {
+      if(!(name = strdup(imgfile))) {
+        perror(PROG ": name = strdup()");
+        exit(99);
+      }
+      pool_submit(pool, name, NULL);
+      continue;
+    }
+    printf("%s\t", imgfile);
+    if(load_image(imgfile, opt, ctx->cmds, ctx->ncmds, &image, &frame)) {
+      printf("\t99\n");
+    } else {
+      status = ssocr_recognize(ctx, image, frame, imgfile, &res);
+      printf("%s\t%d\n", res.text, status);
+      free_frame(frame);
+    }
+    fflush(stdout);
+  }
+  free_pool(pool);
+  if(ctxs) {
+    for(i = 0; i < opt->jobs; i++) {
+      ssocr_free_ctx(ctxs[i]);
+    }
+    free(ctxs);
+  }
+  if(stream && ferror(stream)) {
+    fprintf(stderr, "%s: error: could not read file list %s\n", PROG, list);
+    ret = 99;
+  }
+  free(line);
+  if(stream && stream != stdin) fclose(stream);
+
+  return ret;
+}
 
-  int i, j, d;  /* iteration variables */
-  size_t cur_digit_mem, new_digit_mem; /* for overflow checks */
-  int unknown_digit=0; /* was one of the 6 found digits an unknown one? */
+/* parse the options of argv and collect them in opt, set file_list to the
+ * file naming the images of a batch, sock to the socket of the daemon, and
+ * stream_list to the file naming the streams of the multi-stream server
+ * (or NULL if not given), return 0 on success or the exit code for ssocr */
+static int parse_options(int argc, char **argv, options_struct *opt,
+                         char **file_list_ptr, char **sock_ptr,
+                         char **stream_list_ptr)
+{
+  char *file_list=NULL; /* file naming the images of a batch */
+  char *sock=NULL; /* socket of the daemon */
+  char *stream_list=NULL; /* file naming the streams to serve */
   int need_pixels = NEED_PIXELS; /* pixels needed to set segment in scanline */
+  int segment_fill = SEGMENT_FILL; /* percentage of segment area needed */
   int min_segment = MIN_SEGMENT; /* minimum pixels needed for a segment */
   dimensions_struct min_char_dims; /* minimum character dimensions (W x H) */
-  int potential_digits; /* number of potential digits after segmentation */
   interval_struct expected_digits; /* expect number of digits is inside this */
-  int number_of_digits; /* number of digits found and accepted */
   int ignore_pixels = IGNORE_PIXELS; /* pixels to ignore when checking column */
   int one_ratio = ONE_RATIO; /* height/width > one_ratio => digit 'one' */
   int minus_ratio = MINUS_RATIO; /* height/width > minus_ratio => char 'minus'*/
   int dec_h_ratio = DEC_H_RATIO; /* max_dig_h/h > dec_h_ratio => possibly '.' */
   int dec_w_ratio = DEC_W_RATIO; /* max_dig_w/w > dec_w_ratio => possibly '.' */
   double spc_fac = SPC_FAC; /* add spaces if digit distance > spc_fac*min_dst */
+  int jpeg_scale = JPEG_SCALE; /* decode MJPEG frames scaled by 1/jpeg_scale */
+  int jobs = JOBS; /* number of worker threads processing a batch */
+  int threads = THREADS; /* number of threads processing one image */
+  int backlog = STREAM_BACKLOG; /* frames of a stream waiting for a worker */
+  int queue_depth = PIPELINE_DEPTH; /* frames in the streaming pipeline */
+  int affinity[PIPELINE_STAGES] = {-1, -1, -1}; /* CPUs of pipeline stages */
+  int skip_tolerance = SKIP_TOLERANCE; /* pixels of an unchanged frame */
   double thresh=THRESHOLD;  /* border between light and dark */
-  int offset;  /* offset for shear */
-  double theta; /* rotation angle */
   char *output_file=NULL; /* write processed image to file */
   char *output_fmt=NULL; /* use this format */
   char *debug_image_file=NULL; /* ...to this file */
@@ -277,30 +788,15 @@ int main(int argc, char **argv)
   luminance_t lt=DEFAULT_LUM_FORMULA; /* luminance function */
   charset_t charset=DEFAULT_CHARSET; /* character set */
 
-  int w, h, lum;  /* width, height, pixel luminance */
-  int col=UNKNOWN;  /* is column dark or light? */
-  int row=UNKNOWN;  /* is row dark or light? */
-  int dig_w;  /* width of digit part of image */
-  int dig_h;  /* height of digit part of image */
-  int max_dig_h=0, max_dig_w=0; /* maximum height & width of digits found */
-  int widest_dig_is_one=0; /* set to one if the widest digit is a one */
-  Imlib_Color color; /* Imlib2 RGBA color structure */
-  /* state of search */
-  int state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
-  digit_struct *digits=NULL; /* position of digits in image */
-  int found_pixels=0; /* how many pixels are already found */
-  color_struct d_color = {0, 0, 0, 0}; /* drawing color */
-
   /* initialize structures */
   min_char_dims.w = MIN_CHAR_W;
   min_char_dims.h = MIN_CHAR_H;
   expected_digits.min = expected_digits.max = NUMBER_OF_DIGITS;
 
-  /* if we provided no arguments to the program exit */
-  if (argc < 2) {
-    usage(PROG, stderr);
-    exit(99);
-  }
+  /* the daemon parses the options of many requests, start anew every time */
+  set_fg_color(SSOCR_DEFAULT_FOREGROUND);
+  set_bg_color(SSOCR_DEFAULT_BACKGROUND);
+  optind = 0;
 
   /* parse command line */
   while (1) {
@@ -340,20 +836,39 @@ int main(int argc, char **argv)
       {"space-factor", 1, 0, 'A'}, /* relative distance to add spaces */
       {"space-average", 0, 0, 'G'}, /* avg instead of min dst for spaces */
       {"adapt-after-crop", 0, 0, 'F'}, /* don't adapt threshold before crop */
+      {"segment-fill", 1, 0, 'R'}, /* area based segment recognition */
+      {"components", 0, 0, 'K'}, /* segmentation by connected components */
+      {"stream", 0, 0, 'e'}, /* process a stream of PNM frames */
+      {"jpeg-scale", 1, 0, 'J'}, /* downscale MJPEG frames while decoding */
+      {"bilevel", 0, 0, 'B'}, /* image is black and white, do not adapt */
+      {"batch", 0, 0, 'U'}, /* process many images */
+      {"file-list", 1, 0, 'L'}, /* process images named in a file */
+      {"jobs", 1, 0, 'j'}, /* process images of a batch in parallel */
+      {"threads", 1, 0, 'y'}, /* process bands of an image in parallel */
+      {"unordered", 0, 0, 'u'}, /* print batch results when available */
+      {"serve", 1, 0, 'Q'}, /* answer requests as a daemon */
+      {"streams", 1, 0, 'E'}, /* read many streams concurrently */
+      {"backlog", 1, 0, 'w'}, /* frames of a stream waiting for a worker */
+      {"drop-oldest", 0, 0, 'x'}, /* drop frames of a stream falling behind */
+      {"shm-ring", 0, 0, 'k'}, /* read frames from shared memory */
+      {"queue-depth", 1, 0, 'z'}, /* frames in the streaming pipeline */
+      {"affinity", 1, 0, 'Z'}, /* CPUs of the streaming pipeline stages */
+      {"skip-unchanged", 1, 0, 'Y'}, /* repeat results of unchanged frames */
+      {"changes-only", 0, 0, OPT_CHANGES_ONLY}, /* print changed frames only */
       {0, 0, 0, 0} /* terminate long options */
     };
     c = getopt_long (argc, argv,
-                     "hVt:vaTn:N:i:d:r:m:M:o:O:D::pPf:b:Igl:SXCc:H:W:sA:GF",
+                     "hVt:vaTn:N:i:d:r:m:M:o:O:D::pPf:b:Igl:SXCc:H:W:sA:GFR:KeJ:BUL:j:uQ:E:w:xky:z:Z:Y:",
                      long_options, &option_index);
     if (c == -1) break; /* leaves while (1) loop */
     switch (c) {
       case 'h':
         usage(PROG,stdout);
-        exit (42);
+        return 42;
         break;
       case 'V':
         print_version(stdout);
-        exit (42);
+        return 42;
         break;
       case 'v':
         flags |= VERBOSE;
@@ -504,7 +1019,7 @@ int main(int argc, char **argv)
           } else {
             fprintf(stderr, "%s: error: unknown foreground color %s,"
                             " color must be black or white\n", PROG, optarg);
-            exit(99);
+            return 99;
           }
         }
         break;
@@ -519,7 +1034,7 @@ int main(int argc, char **argv)
           } else {
             fprintf(stderr, "%s: error: unknown background color %s,"
                             " color must be black or white\n", PROG, optarg);
-            exit(99);
+            return 99;
           }
         }
         break;
@@ -538,6 +1053,7 @@ int main(int argc, char **argv)
       case 'l':
         if(optarg) {
           lt = parse_lum(optarg);
+          if(lt == LUM_HELP) return 42;
           if(lt == LUM_PARSE_ERROR) {
             fprintf(stderr,
                     PROG ": warning: ignoring unknown luminance formula '%s'\n",
@@ -570,6 +1086,7 @@ int main(int argc, char **argv)
       case 'c':
         if(optarg) {
           charset = parse_charset(optarg);
+          if(charset == CS_HELP) return 42;
           if(charset == CS_PARSE_ERROR) {
             fprintf(stderr, PROG ": warning: ignoring unknown charset '%s'\n",
                     optarg);
@@ -631,9 +1148,203 @@ int main(int argc, char **argv)
                           flags & ADAPT_AFTER_CROP);
         }
         break;
+      case 'K':
+        flags |= COMPONENT_SEGMENTS;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & COMPONENT_SEGMENTS=%d\n",
+                          flags & COMPONENT_SEGMENTS);
+        }
+        break;
+      case 'e':
+        flags |= STREAM_FRAMES;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & STREAM_FRAMES=%d\n",
+                          flags & STREAM_FRAMES);
+        }
+        break;
+      case 'B':
+        flags |= BILEVEL_INPUT;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & BILEVEL_INPUT=%d\n",
+                          flags & BILEVEL_INPUT);
+        }
+        break;
+      case 'U':
+        flags |= BATCH_MODE;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & BATCH_MODE=%d\n", flags & BATCH_MODE);
+        }
+        break;
+      case 'L':
+        if(optarg) {
+          flags |= BATCH_MODE;
+          file_list = strdup(optarg);
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "file_list = %s\n", file_list);
+          }
+        }
+        break;
+      case 'j':
+        if(optarg) {
+          jobs = atoi(optarg);
+          if(jobs == 0) {
+            /* one worker thread per online processor */
+            jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+          }
+          if(jobs < 1) {
+            fprintf(stderr, PROG ": warning: ignoring --jobs=%s\n", optarg);
+            jobs = JOBS;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "jobs = %d\n", jobs);
+          }
+        }
+        break;
+      case 'y':
+        if(optarg) {
+          threads = atoi(optarg);
+          if(threads == 0) {
+            /* one thread per online processor */
+            threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+          }
+          if(threads < 1) {
+            fprintf(stderr, PROG ": warning: ignoring --threads=%s\n", optarg);
+            threads = THREADS;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "threads = %d\n", threads);
+          }
+        }
+        break;
+      case 'z':
+        if(optarg) {
+          queue_depth = atoi(optarg);
+          if(queue_depth < 1) {
+            fprintf(stderr, PROG ": warning: ignoring --queue-depth=%s\n",
+                            optarg);
+            queue_depth = PIPELINE_DEPTH;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "queue_depth = %d\n", queue_depth);
+          }
+        }
+        break;
+      case 'Z':
+        if(optarg) {
+          if(parse_affinity(optarg, affinity)) {
+            fprintf(stderr, PROG ": warning: ignoring --affinity=%s\n",
+                            optarg);
+            affinity[0] = affinity[1] = affinity[2] = -1;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "affinity = %d,%d,%d\n", affinity[0],
+                            affinity[1], affinity[2]);
+          }
+        }
+        break;
+      case 'Y':
+        if(optarg) {
+          if(parse_skip(optarg, &skip_tolerance)) {
+            fprintf(stderr, PROG ": warning: ignoring --skip-unchanged=%s\n",
+                            optarg);
+            skip_tolerance = SKIP_TOLERANCE;
+            flags &= ~SKIP_UNCHANGED;
+          } else {
+            flags |= SKIP_UNCHANGED;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "skip_tolerance = %d\n", skip_tolerance);
+            fprintf(stderr, "flags & SKIP_UNCHANGED=%d\n",
+                            flags & SKIP_UNCHANGED);
+          }
+        }
+        break;
+      case OPT_CHANGES_ONLY:
+        flags |= CHANGES_ONLY;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & CHANGES_ONLY=%d\n", flags & CHANGES_ONLY);
+        }
+        break;
+      case 'u':
+        flags |= UNORDERED_OUTPUT;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & UNORDERED_OUTPUT=%d\n",
+                          flags & UNORDERED_OUTPUT);
+        }
+        break;
+      case 'Q':
+        if(optarg) {
+          sock = optarg;
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "daemon socket = %s\n", sock);
+          }
+        }
+        break;
+      case 'E':
+        if(optarg) {
+          stream_list = optarg;
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "stream list = %s\n", stream_list);
+          }
+        }
+        break;
+      case 'w':
+        if(optarg) {
+          backlog = atoi(optarg);
+          if(backlog < 1) {
+            fprintf(stderr, PROG ": warning: ignoring --backlog=%s\n",
+                    optarg);
+            backlog = STREAM_BACKLOG;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "backlog = %d\n", backlog);
+          }
+        }
+        break;
+      case 'k':
+        flags |= SHM_RING_INPUT;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & SHM_RING_INPUT=%d\n",
+                          flags & SHM_RING_INPUT);
+        }
+        break;
+      case 'x':
+        flags |= DROP_OLDEST;
+        if(flags & DEBUG_OUTPUT) {
+          fprintf(stderr, "flags & DROP_OLDEST=%d\n", flags & DROP_OLDEST);
+        }
+        break;
+      case 'J':
+        if(optarg) {
+          jpeg_scale = atoi(optarg);
+          if(jpeg_scale != 1 && jpeg_scale != 2 && jpeg_scale != 4 &&
+             jpeg_scale != 8) {
+            fprintf(stderr, PROG ": warning: ignoring --jpeg-scale=%s\n",
+                    optarg);
+            jpeg_scale = JPEG_SCALE;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "jpeg_scale = %d\n", jpeg_scale);
+          }
+        }
+        break;
+      case 'R':
+        flags |= AREA_SEGMENTS;
+        if(optarg) {
+          segment_fill = atoi(optarg);
+          if(segment_fill < 1 || segment_fill > 100) {
+            fprintf(stderr, PROG ": warning: ignoring --segment-fill=%s\n",
+                    optarg);
+            segment_fill = SEGMENT_FILL;
+          }
+          if(flags & DEBUG_OUTPUT) {
+            fprintf(stderr, "segment_fill = %d\n", segment_fill);
+          }
+        }
+        break;
       case '?':  /* missing argument or character not in optstring */
         short_usage(PROG,stderr);
-        exit (2);
+        return 2;
         break;
       default:   /* this should not be reached */
         if((c>31) && (c<127)) {
@@ -644,7 +1355,7 @@ int main(int argc, char **argv)
                            " %X\n", PROG, c);
         }
         short_usage(PROG, stderr);
-        exit(99);
+        return 99;
     }
   }
   if((flags & ABSOLUTE_THRESHOLD) && (flags & DO_ITERATIVE_THRESHOLD))
@@ -668,7 +1379,19 @@ int main(int argc, char **argv)
     fprintf(stderr, "flags & PRINT_SPACES=%d\n", flags & PRINT_SPACES);
     fprintf(stderr, "flags & SPC_USE_AVG_DST=%d\n", flags & SPC_USE_AVG_DST);
     fprintf(stderr, "flags & ADAPT_AFTER_CROP=%d\n", flags & ADAPT_AFTER_CROP);
+    fprintf(stderr, "flags & AREA_SEGMENTS=%d\n", flags & AREA_SEGMENTS);
+    fprintf(stderr, "flags & COMPONENT_SEGMENTS=%d\n",
+                    flags & COMPONENT_SEGMENTS);
+    fprintf(stderr, "flags & STREAM_FRAMES=%d\n", flags & STREAM_FRAMES);
+    fprintf(stderr, "flags & BILEVEL_INPUT=%d\n", flags & BILEVEL_INPUT);
+    fprintf(stderr, "flags & BATCH_MODE=%d\n", flags & BATCH_MODE);
+    fprintf(stderr, "flags & UNORDERED_OUTPUT=%d\n", flags & UNORDERED_OUTPUT);
+    fprintf(stderr, "flags & DROP_OLDEST=%d\n", flags & DROP_OLDEST);
+    fprintf(stderr, "flags & SHM_RING_INPUT=%d\n", flags & SHM_RING_INPUT);
+    fprintf(stderr, "flags & SKIP_UNCHANGED=%d\n", flags & SKIP_UNCHANGED);
+    fprintf(stderr, "flags & CHANGES_ONLY=%d\n", flags & CHANGES_ONLY);
     fprintf(stderr, "need_pixels = %d\n", need_pixels);
+    fprintf(stderr, "segment_fill = %d\n", segment_fill);
     fprintf(stderr, "min_segment = %d\n", min_segment);
     fprintf(stderr, "min_char_dims = %dx%d\n",min_char_dims.w,min_char_dims.h);
     fprintf(stderr, "ignore_pixels = %d\n", ignore_pixels);
@@ -687,1139 +1410,441 @@ int main(int argc, char **argv)
     fprintf(stderr, "max_dig_h/h threshold for decimal = %d\n", dec_h_ratio);
     fprintf(stderr, "max_dig_w/w threshold for decimal = %d\n", dec_w_ratio);
     fprintf(stderr, "distance factor for adding spaces = %.2f\n", spc_fac);
+    fprintf(stderr, "MJPEG frames scaled by 1/%d\n", jpeg_scale);
+    fprintf(stderr, "worker threads for a batch = %d\n", jobs);
+    fprintf(stderr, "threads processing an image = %d\n", threads);
+    fprintf(stderr, "frames queued per stream = %d\n", backlog);
+    fprintf(stderr, "frames in the streaming pipeline = %d\n", queue_depth);
+    fprintf(stderr, "pixels differing in an unchanged frame = %d\n",
+                    skip_tolerance);
     fprintf(stderr, "optind=%d argc=%d\n", optind, argc);
     fprintf(stderr, "================================================================================\n");
   }
 
   /* if no argument left exit the program */
-  if(optind >= argc) {
+  if(optind >= argc && !file_list && !sock && !stream_list) {
     fprintf(stderr, "%s: error: no image filename given\n", PROG);
     short_usage(PROG, stderr);
-    exit(99);
+    return 99;
   }
-  if(flags & DEBUG_OUTPUT) {
+  if((flags & DEBUG_OUTPUT) && !(flags & BATCH_MODE) && !sock &&
+     !stream_list) {
     fprintf(stderr, "argv[argc-1]=%s used as image file name\n", argv[argc-1]);
   }
-
-  /* load the image */
-  imgfile = argv[argc-1];
-  if(strcmp("-", imgfile) == 0) /* read image from stdin? */ {
-    if(flags & VERBOSE)
-      fprintf(stderr, "using temporary file to hold data from stdin\n");
-    use_tmpfile = 1;
-    imgfile = tmp_imgfile(flags);
+  if((flags & BATCH_MODE) && (flags & (STREAM_FRAMES | SHM_RING_INPUT))) {
+    fprintf(stderr, "%s: warning: -e and -k have no effect in batch mode\n",
+                    PROG);
   }
-  if(flags & VERBOSE) {
-    fprintf(stderr, "loading image %s\n", imgfile);
+  if(!(flags & BATCH_MODE) && (flags & UNORDERED_OUTPUT)) {
+    fprintf(stderr, "%s: warning: -u has no effect without batch mode\n",
+                    PROG);
   }
-  image = imlib_load_image_with_error_return(imgfile, &load_error);
-  if(use_tmpfile) {
-    if(flags & VERBOSE)
-      fprintf(stderr, "removing temporary image file %s\n", imgfile);
-    unlink(imgfile);
-    free(imgfile);
-    imgfile = argv[argc-1];
+  if(!(flags & STREAM_FRAMES) && (queue_depth != PIPELINE_DEPTH ||
+     affinity[0] >= 0 || affinity[1] >= 0 || affinity[2] >= 0)) {
+    fprintf(stderr, "%s: warning: -z and -Z have no effect without -e\n",
+                    PROG);
   }
-  if(!image) {
-    fprintf(stderr, "%s: error: could not load image %s\n", PROG, imgfile);
-    report_imlib_error(load_error);
-    exit(99);
+  if(!(flags & SKIP_UNCHANGED) && (flags & CHANGES_ONLY)) {
+    fprintf(stderr, "%s: warning: --changes-only has no effect without -Y\n",
+                    PROG);
+    flags &= ~CHANGES_ONLY;
   }
+  if(!(flags & BATCH_MODE) && !stream_list && jobs > 1) {
+    fprintf(stderr, "%s: warning: -j has no effect without batch mode or"
+                    " --streams\n", PROG);
+  }
+
+  /* collect options, they are used for every image */
+  opt->thresh = thresh;
+  opt->flags = flags;
+  opt->lt = lt;
+  opt->charset = charset;
+  opt->need_pixels = need_pixels;
+  opt->segment_fill = segment_fill;
+  opt->min_segment = min_segment;
+  opt->min_char_dims = min_char_dims;
+  opt->expected_digits = expected_digits;
+  opt->ignore_pixels = ignore_pixels;
+  opt->one_ratio = one_ratio;
+  opt->minus_ratio = minus_ratio;
+  opt->dec_h_ratio = dec_h_ratio;
+  opt->dec_w_ratio = dec_w_ratio;
+  opt->spc_fac = spc_fac;
+  opt->jpeg_scale = jpeg_scale;
+  opt->jobs = jobs;
+  opt->threads = threads;
+  opt->backlog = backlog;
+  opt->queue_depth = queue_depth;
+  memcpy(opt->affinity, affinity, sizeof(affinity));
+  opt->skip_tolerance = skip_tolerance;
+  opt->output_file = output_file;
+  opt->output_fmt = output_fmt;
+  opt->debug_image_file = debug_image_file;
+  opt->foreground = ssocr_foreground;
+  opt->background = ssocr_background;
+  *file_list_ptr = file_list;
+  *sock_ptr = sock;
+  *stream_list_ptr = stream_list;
+
+  return 0;
+}
+
+/* free the strings allocated for options */
+static void free_options(options_struct *opt)
+{
+  free((char *) opt->output_file);
+  free((char *) opt->output_fmt);
+  free((char *) opt->debug_image_file);
+}
 
-  /* set the image we loaded as the current context image to work on */
-  imlib_context_set_image(image);
+/* process the image, stream, or batch of images named after the options,
+ * use the commands of ctx if not NULL or parse them from argv otherwise,
+ * return the exit code */
+static int run(int argc, char **argv, const options_struct *opt,
+               const char *file_list, ssocr_ctx_struct *ctx)
+{
+  Imlib_Image image=NULL; /* an image handle */
+  frame_struct *frame=NULL; /* image data used without Imlib2 */
+  char *imgfile=NULL; /* filename of image file */
+  command_struct *cmds=NULL; /* image processing commands */
+  ssocr_ctx_struct *own_ctx=NULL; /* context created for this run */
+  ssocr_result_struct res; /* recognized digits */
+  int ncmds; /* number of image processing commands */
+  int first_file; /* index of first image file in argv (batch mode) */
+  int status; /* exit code */
 
-  /* get image parameters */
-  w = imlib_image_get_width();
-  h = imlib_image_get_height();
-  if((flags & DEBUG_OUTPUT) || (flags & PRINT_INFO)) {
-    fprintf(stderr, "image width: %d\nimage height: %d\n",w,h);
+  /* process many images, the commands are followed by the image files */
+  if(opt->flags & BATCH_MODE) {
+    ncmds = ssocr_parse_commands(argv, optind, argc, &cmds, &first_file);
+    if(ncmds < 0) return 99;
+    if(opt->flags & DEBUG_OUTPUT) {
+      fprintf(stderr, "%d image file names given as arguments\n",
+                      argc - first_file);
+    }
+    own_ctx = ssocr_new_ctx(opt, cmds, ncmds);
+    free(cmds);
+    status = process_batch(own_ctx, argv + first_file, argc - first_file,
+                           file_list);
+    ssocr_free_ctx(own_ctx);
+    return status;
   }
 
-  /* get minimum and maximum "value" values */
-  if((flags & DEBUG_OUTPUT) || (flags & PRINT_INFO)) {
-    double min, max;
-    get_minmaxval(&image, lt, &min, &max);
-    fprintf(stderr, "%.2f <= lum <= %.2f (lum should be in [0,255])\n",
-                    min, max);
+  /* parse commands once, they are used for every image */
+  if(!ctx) {
+    ncmds = ssocr_parse_commands(argv, optind, argc-1, &cmds, NULL);
+    if(ncmds < 0) return 99;
+    ctx = own_ctx = ssocr_new_ctx(opt, cmds, ncmds);
+    free(cmds);
   }
+  /* a request of the daemon is not compared to earlier requests */
+  ctx->ref_valid = 0;
 
-  /* process commands */
-  if(flags & VERBOSE) /* then print found commands */ {
-    if(optind >= argc-1) {
-      fprintf(stderr, "no commands given, using image %s unmodified\n",
-                      imgfile);
+  if(opt->flags & SHM_RING_INPUT) {
+    /* process the frames of a shared memory ring */
+    status = process_shm(ctx, argv[argc-1]);
+  } else if(opt->flags & STREAM_FRAMES) {
+    /* process a stream of frames */
+    status = process_stream(ctx, argv[argc-1]);
+  } else {
+    /* load the image */
+    imgfile = argv[argc-1];
+    if(load_image(imgfile, opt, ctx->cmds, ctx->ncmds, &image, &frame)) {
+      status = 99;
     } else {
-      fprintf(stderr, "got commands");
-      for(i=optind; i<argc-1; i++) {
-        fprintf(stderr, " %s", argv[i]);
-        if(flags & DEBUG_OUTPUT) {
-          fprintf(stderr, " (argv[%d])", i);
-        }
-      }
-      fprintf(stderr, "\n");
-    }
-  }
-  if(optind < argc-1) /* then process commands */ {
-    for(i=optind; i<argc-1; i++) {
-      if(strcasecmp("dilation",argv[i]) == 0) {
-        int n=atoi(argv[i+1]);
-        if((n>0) && (i+1<argc-1)) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing dilation %d", n);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from string %s)", argv[i+1]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i++;
-        } else {
-          n = 1;
-          if(flags & VERBOSE) fputs(" processing dilation (1)\n", stderr);
-        }
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = dilation(&image, thresh, lt, n);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("erosion",argv[i]) == 0) {
-        int n=atoi(argv[i+1]);
-        if((n>0) && (i+1<argc-1)) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing erosion %d", n);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from string %s)", argv[i+1]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i++;
-        } else {
-          n = 1;
-          if(flags & VERBOSE) fputs(" processing erosion (1)\n", stderr);
-        }
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = erosion(&image, thresh, lt, n);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("opening",argv[i]) == 0) {
-        int n=atoi(argv[i+1]);
-        if((n>0) && (i+1<argc-1)) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing opening %d", n);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from string %s)", argv[i+1]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i++;
-        } else {
-          n = 1;
-          if(flags & VERBOSE) fputs(" processing opening (1)\n", stderr);
-        }
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = opening(&image, thresh, lt, n);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("closing",argv[i]) == 0) {
-        int n=atoi(argv[i+1]);
-        if((n>0) && (i+1<argc-1)) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing closing %d", n);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from string %s)", argv[i+1]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i++;
-        } else {
-          n = 1;
-          if(flags & VERBOSE) fputs(" processing closing (1)\n", stderr);
-        }
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = closing(&image, thresh, lt, n);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("remove_isolated",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing remove_isolated\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = remove_isolated(&image, thresh, lt);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("make_mono",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing make_mono\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = make_mono(&image, thresh, lt);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("white_border",argv[i]) == 0) {
-        int bdwidth=atoi(argv[i+1]);
-        if((bdwidth>0) && (i+1<argc-1)) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing white_border %d", bdwidth);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from string %s)", argv[i+1]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i++;
-        } else {
-          bdwidth = 1;
-          if(flags & VERBOSE)
-            fputs(" processing white_border (1)\n", stderr);
-        }
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = white_border(&image, bdwidth);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("shear",argv[i]) == 0) {
-        if(flags & VERBOSE) {
-          fprintf(stderr, " processing shear %d", atoi(argv[i+1]));
-          if(flags & DEBUG_OUTPUT) {
-            fprintf(stderr, " (from string %s)", argv[i+1]);
-          }
-          fprintf(stderr, "\n");
-        }
-        if(i+1<argc-1) {
-          offset = (int) atoi(argv[++i]); /* sideeffect: increment i */
-          thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = shear(&image, offset);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: shear command needs an argument\n", PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("set_pixels_filter",argv[i]) == 0) {
-        int mask;
-        if(flags & VERBOSE) {
-          fprintf(stderr," processing set_pixels_filter %d", atoi(argv[i+1]));
-          if(flags & DEBUG_OUTPUT) {
-            fprintf(stderr, " (from string %s)", argv[i+1]);
-          }
-          fprintf(stderr, "\n");
-        }
-        if(i+1<argc-1) {
-          mask = (int) atoi(argv[++i]); /* sideeffect: increment i */
-          thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = set_pixels_filter(&image, thresh, lt, mask);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: set_pixels_filter command needs an:"
-                          " argument\n", PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("keep_pixels_filter",argv[i]) == 0) {
-        int mask;
-        if(flags & VERBOSE) {
-          fprintf(stderr," processing keep_pixels_filter %d",atoi(argv[i+1]));
-          if(flags & DEBUG_OUTPUT) {
-            fprintf(stderr, " (from string %s)", argv[i+1]);
-          }
-          fprintf(stderr, "\n");
-        }
-        if(i+1<argc-1) {
-          mask = (int) atoi(argv[++i]); /* sideeffect: increment i */
-          thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = keep_pixels_filter(&image, thresh, lt, mask);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: keep_pixels_filter command needs an"
-                          " argument\n", PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("dynamic_threshold",argv[i]) == 0) {
-        if(i+2<argc-1) {
-          int ww, wh;
-          ww = atoi(argv[i+1]);
-          wh = atoi(argv[i+2]);
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing dynamic_threshold %d %d", ww, wh);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr," (from strings %s and %s)",argv[i+1],argv[i+2]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i+=2; /* skip the arguments to dynamic_threshold */
-          thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = dynamic_threshold(&image, thresh, lt, ww, wh);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: dynamic_threshold command needs two"
-                          " arguments\n", PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("rgb_threshold",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing rgb_threshold\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = make_mono(&image, thresh, MINIMUM);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("r_threshold",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing r_threshold\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = make_mono(&image, thresh, RED);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("g_threshold",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing g_threshold\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = make_mono(&image, thresh, GREEN);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("b_threshold",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing b_threshold\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = make_mono(&image, thresh, BLUE);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("invert",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing invert\n", stderr);
-        thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-        new_image = invert(&image, thresh, lt);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("gray_stretch",argv[i]) == 0) {
-        if(i+2<argc-1) {
-          double t1, t2;
-          t1 = atof(argv[i+1]);
-          t2 = atof(argv[i+2]);
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing gray_stretch %.2f %.2f", t1, t2);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr," (from strings %s and %s)",argv[i+1],argv[i+2]);
-            }
-            fprintf(stderr, "\n");
-          }
-          if(flags & ADJUST_GRAY) {
-            double min=-1.0, max=-1.0;
-            if(flags & VERBOSE) {
-              fprintf(stderr, " adjusting T1=%.2f and T2=%.2f to image\n",
-                              t1, t2);
-            }
-            get_minmaxval(&image, lt, &min, &max);
-            t1 = min + t1/100.0 * (max - min);
-            t2 = min + t2/100.0 * (max - min);
-            if(flags & VERBOSE) {
-              fprintf(stderr, " adjusted to T1=%.2f and T2=%.2f\n", t1, t2);
-            }
-          }
-          i+=2; /* skip the arguments to gray_stretch */
-          thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = gray_stretch(&image, t1, t2, lt);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: gray_stretch command needs two"
-                          " arguments\n", PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("grayscale",argv[i]) == 0) {
-        if(flags & VERBOSE) fputs(" processing grayscale\n", stderr);
-        new_image = grayscale(&image, lt);
-        imlib_context_set_image(image);
-        imlib_free_image();
-        image = new_image;
-      } else if(strcasecmp("crop",argv[i]) == 0) {
-        if(i+4<argc-1) {
-          int x, y, cw, ch; /* cw = crop width, ch = crop height */
-          x = atoi(argv[i+1]);
-          y = atoi(argv[i+2]);
-          cw = atoi(argv[i+3]);
-          ch = atoi(argv[i+4]);
-          if(flags & VERBOSE) {
-            fprintf(stderr,
-                    " cropping from (%d,%d) to (%d,%d) [width %d, height %d]",
-                    x, y, x+cw, y+ch, cw, ch);
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from strings %s, %s, %s, and %s)", argv[i+1],
-                      argv[i+2], argv[i+3], argv[i+4]);
-            }
-            fprintf(stderr, "\n");
-          }
-          i += 4; /* skip the arguments to crop */
-          if(!(flags & ADAPT_AFTER_CROP))
-            thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = crop(&image, x, y, cw, ch);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-          imlib_context_set_image(image);
-          /* get cropped image dimensions */
-          w = imlib_image_get_width();
-          h = imlib_image_get_height();
-          if((flags & DEBUG_OUTPUT) || (flags & VERBOSE)) {
-            fprintf(stderr, "  cropped image width: %d\n"
-                            "  cropped image height: %d\n", w, h);
-          }
-          /* get minimum and maximum "value" values in cropped image */
-          if((flags&DEBUG_OUTPUT) || (flags&PRINT_INFO) || (flags&VERBOSE)) {
-            double min, max;
-            get_minmaxval(&image, lt, &min, &max);
-            fprintf(stderr, "  %.2f <= lum <= %.2f in cropped image"
-                            " (lum should be in [0,255])\n", min, max);
-          }
-          /* adapt threshold to cropped image */
-          thresh = adapt_threshold(&image, thresh, lt, flags, UPDATE);
-        } else {
-          fprintf(stderr, "%s: error: crop command needs 4 arguments\n", PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("rotate",argv[i]) == 0) {
-        if(i+1<argc-1) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing rotate %f", atof(argv[i+1]));
-            if(flags & DEBUG_OUTPUT) {
-              fprintf(stderr, " (from string %s)", argv[i+1]);
-            }
-            fprintf(stderr, "\n");
-          }
-          theta = atof(argv[++i]); /* sideeffect: increment i */
-          thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
-          new_image = rotate(&image, theta);
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: rotate command needs an argument\n",
-                          PROG);
-          exit(99);
-        }
-      } else if(strcasecmp("mirror",argv[i]) == 0) {
-        if(i+1<argc-1) {
-          if(flags & VERBOSE) {
-            fprintf(stderr, " processing mirror %s\n", argv[i+1]);
-          }
-          if(strncasecmp("horiz",argv[i+1],5) == 0) {
-            new_image = mirror(&image, HORIZONTAL);
-          } else if(strncasecmp("vert",argv[i+1],4) == 0) {
-            new_image = mirror(&image, VERTICAL);
-          } else {
-            fprintf(stderr, "%s: error: argument to 'mirror' must be 'horiz'"
-                            " or 'vert'\n", PROG);
-            exit(99);
-          }
-          i++;
-          imlib_context_set_image(image);
-          imlib_free_image();
-          image = new_image;
-        } else {
-          fprintf(stderr, "%s: error: mirror command needs argument 'horiz'"
-                          " or 'vert'\n", PROG);
-          exit(99);
-        }
-      } else {
-        fprintf(stderr, " unknown command \"%s\"\n", argv[i]);
+      /* process the image */
+      status = ssocr_recognize(ctx, image, frame, imgfile, &res);
+      fputs(res.text, stdout);
+      if(status == 0 || status == 2) {
+        putchar('\n');
       }
+      free_frame(frame);
     }
   }
+  ssocr_free_ctx(own_ctx);
 
-  /* assure we are working with the current image */
-  imlib_context_set_image(image);
+  return status;
+}
 
-  /* write image to file if requested */
-  if(output_file) {
-    save_image("output", image, output_fmt, output_file, flags);
-  }
+/* hash of the arguments first to last-1 (FNV-1a) */
+static unsigned long int hash_args(char **argv, int first, int last)
+{
+  unsigned long int hash = 2166136261UL;
+  const char *p;
+  int i;
 
-  /* exit if only image processing shall be done */
-  if(flags & PROCESS_ONLY) exit(3);
+  for(i = first; i < last; i++) {
+    /* include the terminating NUL to separate the arguments */
+    p = argv[i];
+    do {
+      hash = (hash ^ (unsigned char) *p) * 16777619UL;
+    } while(*p++);
+  }
+  return hash;
+}
 
-  /* adapt threshold to image (unless this is already done) */
-  thresh = adapt_threshold(&image, thresh, lt, flags, INITIAL);
+/* free a plan of the daemon and mark its slot as unused */
+static void free_plan(plan_struct *plan)
+{
+  free_options(&plan->opt);
+  ssocr_free_ctx(plan->ctx);
+  free(plan->argv);
+  free(plan->args);
+  memset(plan, 0, sizeof(plan_struct));
+}
 
-  if(flags & USE_DEBUG_IMAGE) {
-    /* copy processed image to debug image */
-    debug_image = make_mono(&image, thresh, lt);
+/* the images of a batch or of single image requests are unrelated, unlike the
+ * frames of a stream, thus warn about and ignore -Y for them (a stream of
+ * --streams is checked by the options of its own line) */
+static void check_skip(options_struct *opt)
+{
+  if((opt->flags & SKIP_UNCHANGED) && ((opt->flags & BATCH_MODE) ||
+     !(opt->flags & (STREAM_FRAMES | SHM_RING_INPUT)))) {
+    fprintf(stderr, "%s: warning: -Y has no effect without -e, -k, or a"
+                    " stream of --streams\n", PROG);
+    opt->flags &= ~(SKIP_UNCHANGED | CHANGES_ONLY);
   }
+}
 
-  /* start image segmentation into possible characters / digits */
-  if (flags & DEBUG_OUTPUT) {
-    fputs("starting image segmentation\n", stderr);
-    fputs("starting horizontal partitioning\n", stderr);
-  }
+/* answer a request of the daemon like main() answers the same arguments,
+ * which are stored one after the other in one buffer, the options and
+ * commands are parsed once and kept for later requests with the same
+ * arguments except the image file, return the exit code */
+static int serve_request(int argc, char **argv)
+{
+  static plan_struct plans[PLAN_CACHE]; /* parsed requests */
+  static unsigned long int requests = 0; /* number of requests answered */
+  plan_struct *plan;
+  command_struct *cmds=NULL; /* image processing commands */
+  char *file_list=NULL; /* file naming the images of a batch */
+  char *sock=NULL; /* socket of the daemon */
+  char *stream_list=NULL; /* file naming the streams to serve */
+  unsigned long int hash;
+  size_t len, key_len;
+  int i, ncmds, status;
 
-  /* allocate memory for one seven segment digit */
-  if(!(digits = calloc(1, sizeof(digit_struct)))) {
-    perror(PROG ": digits = calloc()");
-    exit(99);
+  requests++;
+  if(argc < 2) {
+    usage(PROG, stderr);
+    return 99;
   }
 
-  /* horizontal partition */
-  state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
-  d = 0;
-  for(i=0; i<w; i++) {
-    /* check if column is completely light or not */
-    col = UNKNOWN;
-    found_pixels = 0;
-    for(j=0; j<h; j++) {
-      imlib_image_query_pixel(i, j, &color);
-      lum = get_lum(&color, lt);
-      if(is_pixel_set(lum, thresh)) /* dark */ {
-        found_pixels++;
-        if(found_pixels > ignore_pixels) {
-          /* 1 not ignored dark pixel darkens the whole column */
-          col = (ssocr_foreground == SSOCR_BLACK) ? DARK : LIGHT;
-        }
-      } else if(col == UNKNOWN) /* light */ {
-        col = (ssocr_foreground == SSOCR_BLACK) ? LIGHT : DARK;
-      }
-    }
-    /* save digit position and draw partition line for DEBUG */
-    if((state == ((ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT))
-        && (col == ((ssocr_foreground == SSOCR_BLACK) ? DARK : LIGHT))) {
-      /* beginning of digit */
-      if (flags & DEBUG_OUTPUT) {
-        fprintf(stderr, " start of potential digit %d in image column %d\n",
-                d, i);
-      }
-      digits[d].x1 = i;
-      digits[d].y1 = 0;
-      if(flags & USE_DEBUG_IMAGE) {
-        imlib_context_set_image(debug_image);
-        imlib_context_set_color(255,0,0,255);/* red line for start of digit */
-        imlib_image_draw_line(i,0,i,h-1,0);
-        imlib_context_set_image(image);
-      }
-      state = (ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK;
-    } else if((state ==
-              ((ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK))
-              && (col == ((ssocr_foreground == SSOCR_BLACK) ? LIGHT : DARK))){
-      /* end of digit */
-      if (flags & DEBUG_OUTPUT) {
-        fprintf(stderr, " end of potential digit %d in image column %d\n",d,i);
-      }
-      digits[d].x2 = i;
-      digits[d].y2 = h-1;
-      if((d >= INT_MAX - 1) || (d < 0)) {
-        fputs(PROG ": error: too many potential digits (integer overflow)\n",
+  /* look for a plan for the same options and commands */
+  hash = hash_args(argv, 1, argc-1);
+  key_len = argv[argc-1] - argv[1];
+  for(i = 0; i < PLAN_CACHE; i++) {
+    plan = plans + i;
+    if(plan->ctx && plan->hash == hash && plan->key_len == key_len &&
+       memcmp(plan->key, argv[1], key_len) == 0) {
+      plan->used = requests;
+      if(plan->opt.flags & VERBOSE) {
+        fputs("using options and commands parsed for an earlier request\n",
               stderr);
-        exit(99);
-      }
-      d++;
-      if(flags & USE_DEBUG_IMAGE) {
-        imlib_context_set_image(debug_image);
-        imlib_context_set_color(0,0,255,255); /* blue line for end of digit */
-        imlib_image_draw_line(i,0,i,h-1,0);
-        imlib_context_set_image(image);
-      }
-      /* add memory for another digit */
-      cur_digit_mem = d * sizeof(digit_struct);
-      new_digit_mem = (d+1) * sizeof(digit_struct);
-      if(new_digit_mem <= cur_digit_mem) {
-        fputs(PROG ": error: size_t overflow (memory for digits)\n", stderr);
-        exit(99);
-      }
-      if(!(digits = realloc(digits, new_digit_mem))) {
-        perror(PROG ": digits = realloc()");
-        exit(99);
       }
-      /* initialize additional memory */
-      memset(&digits[d], 0, sizeof(digit_struct));
-      state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
+      return run(argc, argv, &plan->opt, NULL, plan->ctx);
     }
   }
 
-  /* after the loop above the program should be in state FIND_DARK,
-   * i.e. after the last digit some light was found
-   * if it is still searching for light then end the digit at the border of the
-   * image */
-  if(state == (ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK) {
-    if (flags & DEBUG_OUTPUT) {
-      fprintf(stderr, " end of potential digit %d in image column %d\n",d,w-1);
-    }
-    digits[d].x2 = w-1;
-    digits[d].y2 = h-1;
-    d++;
-    state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
+  /* parse a copy of the arguments, replacing the least recently used plan */
+  plan = plans;
+  for(i = 1; i < PLAN_CACHE; i++) {
+    if(plans[i].used < plan->used) plan = plans + i;
   }
-
-  /* horizontal partitioning has found "d" potential characters / digits */
-  potential_digits = d;
-  if(flags & DEBUG_OUTPUT) {
-    fprintf(stderr, "horizontal partitioning found %d digit(s)\n",
-            potential_digits);
-  }
-
-  /* find upper and lower boundaries of every digit */
-  if (flags & DEBUG_OUTPUT) {
-    fputs("looking for upper and lower digit boundaries\n", stderr);
-  }
-  for(d=0; d<potential_digits; d++) {
-    int found_top=0;
-    state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
-    /* start from top of image and scan rows for dark pixel(s) */
-    for(j=0; j<h; j++) {
-      row = UNKNOWN;
-      found_pixels = 0;
-      /* is row dark or light? */
-      for(i=digits[d].x1; i<=digits[d].x2; i++) {
-        imlib_image_query_pixel(i,j, &color);
-        lum = get_lum(&color, lt);
-        if(is_pixel_set(lum, thresh)) /* dark */ {
-          found_pixels++;
-          if(found_pixels > ignore_pixels) {
-            /* 1 pixels darken row */
-            row = (ssocr_foreground == SSOCR_BLACK) ? DARK : LIGHT;
-          }
-        } else if(row == UNKNOWN) {
-          row = (ssocr_foreground == SSOCR_BLACK) ? LIGHT : DARK;
-        }
-      }
-      /* save position of digit and draw partition line for DEBUG */
-      if((state == ((ssocr_foreground == SSOCR_BLACK)?FIND_DARK:FIND_LIGHT))
-          && (row == ((ssocr_foreground == SSOCR_BLACK) ? DARK : LIGHT))) {
-        if(found_top) /* then we are searching for the bottom */ {
-          digits[d].y2 = j;
-          state = (ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK;
-          if(flags & USE_DEBUG_IMAGE) {
-            imlib_context_set_image(debug_image);
-            imlib_context_set_color(0,255,0,255); /* green line */
-            imlib_image_draw_line(digits[d].x1,digits[d].y2,
-                                  digits[d].x2,digits[d].y2,0);
-            imlib_context_set_image(image);
-          }
-        } else /* found the top line */ {
-          digits[d].y1 = j;
-          found_top = 1;
-          state = (ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK;
-          if(flags & USE_DEBUG_IMAGE) {
-            imlib_context_set_image(debug_image);
-            imlib_context_set_color(0,255,0,255); /* green line */
-            imlib_image_draw_line(digits[d].x1,digits[d].y1,
-                                  digits[d].x2,digits[d].y1,0);
-            imlib_context_set_image(image);
-          }
-        }
-      } else if((state ==
-          ((ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK)) &&
-          (row == ((ssocr_foreground == SSOCR_BLACK) ? LIGHT : DARK))) {
-        /* found_top has to be 1 because otherwise we were still looking for
-         * dark */
-        digits[d].y2 = j;
-        state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
-        if(flags & USE_DEBUG_IMAGE) {
-          imlib_context_set_image(debug_image);
-          imlib_context_set_color(0,255,0,255); /* green line */
-          imlib_image_draw_line(digits[d].x1,digits[d].y2,
-                                  digits[d].x2,digits[d].y2,0);
-          imlib_context_set_image(image);
-        }
-      }
-    }
-    /* if we are still looking for light, use the bottom */
-    if(state == ((ssocr_foreground == SSOCR_BLACK) ? FIND_LIGHT : FIND_DARK)){
-      digits[d].y2 = h-1;
-      state = (ssocr_foreground == SSOCR_BLACK) ? FIND_DARK : FIND_LIGHT;
-      if(flags & USE_DEBUG_IMAGE) {
-        imlib_context_set_image(debug_image);
-        imlib_context_set_color(0,255,0,255); /* green line */
-        imlib_image_draw_line(digits[d].x1,digits[d].y2,
-                              digits[d].x2,digits[d].y2,0);
-        imlib_context_set_image(image);
-      }
-    }
+  free_plan(plan);
+  len = argv[argc-1] + strlen(argv[argc-1]) + 1 - argv[0];
+  if(!(plan->args = malloc(len)) ||
+     !(plan->argv = calloc(argc + 1, sizeof(char *)))) {
+    perror(PROG ": plan = malloc()");
+    exit(99);
   }
-  if (flags & DEBUG_OUTPUT) {
-    fprintf(stderr, "image segmentation found %d potential digits\n",
-            potential_digits);
+  memcpy(plan->args, argv[0], len);
+  for(i = 0; i < argc; i++) {
+    plan->argv[i] = plan->args + (argv[i] - argv[0]);
   }
-
-  /* image has been segmented into potential digits, ignore too small ones */
-  if (min_char_dims.w > 1 || min_char_dims.h > 1) {
-    int digit_count = 0, pos;
-    digit_struct *tmp;
-    if (flags & DEBUG_OUTPUT) {
-      fputs("dropping too small potential digits\n", stderr);
-    }
-    /* count sufficiently large digits */
-    for (d = 0; d < potential_digits; d++) {
-      if (digits[d].x2 - digits[d].x1 >= min_char_dims.w &&
-          digits[d].y2 - digits[d].y1 >= min_char_dims.h) {
-        if (flags & DEBUG_OUTPUT) {
-          fprintf(stderr, " keeping sufficiently large digit %d\n", d);
-        }
-        digit_count += 1;
-      } else if (flags & DEBUG_OUTPUT) {
-        fprintf(stderr, " dropping too small potential digit %d\n", d);
-      }
-    }
-    if (flags & DEBUG_OUTPUT) {
-      fprintf(stderr, "keeping %d of %d potential digits\n", digit_count,
-              potential_digits);
-    }
-    /* at least one digit is required */
-    if (digit_count < 1) {
-      fputs(PROG ": error: no sufficiently large digits found\n", stderr);
-      exit(1);
-    }
-    /* ensure we do not try to keep more digits than we have found */
-    if(digit_count > potential_digits) {
-      fprintf(stderr,
-              PROG ": error: trying to keep more digits (%d) than found (%d)\n",
-              digit_count, potential_digits);
-      exit(99);
-    }
-    /* if potential digits are discarded, copy remaining ones to new memory */
-    if(digit_count < potential_digits) {
-      /* allocate memory for sufficiently large digits we want to keep */
-      if(!(tmp = calloc(digit_count, sizeof(digit_struct)))) {
-        perror(PROG ": tmp = calloc()");
-        exit(99);
-      }
-      /* keep only sufficiently large digits */
-      pos = 0;
-      for (d = 0; d < potential_digits; d++) {
-        if (digits[d].x2 - digits[d].x1 >= min_char_dims.w &&
-            digits[d].y2 - digits[d].y1 >= min_char_dims.h) {
-          if (pos >= digit_count) {
-            fputs(PROG ": error copying digit information", stderr);
-            exit(99);
-          }
-          memcpy(tmp + pos, digits + d, sizeof(digit_struct));
-          pos++;
-        }
-      }
-      free(digits);
-      digits = tmp;
-      potential_digits = digit_count;
-    }
+  plan->hash = hash;
+  plan->key = plan->args + (argv[1] - argv[0]);
+  plan->key_len = key_len;
+  status = parse_options(argc, plan->argv, &plan->opt, &file_list, &sock,
+                         &stream_list);
+  if(status == 0) check_skip(&plan->opt);
+  if(status == 0 && (sock || stream_list)) {
+    fprintf(stderr, "%s: error: --serve and --streams are not possible in a"
+                    " request\n", PROG);
+    status = 99;
   }
-
-  /* check if expected number of digits have been found */
-  if ((expected_digits.min > -1) &&
-      ((potential_digits < expected_digits.min) ||
-       (potential_digits > expected_digits.max))) {
-    if (expected_digits.min != expected_digits.max) {
-      fprintf(stderr,
-              PROG ": expected between %d and %d digits, but found %d\n",
-              expected_digits.min, expected_digits.max, potential_digits);
-    } else {
-      fprintf(stderr, PROG ": expected %d digit%s, but found %d\n",
-              expected_digits.min, expected_digits.min > 1 ? "s" : "",
-              potential_digits);
-    }
-    imlib_free_image_and_decache();
-    if(flags & USE_DEBUG_IMAGE) {
-      save_image("debug", debug_image, output_fmt,debug_image_file,flags);
-      imlib_context_set_image(debug_image);
-      imlib_free_image_and_decache();
+  /* a batch names the images after the commands, it is not kept */
+  if(status != 0 || (plan->opt.flags & BATCH_MODE)) {
+    if(status == 0) {
+      status = run(argc, plan->argv, &plan->opt, file_list, NULL);
     }
-    exit(1);
+    free(file_list);
+    free_plan(plan);
+    return status;
   }
-
-  /* continue to work with the accepted number of characters / digits */
-  number_of_digits = potential_digits;
-  if (flags & DEBUG_OUTPUT) {
-    fprintf(stderr, "image segmentation found %d digits\n", number_of_digits);
-  }
-
-  /* draw rectangles around accepted digits */
-  if(flags & USE_DEBUG_IMAGE) {
-    imlib_context_set_image(debug_image);
-    imlib_context_set_color(128,128,128,255); /* gray line */
-    for(d=0; d<number_of_digits; d++) {
-      imlib_image_draw_rectangle(digits[d].x1, digits[d].y1,
-          digits[d].x2-digits[d].x1, digits[d].y2-digits[d].y1);
-    }
-    imlib_context_set_image(image);
+  free(file_list);
+  ncmds = ssocr_parse_commands(plan->argv, optind, argc-1, &cmds, NULL);
+  if(ncmds < 0) {
+    free_plan(plan);
+    return 99;
   }
+  plan->ctx = ssocr_new_ctx(&plan->opt, cmds, ncmds);
+  free(cmds);
+  plan->used = requests;
 
-  /* determine size of digit part of the image */
-  dig_w = digits[number_of_digits-1].x2 - digits[0].x1;
-  dig_h = digits[number_of_digits-1].y2 - digits[0].y1;
-  if (flags & DEBUG_OUTPUT) {
-    fprintf(stderr, "total width of digit area is %d\n", dig_w);
-    fprintf(stderr, "total height of digit area is %d\n", dig_h);
-  }
+  return run(argc, plan->argv, &plan->opt, NULL, plan->ctx);
+}
 
-  /* determine maximum digit dimensions */
-  for(d=0; d<number_of_digits; d++) {
-    if(max_dig_w < digits[d].x2 - digits[d].x1)
-      max_dig_w = digits[d].x2 - digits[d].x1;
-    if(max_dig_h < digits[d].y2 - digits[d].y1)
-      max_dig_h = digits[d].y2 - digits[d].y1;
-  }
-  if(flags & DEBUG_OUTPUT)
-    fprintf(stderr, "digits are at most %d pixels wide and %d pixels high\n",
-                    max_dig_w, max_dig_h);
+/* read the streams named in a file, one stream per line given like a command
+ * line of ssocr without the program name, i.e., options and commands followed
+ * by the FIFO or socket, words are separated by white space, empty lines and
+ * lines starting with # are ignored, every stream uses its own options and
+ * commands, return the exit code */
+static int process_streams(const char *prog, const char *stream_list,
+                           const options_struct *opt)
+{
+  FILE *list;
+  plan_struct *plans = NULL; /* options and commands of every stream */
+  stream_struct *streams = NULL;
+  command_struct *cmds = NULL; /* image processing commands */
+  char *line = NULL, *word;
+  char *file_list = NULL, *sock = NULL, *nested = NULL;
+  size_t line_size = 0;
+  int nstreams = 0, size = 0, lineno = 0, argc, ncmds, i, status = 0;
+  plan_struct *plan;
 
-  /* debug: write digit info to stderr */
-  if(flags & DEBUG_OUTPUT) {
-    fprintf(stderr, "found %d digits\n", number_of_digits);
-    for(d=0; d<number_of_digits; d++) {
-      fprintf(stderr, "digit %d: (%d,%d) -> (%d,%d), width: %d (%5.2f%%) "
-                      "height: %d (%5.2f%%)\n",
-                      d,
-                      digits[d].x1, digits[d].y1, digits[d].x2, digits[d].y2,
-                      digits[d].x2 - digits[d].x1,
-                      ((digits[d].x2 - digits[d].x1) * 100.0) / dig_w,
-                      digits[d].y2 - digits[d].y1,
-                      ((digits[d].y2 - digits[d].y1) * 100.0) / dig_h
-             );
-      fprintf(stderr, "  height/width (int): ");
-      if(digits[d].x1 == digits[d].x2) {
-        fprintf(stderr, "NaN, max_dig_w/width (int): NaN, ");
-      } else {
-        fprintf(stderr, "%d, max_dig_w/width (int): %d, ",
-                       (digits[d].y2-digits[d].y1)/(digits[d].x2-digits[d].x1),
-                       max_dig_w / (digits[d].x2 - digits[d].x1)
-              );
-      }
-      fprintf(stderr, "max_dig_h/height (int): ");
-      if(digits[d].y1 == digits[d].y2) {
-        fprintf(stderr, "NaN\n");
-      } else {
-        fprintf(stderr, "%d\n",
-                        max_dig_h / (digits[d].y2 - digits[d].y1)
-               );
-      }
-    }
+  if(!(list = fopen(stream_list, "r"))) {
+    fprintf(stderr, "%s: error: could not open stream list %s\n", PROG,
+                    stream_list);
+    perror(PROG ": fopen()");
+    return 99;
   }
-
-  /* at this point the digit 1 can be identified, because it is smaller than
-   * the other digits */
-  if(flags & DEBUG_OUTPUT)
-    fputs("looking for digit 1\n",stderr);
-  for(d=0; d<number_of_digits; d++) {
-    /* skip digits too narrow for a segment */
-    if(digits[d].x2 - digits[d].x1 < min_segment) {
-      if(flags & DEBUG_OUTPUT)
-        fprintf(stderr, " skipping too narrow digit %d with width %d\n", d,
-                digits[d].x2 - digits[d].x1);
-      continue;
-    }
-    /* if width of digit is less than 1/one_ratio of its height it is a 1
-     * (the default 1/3 is arbitarily chosen -- normally seven segment
-     * displays use digits that are 2 times as high as wide) */
-    if((digits[d].y2-digits[d].y1+0.5)/(digits[d].x2-digits[d].x1) > one_ratio){
-      if(flags & DEBUG_OUTPUT) {
-        fprintf(stderr, " digit %d is a 1 (height/width = %d/%d = (int) %d)\n",
-               d, digits[d].y2 - digits[d].y1, digits[d].x2 - digits[d].x1,
-               (digits[d].y2 - digits[d].y1) / (digits[d].x2 - digits[d].x1));
+  while(status == 0 && getline(&line, &line_size, list) >= 0) {
+    lineno++;
+    word = line + strspn(line, " \t\r\n");
+    if(*word == '\0' || *word == '#') continue;
+    if(nstreams == size) {
+      size = size ? 2 * size : 16;
+      if(!(plans = realloc(plans, size * sizeof(plan_struct)))) {
+        perror(PROG ": plans = realloc()");
+        exit(99);
       }
-      digits[d].digit = D_ONE;
     }
-  }
-
-  /* identify a decimal point (or thousands separator) by relative size */
-  if(flags & DEBUG_OUTPUT)
-    fputs("looking for decimal points\n",stderr);
-  for(d=0; d<number_of_digits; d++) {
-    /* skip digits with zero width or height */
-    if((digits[d].x1 == digits[d].x2) || (digits[d].y1 == digits[d].y2)) {
-      if(flags & DEBUG_OUTPUT)
-        fprintf(stderr, " skipping digit %d with zero width or height\n", d);
-      continue;
+    /* the plan keeps the line, its words are the arguments */
+    plan = plans + nstreams++;
+    memset(plan, 0, sizeof(plan_struct));
+    plan->args = line;
+    line = NULL;
+    line_size = 0;
+    if(!(plan->argv = calloc(strlen(plan->args) / 2 + 3, sizeof(char *)))) {
+      perror(PROG ": argv = calloc()");
+      exit(99);
     }
-    /* if height of a digit is less than 1/5 of the maximum digit height,
-     * and its width is less than 1/2 of the maximum digit width (the widest
-     * digit might be a one), assume it is a decimal point */
-    if((digits[d].digit == D_UNKNOWN) &&
-       (max_dig_h / (digits[d].y2 - digits[d].y1) > dec_h_ratio) &&
-       (max_dig_w / (digits[d].x2 - digits[d].x1) > dec_w_ratio)) {
-      digits[d].digit = D_DECIMAL;
-      if(flags & DEBUG_OUTPUT)
-        fprintf(stderr, " digit %d is a decimal point\n", d);
+    plan->argv[0] = (char *) prog;
+    argc = 1;
+    for(word = strtok(plan->args, " \t\r\n"); word;
+        word = strtok(NULL, " \t\r\n")) {
+      plan->argv[argc++] = word;
     }
-  }
-
-  /* identify a minus sign */
-  if(flags & DEBUG_OUTPUT)
-    fputs("looking for minus signs\n",stderr);
-  for(d=0; d<number_of_digits; d++) {
-    /* skip digits too short for a segment */
-    if(digits[d].y2 - digits[d].y1 < min_segment) {
-      if(flags & DEBUG_OUTPUT)
-        fprintf(stderr, " skipping too short digit %d with height %d\n", d,
-                digits[d].y2 - digits[d].y1);
-      continue;
+    status = parse_options(argc, plan->argv, &plan->opt, &file_list, &sock,
+                           &nested);
+    if(status == 0 && ((plan->opt.flags & BATCH_MODE) || sock || nested)) {
+      fprintf(stderr, "%s: error: batch mode, --serve, and --streams are not"
+                      " possible for a stream\n", PROG);
+      status = 99;
     }
-    /* if height of digit is less than 1/minus_ratio of its height it is a 1
-     * (the default 1/3 is arbitarily chosen -- normally seven segment
-     * displays use digits that are 2 times as high as wide) */
-    if((digits[d].digit == D_UNKNOWN) &&
-       ((digits[d].x2-digits[d].x1)/(digits[d].y2-digits[d].y1)>=minus_ratio)) {
-      if(flags & DEBUG_OUTPUT) {
-        fprintf(stderr,
-               " digit %d is a minus (width/height = %d/%d = (int) %d)\n",
-               d, digits[d].x2 - digits[d].x1, digits[d].y2 - digits[d].y1,
-               (digits[d].x2 - digits[d].x1) / (digits[d].y2 - digits[d].y1));
+    free(file_list);
+    file_list = NULL;
+    if(status == 0) {
+      ncmds = ssocr_parse_commands(plan->argv, optind, argc-1, &cmds, NULL);
+      if(ncmds < 0) {
+        status = 99;
+      } else {
+        plan->ctx = ssocr_new_ctx(&plan->opt, cmds, ncmds);
+        free(cmds);
       }
-      digits[d].digit = D_MINUS;
-    }
-  }
-
-  /* If the widest digit is a one, decimal points may be of the same width,
-   * and may thus not be detected.  Now that minus signs have been selected,
-   * if the widest digit still is a one (i.e., no minus signs), then decimal
-   * separators may also be recognized by checking only the height, not the
-   * width. */
-  if(flags & DEBUG_OUTPUT)
-    fputs("checking for special case of a one as widest character\n",stderr);
-  /* check if the widest digit is a one */
-  for(d=0; d<number_of_digits; d++) {
-    /* skip digits with zero width or height */
-    if((digits[d].x1 == digits[d].x2) || (digits[d].y1 == digits[d].y2)) {
-      if(flags & DEBUG_OUTPUT)
-        fprintf(stderr, " skipping digit %d with zero width or height\n", d);
-      continue;
     }
-    if((digits[d].digit == D_ONE) && (digits[d].x2-digits[d].x1 >= max_dig_w)) {
-      widest_dig_is_one = 1;
-      if(flags & DEBUG_OUTPUT)
-        fputs(" widest digit is a one -> additional decimal point search\n",
-              stderr);
-      break;
+    if(status != 0) {
+      fprintf(stderr, "%s: error: invalid stream in line %d of %s\n", PROG,
+                      lineno, stream_list);
     }
   }
-  if(!widest_dig_is_one) {
-    if(flags & DEBUG_OUTPUT)
-      fputs(" widest digit is not a one, skipping extra decimal point search\n",
-            stderr);
-  } else {
-    /* widest digit is a one, thus decimal seperators may have been missed:
-     * identify a decimal point (or thousands separator) by relative height */
-    if(flags & DEBUG_OUTPUT)
-      fputs("looking for decimal points again\n",stderr);
-    for(d=0; d<number_of_digits; d++) {
-      /* skip digits with zero width or height */
-      if((digits[d].x1 == digits[d].x2) || (digits[d].y1 == digits[d].y2)) {
-        if(flags & DEBUG_OUTPUT)
-          fprintf(stderr, " skipping digit %d with zero width or height\n", d);
-        continue;
-      }
-      /* if height of a digit is less than 1/5 of the maximum digit height,
-       * and its width is less than 1/2 of the maximum digit width (the widest
-       * digit might be a one), assume it is a decimal point */
-      if((digits[d].digit == D_UNKNOWN) &&
-         (max_dig_h / (digits[d].y2 - digits[d].y1) > dec_h_ratio)) {
-        digits[d].digit = D_DECIMAL;
-        if(flags & DEBUG_OUTPUT)
-          fprintf(stderr, " digit %d is a decimal point\n", d);
-      }
-    }
+  if(ferror(list)) {
+    fprintf(stderr, "%s: error: could not read stream list %s\n", PROG,
+                    stream_list);
+    status = 99;
+  }
+  free(line);
+  fclose(list);
+  if(status == 0 && nstreams == 0) {
+    fprintf(stderr, "%s: error: no stream given in %s\n", PROG, stream_list);
+    status = 99;
   }
 
-  /* now the digits are located and they have to be identified */
-  if(flags & DEBUG_OUTPUT)
-    fputs("starting scanline based recognition for remaining digits\n", stderr);
-  /* iterate over digits */
-  for(d=0; d<number_of_digits; d++) {
-    int d_height=0; /* height of digit */
-    /* skip digits too small to contain a segment */
-    if((digits[d].x2 - digits[d].x1 < min_segment) ||
-       (digits[d].y2 - digits[d].y1 < min_segment)) {
-      if(flags & DEBUG_OUTPUT)
-        fprintf(stderr, " skipping digit %d smaller than minimum segment\n", d);
-      continue;
+  if(status == 0) {
+    if(!(streams = calloc(nstreams, sizeof(stream_struct)))) {
+      perror(PROG ": streams = calloc()");
+      exit(99);
     }
-    /* skip already recognized digits */
-    if(digits[d].digit == D_UNKNOWN) {
-      int middle = (digits[d].x1 + digits[d].x2) / 2;
-      int quarter = digits[d].y1 + (digits[d].y2 - digits[d].y1) / 4;
-      int three_quarters = digits[d].y1 + 3 * (digits[d].y2 - digits[d].y1) / 4;
-      found_pixels=0; /* how many pixels are already found */
-      d_height = digits[d].y2 - digits[d].y1;
-      /* check horizontal segments (vertical scan, x == middle) */
-      d_color.R = d_color.A = 255;
-      d_color.G = d_color.B = 0;
-      found_pixels = scanline(&debug_image, middle, digits[d].y1,
-                              d_height/3, VERTICAL, d_color, thresh, lt, flags);
-      if(found_pixels >= need_pixels) {
-        digits[d].digit |= HORIZ_UP; /* add upper segment */
-      }
-      d_color.G = d_color.A = 255;
-      d_color.R = d_color.B = 0;
-      found_pixels = scanline(&debug_image, middle,
-                              digits[d].y1 + d_height/3, d_height/3, VERTICAL,
-                              d_color, thresh, lt, flags);
-      if(found_pixels >= need_pixels) {
-        digits[d].digit |= HORIZ_MID; /* add middle segment */
-      }
-      d_color.B = d_color.A = 255;
-      d_color.R = d_color.G = 0;
-      found_pixels = scanline(&debug_image, middle,
-                              digits[d].y1 + 2*d_height/3, d_height/3, VERTICAL,
-                              d_color, thresh, lt, flags);
-      if(found_pixels >= need_pixels) {
-        digits[d].digit |= HORIZ_DOWN; /* add lower segment */
-      }
-      /* check upper vertical segments (horizontal scan, y == quarter) */
-      d_color.R = d_color.A = 255;
-      d_color.G = d_color.B = 0;
-      found_pixels = scanline(&debug_image, digits[d].x1, quarter,
-                              (digits[d].x2 - digits[d].x1) / 2, HORIZONTAL,
-                              d_color, thresh, lt, flags);
-      if (found_pixels >= need_pixels) {
-        digits[d].digit |= VERT_LEFT_UP; /* add upper left segment */
-      }
-      d_color.G = d_color.A = 255;
-      d_color.R = d_color.B = 0;
-      found_pixels = scanline(&debug_image,
-                              (digits[d].x1 + digits[d].x2) / 2 + 1,
-                              quarter, (digits[d].x2 - digits[d].x1) / 2 - 1,
-                              HORIZONTAL, d_color, thresh, lt, flags);
-      if (found_pixels >= need_pixels) {
-        digits[d].digit |= VERT_RIGHT_UP; /* add upper right segment */
-      }
-      /* check lower vertical segments (horizontal scan, y == three_quarters) */
-      d_color.R = d_color.A = 255;
-      d_color.G = d_color.B = 0;
-      found_pixels = scanline(&debug_image, digits[d].x1,
-                              three_quarters, (digits[d].x2 - digits[d].x1) / 2,
-                              HORIZONTAL, d_color, thresh, lt, flags);
-      if (found_pixels >= need_pixels) {
-        digits[d].digit |= VERT_LEFT_DOWN; /* add lower left segment */
-      }
-      d_color.G = d_color.A = 255;
-      d_color.R = d_color.B = 0;
-      found_pixels = scanline(&debug_image,
-                              (digits[d].x1 + digits[d].x2) / 2 + 1,
-                              three_quarters, (digits[d].x2-digits[d].x1)/2 - 1,
-                              HORIZONTAL, d_color, thresh, lt, flags);
-      if (found_pixels >= need_pixels) {
-        digits[d].digit |= VERT_RIGHT_DOWN; /* add lower right segment */
-      }
+    for(i = 0; i < nstreams; i++) {
+      /* the stream is the last word of the line */
+      for(argc = 1; plans[i].argv[argc]; argc++);
+      streams[i].name = plans[i].argv[argc-1];
+      streams[i].ctx = plans[i].ctx;
     }
+    status = serve_streams(streams, nstreams, opt->jobs, opt->flags);
+    free(streams);
+  }
+  for(i = 0; i < nstreams; i++) {
+    free_plan(plans + i);
   }
+  free(plans);
 
-  /* check spacing of digits when --print-spaces is given and there are more
-   * more than two digits
-  */
-  if ((flags & PRINT_SPACES) && (number_of_digits > 2)) {
-    int min_dst, avg_dst, dst_sum, cur_dst, base_dst, num_spc;
-    if (flags & DEBUG_OUTPUT) {
-      fputs("looking for white space\n", stderr);
-    }
+  return status;
+}
 
-    /* determine distance between digits */
-    min_dst = dst_sum = digits[1].x2 - digits[0].x2;
-    if (flags & DEBUG_OUTPUT) {
-      fprintf(stderr, " distance between digits 0 and 1 is %d\n", min_dst);
-    }
-    for (i = 2; i < number_of_digits; i++) {
-      cur_dst = digits[i].x2 - digits[i-1].x2;
-      if (flags & DEBUG_OUTPUT) {
-        fprintf(stderr, " distance between digits %d and %d is %d\n",
-                       i-1, i, cur_dst);
-      }
-      if (cur_dst < min_dst) {
-        min_dst = cur_dst;
-      }
-      dst_sum += cur_dst;
-    }
-    avg_dst = dst_sum / (number_of_digits - 1);
-    base_dst = (flags & SPC_USE_AVG_DST) ? avg_dst : min_dst;
-    if (base_dst < 1) {
-      base_dst = 1;
-    }
-    if (flags & DEBUG_OUTPUT) {
-      fprintf(stderr, " minimum digit distance: %d\n", min_dst);
-      fprintf(stderr, " average digit distance: %d\n", avg_dst);
-      fprintf(stderr, " adding spaces for distance greater than: %d\n",
-                      (int) (spc_fac * base_dst));
-    }
+/*** main() ***/
 
-    /* determine number of spaces after each digit */
-    for (i = 0; i < (number_of_digits - 1); i++) {
-      num_spc = (int) ((digits[i+1].x2 - digits[i].x2) / (spc_fac * base_dst));
-      if (num_spc > 0) {
-        if (flags & DEBUG_OUTPUT) {
-          fprintf(stderr, " adding %d space character(s) after digit %d\n",
-                          num_spc, i);
-        }
-        digits[i].spaces = num_spc;
-      }
-    }
-  }
+int main(int argc, char **argv)
+{
+  options_struct opt; /* options used to process every image */
+  char *file_list=NULL; /* file naming the images of a batch */
+  char *sock=NULL; /* socket of the daemon */
+  char *stream_list=NULL; /* file naming the streams to serve */
+  int status; /* exit code */
 
-  /* print found segments as ASCII art if debug output is enabled
-   * or ASCII art output is requested explicitely
-   * example digits known by ssocr:
-   *   _      _  _       _   _  _   _   _   _
-   *  | |  |  _| _| |_| |_  |_   | | | |_| |_|
-   *  |_|  | |_  _|   |  _| |_|  |   | |_|  _|
-  */
-  if(flags & (DEBUG_OUTPUT | ASCII_ART_SEGMENTS)) {
-    fputs("Display as seen by ssocr:\n", stderr);
-    /* top row */
-    for(i=0; i<number_of_digits; i++) {
-      fputc(' ', stderr);
-      fputc(' ', stderr);
-      digits[i].digit & HORIZ_UP ? fputc('_', stderr) : fputc(' ', stderr);
-      fputc(' ', stderr);
-      print_spaces(stderr, digits[i].spaces * 3);
-    }
-    fputc('\n', stderr);
-    /* middle row */
-    for(i=0; i<number_of_digits; i++) {
-      fputc(' ', stderr);
-      digits[i].digit & VERT_LEFT_UP ? fputc('|', stderr) : fputc(' ', stderr);
-      digits[i].digit & HORIZ_MID ? fputc('_', stderr) :
-        digits[i].digit == D_MINUS ? fputc('_', stderr) : fputc(' ', stderr);
-      digits[i].digit & VERT_RIGHT_UP ? fputc('|', stderr) : fputc(' ', stderr);
-      print_spaces(stderr, digits[i].spaces * 3);
-    }
-    fputc('\n', stderr);
-    /* bottom row */
-    for(i=0; i<number_of_digits; i++) {
-      fputc(' ', stderr);
-      digits[i].digit&VERT_LEFT_DOWN ? fputc('|', stderr) : fputc(' ', stderr);
-      digits[i].digit&HORIZ_DOWN ? fputc('_', stderr) : 
-        digits[i].digit == D_DECIMAL ? fputc('.', stderr) : fputc(' ', stderr);
-      digits[i].digit&VERT_RIGHT_DOWN ? fputc('|', stderr) : fputc(' ', stderr);
-      print_spaces(stderr, digits[i].spaces * 3);
+  /* let a daemon answer, the output is the same */
+  if(argc > 1 && (strcmp(argv[1], "--client") == 0 ||
+                  strcmp(argv[1], "-q") == 0)) {
+    if(argc < 3) {
+      fprintf(stderr, "%s: error: %s needs the socket of the daemon\n", PROG,
+                      argv[1]);
+      short_usage(PROG, stderr);
+      exit(99);
     }
-    fputs("\n\n", stderr);
+    /* send argv without --client SOCKET */
+    sock = argv[2];
+    argv[2] = argv[0];
+    exit(client(sock, argc - 2, argv + 2));
   }
 
-  /* print digits */
-  if(flags & PRINT_AS_HEX) {
-    for(i=0; i<number_of_digits; i++) {
-      if(i > 0) putchar(':');
-      printf("%02x", digits[i].digit);
-      print_spaces(stdout, digits[i].spaces);
-    }
-  } else {
-    init_charset(charset);
-    for(i=0; i<number_of_digits; i++) {
-      unknown_digit += print_digit(digits[i].digit, flags);
-      print_spaces(stdout, digits[i].spaces);
-    }
+  /* if we provided no arguments to the program exit */
+  if (argc < 2) {
+    usage(PROG, stderr);
+    exit(99);
   }
-  putchar('\n');
 
-  /* clean up... */
-  imlib_free_image_and_decache();
-  if(flags & USE_DEBUG_IMAGE) {
-    save_image("debug", debug_image, output_fmt, debug_image_file, flags);
-    imlib_context_set_image(debug_image);
-    imlib_free_image_and_decache();
+  status = parse_options(argc, argv, &opt, &file_list, &sock, &stream_list);
+  if(status != 0) exit(status);
+  check_skip(&opt);
+
+  /* answer requests of clients as a daemon */
+  if(sock) {
+    exit(serve(sock, opt.flags, serve_request));
   }
 
-  /* determin error code */
-  if(unknown_digit) {
-    exit(2);
-  } else {
-    exit(0);
+  /* read many streams concurrently */
+  if(stream_list) {
+    exit(process_streams(argv[0], stream_list, &opt));
   }
+
+  exit(run(argc, argv, &opt, file_list, NULL));
 }
@@ -35,4 +35,59 @@ typedef struct {
   int min, max;
 } interval_struct;
 
+/* an image processing command parsed from the command line */
+typedef struct {
+  cmd_t cmd;          /* command */
+  const char *name;   /* name of command */
+  char **argv;        /* command and its arguments as given */
+  int argi;           /* index of command in argv of main() */
+  int nargs;          /* number of arguments given */
+  int n[4];           /* integer arguments */
+  double t[2];        /* floating point arguments */
+} command_struct;
+
+/* options used to process every image */
+typedef struct {
+  double thresh;
+  unsigned int flags;
+  luminance_t lt;
+  charset_t charset;
+  int need_pixels;
+  int segment_fill;
+  int min_segment;
+  dimensions_struct min_char_dims;
+  interval_struct expected_digits;
+  int ignore_pixels;
+  int one_ratio;
+  int minus_ratio;
+  int dec_h_ratio;
+  int dec_w_ratio;
+  double spc_fac;
+  int jpeg_scale;
+  int jobs;
+  int threads;
+  int backlog;
+  int queue_depth;
+  int affinity[PIPELINE_STAGES];
+  int skip_tolerance;
+  int foreground;
+  int background;
+  const char *output_file;
+  const char *output_fmt;
+  const char *debug_image_file;
+} options_struct;
+
+/* options and commands parsed for a request of the daemon, kept for later
+ * requests with the same arguments except the image file */
+typedef struct {
+  unsigned long int hash;     /* hash of the arguments but first and last */
+  char *args;                 /* copy of the NUL terminated arguments */
+  const char *key;            /* the arguments but the first and the last */
+  size_t key_len;             /* length of key */
+  char **argv;                /* pointers into args, permuted by getopt */
+  options_struct opt;         /* parsed options */
+  struct ssocr_ctx_s *ctx;    /* parsed commands and state of recognition */
+  unsigned long int used;     /* number of the request using it last */
+} plan_struct;
+
 #endif /* SSOCR2_H */
@@ -0,0 +1,420 @@
+/* Seven Segment Optical Character Recognition Multi-Stream Server */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <errno.h>          /* errno, EINTR, EAGAIN */
+#include <stdint.h>         /* uint64_t */
+#include <stdio.h>          /* fprintf, fputs, fflush, perror */
+#include <stdlib.h>         /* malloc, calloc, realloc, free, exit */
+#include <string.h>         /* memcpy, memmove, memset, strlen */
+
+/* file descriptors and events */
+#include <fcntl.h>          /* open, fcntl, O_RDONLY, O_NONBLOCK */
+#ifdef __linux__
+#include <sys/epoll.h>      /* epoll_create1, epoll_ctl, epoll_wait */
+#include <sys/eventfd.h>    /* eventfd */
+#endif
+#include <sys/socket.h>     /* socket, connect */
+#include <sys/stat.h>       /* stat, S_ISSOCK */
+#include <sys/un.h>         /* struct sockaddr_un */
+#include <unistd.h>         /* read, write, close */
+
+/* threads */
+#include <pthread.h>        /* pthread_mutex_* */
+
+/* my headers */
+#include "defines.h"        /* PROG, VERBOSE, DROP_OLDEST, STREAM_* */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "pnm.h"            /* PNM framing */
+#include "pool.h"           /* worker threads */
+#include "libssocr.h"       /* recognition */
+#include "streams.h"        /* multi-stream server */
+
+#ifdef __linux__
+/* streams with a recognized frame, filled by the workers and emptied by the
+ * thread reading the streams, which is woken up by the eventfd */
+typedef struct stream_done_s {
+  pthread_mutex_t lock;       /* protects list */
+  stream_struct *list;        /* streams with a recognized frame */
+  int evfd;                   /* eventfd signaling a recognized frame */
+} stream_done_struct;
+
+/* functions */
+
+/* open a FIFO for reading or connect to a Unix domain stream socket, both
+ * without blocking, return the file descriptor or -1 on error */
+static int open_stream(const char *name)
+{
+  struct sockaddr_un addr;
+  struct stat st;
+  size_t len = strlen(name);
+  int fd;
+
+  if(stat(name, &st) < 0) {
+    fprintf(stderr, "%s: error: could not open stream %s\n", PROG, name);
+    perror(PROG ": stat()");
+    return -1;
+  }
+  if(!S_ISSOCK(st.st_mode)) {
+    if((fd = open(name, O_RDONLY | O_NONBLOCK)) < 0) {
+      fprintf(stderr, "%s: error: could not open stream %s\n", PROG, name);
+      perror(PROG ": open()");
+    }
+    return fd;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if(len >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "%s: error: socket path %s is too long\n", PROG, name);
+    return -1;
+  }
+  memcpy(addr.sun_path, name, len + 1);
+  if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+     connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+     fcntl(fd, F_SETFL, O_NONBLOCK) < 0) {
+    fprintf(stderr, "%s: error: could not connect to stream %s\n", PROG,
+                    name);
+    perror(PROG ": connect()");
+    if(fd >= 0) close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/* recognize the current frame of a stream in a worker thread, the output
+ * line is printed by the thread reading the streams */
+static void stream_work(pool_task_struct *task, const void *arg, int worker)
+{
+  stream_struct *s = task->data;
+  stream_done_struct *done = s->done;
+  ssocr_result_struct res; /* digits recognized in the frame */
+  FILE *out; /* output line of this frame */
+  size_t size;
+  uint64_t one = 1;
+  int status;
+
+  (void) arg;
+  (void) worker;
+  if(!(out = open_memstream(&s->line, &size))) {
+    perror(PROG ": open_memstream()");
+    exit(99);
+  }
+  status = ssocr_recognize(s->ctx, NULL, s->current.frame, s->name, &res);
+  /* with --changes-only the line of an unchanged frame stays empty */
+  if(!res.unchanged || !(s->ctx->opt.flags & CHANGES_ONLY)) {
+    fprintf(out, "%s\t%lu\t%s\t%d\n", s->name, s->current.index, res.text,
+                 status);
+  }
+  fclose(out);
+
+  pthread_mutex_lock(&done->lock);
+  s->next_done = done->list;
+  done->list = s;
+  pthread_mutex_unlock(&done->lock);
+  if(write(done->evfd, &one, sizeof(one)) < 0) {
+    perror(PROG ": write(eventfd)");
+  }
+}
+
+/* stop reading a stream, e.g., at its end */
+static void close_stream(stream_struct *s)
+{
+  if(s->fd < 0) return;
+  /* closing removes the descriptor from the epoll instance */
+  close(s->fd);
+  s->fd = -1;
+  s->paused = 0;
+}
+
+/* move the complete frames read from a stream into its queue, dropping the
+ * oldest queued frames or leaving frames in the buffer if the queue is full */
+static void queue_frames(stream_struct *s, unsigned int flags)
+{
+  const options_struct *opt = &s->ctx->opt;
+  stream_frame_struct *f;
+  unsigned char *copy;
+  size_t off = 0, start;
+  long n;
+
+  while(s->len > off) {
+    if((n = pnm_frame_length(s->buf + off, s->len - off, &start)) == 0) {
+      /* only white space left or an incomplete frame */
+      if(start == s->len - off) off = s->len;
+      break;
+    }
+    if(n < 0) {
+      fprintf(stderr, "%s: error: unsupported data in stream %s after frame"
+                      " %lu\n", PROG, s->name, s->frames);
+      s->failed = 1;
+      close_stream(s);
+      off = s->len;
+      break;
+    }
+    if(s->count == opt->backlog) {
+      if(!(opt->flags & DROP_OLDEST)) break;
+      f = s->queue + s->head;
+      if(flags & VERBOSE) {
+        fprintf(stderr, "dropping frame %lu of stream %s\n", f->index,
+                        s->name);
+      }
+      free_frame(f->frame);
+      f->frame = NULL;
+      s->head = (s->head + 1) % opt->backlog;
+      s->count--;
+      s->dropped++;
+    }
+    /* the frame owns a copy of its data, the buffer is reused */
+    if(!(copy = malloc(n))) {
+      perror(PROG ": frame = malloc()");
+      exit(99);
+    }
+    memcpy(copy, s->buf + off + start, n);
+    f = s->queue + (s->head + s->count) % opt->backlog;
+    f->frame = pnm_load_buffer(copy, n);
+    f->index = s->frames++;
+    s->count++;
+    off += start + n;
+  }
+  if(off > 0) {
+    memmove(s->buf, s->buf + off, s->len - off);
+    s->len -= off;
+  }
+}
+
+/* read what is available from a stream and queue the complete frames,
+ * pause reading if the queue is full */
+static void read_stream(stream_struct *s, int epfd, unsigned int flags)
+{
+  unsigned char *buf;
+  ssize_t n;
+
+  /* a frame larger than the buffer makes the buffer grow */
+  if(s->size - s->len < STREAM_READ) {
+    if(!(buf = realloc(s->buf, s->len + STREAM_READ))) {
+      perror(PROG ": stream buffer = realloc()");
+      exit(99);
+    }
+    s->buf = buf;
+    s->size = s->len + STREAM_READ;
+  }
+  n = read(s->fd, s->buf + s->len, s->size - s->len);
+  if(n < 0) {
+    if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) return;
+    fprintf(stderr, "%s: error: could not read stream %s\n", PROG, s->name);
+    perror(PROG ": read()");
+    s->failed = 1;
+    close_stream(s);
+    return;
+  }
+  if(n == 0) {
+    if(flags & VERBOSE) {
+      fprintf(stderr, "end of stream %s after %lu frames\n", s->name,
+                      s->frames);
+    }
+    close_stream(s);
+  }
+  s->len += n;
+  queue_frames(s, flags);
+  if(s->fd < 0) {
+    if(s->len > 0) {
+      fprintf(stderr, "%s: error: incomplete frame %lu at end of stream %s\n",
+                      PROG, s->frames, s->name);
+      s->failed = 1;
+      s->len = 0;
+    }
+  } else if(s->count == s->ctx->opt.backlog &&
+            !(s->ctx->opt.flags & DROP_OLDEST)) {
+    /* the writer blocks when the FIFO or socket buffer is full */
+    epoll_ctl(epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    s->paused = 1;
+  }
+}
+
+/* give the oldest queued frame of an idle stream to a worker, resume reading
+ * a paused stream, return 1 if the stream has ended or 0 otherwise */
+static int next_frame(stream_struct *s, pool_struct *pool, int epfd,
+                      unsigned int flags)
+{
+  struct epoll_event ev;
+  int backlog = s->ctx->opt.backlog;
+
+  if(s->current.frame || s->count == 0) {
+    return !s->current.frame && s->fd < 0;
+  }
+  s->current = s->queue[s->head];
+  s->queue[s->head].frame = NULL;
+  s->head = (s->head + 1) % backlog;
+  s->count--;
+  pool_submit(pool, NULL, s);
+  if(s->paused) {
+    /* frames left in the buffer come first */
+    queue_frames(s, flags);
+    if(s->fd >= 0 && s->count < backlog) {
+      memset(&ev, 0, sizeof(ev));
+      ev.events = EPOLLIN;
+      ev.data.ptr = s;
+      epoll_ctl(epfd, EPOLL_CTL_ADD, s->fd, &ev);
+      s->paused = 0;
+    }
+  }
+  return 0;
+}
+
+/* print the output lines of the streams with a recognized frame, which is
+ * freed, and give the next frames to the workers,
+ * return the number of streams that have ended */
+static int finish_frames(stream_done_struct *done, pool_struct *pool,
+                         int epfd, unsigned int flags)
+{
+  stream_struct *s, *list;
+  uint64_t count;
+  int ended = 0;
+
+  if(read(done->evfd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    perror(PROG ": read(eventfd)");
+  }
+  pthread_mutex_lock(&done->lock);
+  list = done->list;
+  done->list = NULL;
+  pthread_mutex_unlock(&done->lock);
+  while((s = list)) {
+    list = s->next_done;
+    fputs(s->line, stdout);
+    free(s->line);
+    s->line = NULL;
+    free_frame(s->current.frame);
+    s->current.frame = NULL;
+    ended += next_frame(s, pool, epfd, flags);
+  }
+  fflush(stdout);
+  return ended;
+}
+
+/* read all streams until their end, the name and ctx of every stream must be
+ * set, the other members are initialized here, the frames are recognized by
+ * jobs worker threads and one line per frame is printed with the stream name,
+ * frame index, recognized digits, and exit code for the frame,
+ * return the exit code for all streams */
+int serve_streams(stream_struct *streams, int nstreams, int jobs,
+                  unsigned int flags)
+{
+  struct epoll_event ev, events[STREAM_EVENTS];
+  stream_done_struct done;
+  stream_struct *s;
+  pool_struct *pool;
+  int epfd, active = 0, i, n, ret = 0;
+
+  pthread_mutex_init(&done.lock, NULL);
+  done.list = NULL;
+  if((epfd = epoll_create1(0)) < 0 ||
+     (done.evfd = eventfd(0, EFD_NONBLOCK)) < 0) {
+    perror(PROG ": could not create event notification");
+    return 99;
+  }
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL; /* the eventfd */
+  epoll_ctl(epfd, EPOLL_CTL_ADD, done.evfd, &ev);
+
+  for(i = 0; i < nstreams; i++) {
+    s = streams + i;
+    s->done = &done;
+    s->queue = calloc(s->ctx->opt.backlog, sizeof(stream_frame_struct));
+    if(!s->queue) {
+      perror(PROG ": queue = calloc()");
+      exit(99);
+    }
+    if((s->fd = open_stream(s->name)) < 0) {
+      s->failed = 1;
+      continue;
+    }
+    ev.data.ptr = s;
+    if(epoll_ctl(epfd, EPOLL_CTL_ADD, s->fd, &ev) < 0) {
+      fprintf(stderr, "%s: error: could not poll stream %s\n", PROG, s->name);
+      perror(PROG ": epoll_ctl()");
+      s->failed = 1;
+      close_stream(s);
+      continue;
+    }
+    active++;
+  }
+  /* every stream has at most one frame in recognition, another one may be
+   * given to a worker before the pool has accounted for the first one */
+  pool = new_pool(jobs, 2 * nstreams, 0, stream_work, NULL);
+  if(flags & VERBOSE) {
+    fprintf(stderr, "reading %d streams with %d worker threads\n", active,
+                    jobs);
+  }
+
+  while(active > 0) {
+    if((n = epoll_wait(epfd, events, STREAM_EVENTS, -1)) < 0) {
+      if(errno == EINTR) continue;
+      perror(PROG ": epoll_wait()");
+      ret = 99;
+      break;
+    }
+    for(i = 0; i < n; i++) {
+      if(!(s = events[i].data.ptr)) {
+        active -= finish_frames(&done, pool, epfd, flags);
+      } else if(s->fd >= 0 && !s->paused) {
+        read_stream(s, epfd, flags);
+        active -= next_frame(s, pool, epfd, flags);
+      }
+    }
+  }
+
+  free_pool(pool);
+  for(i = 0; i < nstreams; i++) {
+    s = streams + i;
+    close_stream(s);
+    free(s->line);
+    free_frame(s->current.frame);
+    for(n = 0; n < s->count; n++) {
+      free_frame(s->queue[(s->head + n) % s->ctx->opt.backlog].frame);
+    }
+    free(s->queue);
+    free(s->buf);
+    if(s->failed) ret = 99;
+    if(s->dropped) {
+      fprintf(stderr, "%s: warning: dropped %lu of %lu frames of stream %s\n",
+                      PROG, s->dropped, s->frames, s->name);
+    }
+  }
+  close(done.evfd);
+  close(epfd);
+  pthread_mutex_destroy(&done.lock);
+
+  return ret;
+}
+#else
+/* epoll and eventfd are specific to Linux */
+int serve_streams(stream_struct *streams, int nstreams, int jobs,
+                  unsigned int flags)
+{
+  (void) streams;
+  (void) nstreams;
+  (void) jobs;
+  (void) flags;
+  fprintf(stderr, "%s: error: --streams is supported on Linux only\n", PROG);
+  return 99;
+}
+#endif /* __linux__ */
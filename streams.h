@@ -0,0 +1,70 @@
+/* Seven Segment Optical Character Recognition Multi-Stream Server */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* The multi-stream server reads binary PNM frames from many FIFOs or Unix
+ * domain stream sockets in one thread using epoll.  Every complete frame is
+ * queued at its stream and recognized by the shared worker threads with the
+ * options and commands of the stream.  A stream has at most one frame in
+ * recognition, thus its results are printed in order.  When the queue of a
+ * stream is full, the stream is not read until a frame has been taken by a
+ * worker (the writer blocks then), or, with DROP_OLDEST, the oldest queued
+ * frame is dropped to make room for the new one.
+ *
+ * Needs "frame.h" to be included before. */
+
+#ifndef SSOCR2_STREAMS_H
+#define SSOCR2_STREAMS_H
+
+/* a frame of a stream waiting for or in recognition */
+typedef struct {
+  frame_struct *frame;        /* the frame, NULL if none */
+  unsigned long int index;    /* number of the frame in its stream */
+} stream_frame_struct;
+
+/* a stream read by the multi-stream server */
+typedef struct stream_s {
+  const char *name;           /* path of the FIFO or socket */
+  struct ssocr_ctx_s *ctx;    /* options and commands of the stream */
+  int fd;                     /* non-blocking descriptor, -1 after the end */
+  int paused;                 /* is reading paused because the queue is full? */
+  int failed;                 /* could the stream not be read completely? */
+  unsigned char *buf;         /* data read, but not yet a complete frame */
+  size_t len;                 /* number of bytes in buf */
+  size_t size;                /* allocated memory for buf */
+  stream_frame_struct *queue; /* ring buffer of frames waiting for a worker */
+  int head;                   /* index of the oldest queued frame */
+  int count;                  /* number of queued frames */
+  stream_frame_struct current; /* frame recognized by a worker */
+  char *line;                 /* output line of the current frame */
+  unsigned long int frames;   /* number of frames read */
+  unsigned long int dropped;  /* number of frames dropped */
+  struct stream_s *next_done; /* next stream with a recognized frame */
+  struct stream_done_s *done; /* list of streams with a recognized frame */
+} stream_struct;
+
+/* functions */
+
+/* read all streams until their end, the name and ctx of every stream must be
+ * set, the other members are initialized here, the frames are recognized by
+ * jobs worker threads and one line per frame is printed with the stream name,
+ * frame index, recognized digits, and exit code for the frame,
+ * return the exit code for all streams */
+int serve_streams(stream_struct *streams, int nstreams, int jobs,
+                  unsigned int flags);
+
+#endif /* SSOCR2_STREAMS_H */
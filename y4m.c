@@ -0,0 +1,228 @@
+/* Seven Segment Optical Character Recognition YUV4MPEG2 Stream Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+/* ImLib2 Header */
+#include <X11/Xlib.h>       /* needed by Imlib2.h */
+#include <Imlib2.h>
+
+/* standard things */
+#include <stdio.h>          /* FILE, getc, fread, fseek, perror */
+#include <stdlib.h>         /* calloc, realloc, free, atoi, exit */
+
+/* string manipulation */
+#include <string.h>         /* strncmp, strcmp, strcpy */
+
+/* my headers */
+#include "defines.h"        /* defines */
+#include "imgproc.h"        /* clip */
+#include "frame.h"          /* frames decoded without Imlib2 */
+#include "y4m.h"            /* YUV4MPEG2 streams */
+
+/* limit for frame dimensions to rule out overflows */
+#define Y4M_MAX_DIM 65535
+
+/* functions */
+
+/* read one space separated parameter of a header line into buf,
+ * return the character following the parameter (space, newline, or EOF) */
+static int y4m_param(FILE *stream, char *buf, size_t size)
+{
+  size_t n = 0;
+  int c;
+
+  while((c = getc(stream)) != EOF && c != ' ' && c != '\n') {
+    if(n + 1 < size) buf[n++] = c;
+  }
+  buf[n] = '\0';
+  return c;
+}
+
+/* read the stream header, return NULL if it is not a supported stream */
+y4m_struct *y4m_read_header(FILE *stream)
+{
+  y4m_struct *y4m;
+  char param[Y4M_MAX_PARAM];
+  int c;
+
+  c = y4m_param(stream, param, sizeof(param));
+  if(strcmp(param, Y4M_SIGNATURE) != 0 || c != ' ') return NULL;
+
+  if(!(y4m = calloc(1, sizeof(y4m_struct)))) {
+    perror(PROG ": y4m = calloc()");
+    exit(99);
+  }
+  strcpy(y4m->colorspace, "420jpeg"); /* default colorspace */
+  y4m->seekable = 1;
+  while(c == ' ') {
+    c = y4m_param(stream, param, sizeof(param));
+    switch(param[0]) {
+      case 'W': y4m->w = atoi(param + 1); break;
+      case 'H': y4m->h = atoi(param + 1); break;
+      case 'C':
+        strcpy(y4m->colorspace, param + 1);
+        break;
+      default: break; /* frame rate, interlacing, aspect ratio, ... */
+    }
+  }
+  if(c != '\n' || y4m->w <= 0 || y4m->h <= 0 ||
+     y4m->w > Y4M_MAX_DIM || y4m->h > Y4M_MAX_DIM) {
+    free_y4m(y4m);
+    return NULL;
+  }
+
+  /* only 8 bit samples are supported */
+  if(strncmp(y4m->colorspace, "420", 3) == 0 &&
+     (!y4m->colorspace[3] || strcmp(y4m->colorspace + 3, "jpeg") == 0 ||
+      strcmp(y4m->colorspace + 3, "paldv") == 0 ||
+      strcmp(y4m->colorspace + 3, "mpeg2") == 0)) {
+    y4m->sx = y4m->sy = 1;
+  } else if(strcmp(y4m->colorspace, "422") == 0) {
+    y4m->sx = 1;
+  } else if(strcmp(y4m->colorspace, "411") == 0) {
+    y4m->sx = 2;
+  } else if(strcmp(y4m->colorspace, "444") == 0) {
+    /* no subsampling */
+  } else if(strcmp(y4m->colorspace, "444alpha") == 0) {
+    y4m->extra = (size_t)y4m->w * y4m->h;
+  } else if(strcmp(y4m->colorspace, "mono") == 0) {
+    y4m->sx = y4m->sy = -1;
+  } else {
+    free_y4m(y4m);
+    return NULL;
+  }
+  if(y4m->sx >= 0) {
+    y4m->cw = (y4m->w + (1 << y4m->sx) - 1) >> y4m->sx;
+    y4m->ch = (y4m->h + (1 << y4m->sy) - 1) >> y4m->sy;
+  }
+
+  return y4m;
+}
+
+/* free stream parameters and buffers */
+void free_y4m(y4m_struct *y4m)
+{
+  if(!y4m) return;
+  free(y4m->chroma);
+  free(y4m->skip);
+  free(y4m);
+}
+
+/* skip n bytes of the stream without using them,
+ * return 0 on success, -1 on error */
+static int y4m_skip(FILE *stream, y4m_struct *y4m, size_t n)
+{
+  size_t len;
+
+  if(!n) return 0;
+  /* seeking avoids reading data of regular files */
+  if(y4m->seekable) {
+    if(fseek(stream, n, SEEK_CUR) == 0) return 0;
+    y4m->seekable = 0;
+  }
+  if(!y4m->skip) {
+    y4m->skip_size = BUFSIZ;
+    if(!(y4m->skip = calloc(y4m->skip_size, 1))) {
+      perror(PROG ": y4m->skip = calloc()");
+      exit(99);
+    }
+  }
+  while(n > 0) {
+    len = (n < y4m->skip_size) ? n : y4m->skip_size;
+    if(fread(y4m->skip, 1, len, stream) != len) return -1;
+    n -= len;
+  }
+  return 0;
+}
+
+/* convert the luma plane in frame->buf and the chroma planes to RGB,
+ * using ITU-R BT.601 with limited range, as used by ffmpeg for y4m */
+static void y4m_to_rgb(y4m_struct *y4m, frame_struct *frame,
+                       unsigned char *rgb)
+{
+  const unsigned char *luma = frame->buf;
+  const unsigned char *cb = y4m->chroma;
+  const unsigned char *cr = y4m->chroma + (size_t)y4m->cw * y4m->ch;
+  int x, y, c, d, e;
+  size_t ci;
+
+  for(y = 0; y < y4m->h; y++) {
+    for(x = 0; x < y4m->w; x++, rgb += 3) {
+      c = 298 * (luma[(size_t)y * y4m->w + x] - 16);
+      ci = (size_t)(y >> y4m->sy) * y4m->cw + (x >> y4m->sx);
+      d = cb[ci] - 128;
+      e = cr[ci] - 128;
+      rgb[0] = clip((c + 409 * e + 128) >> 8, 0, MAXRGB);
+      rgb[1] = clip((c - 100 * d - 208 * e + 128) >> 8, 0, MAXRGB);
+      rgb[2] = clip((c + 516 * d + 128) >> 8, 0, MAXRGB);
+    }
+  }
+}
+
+/* read the next frame of a stream into frame, reusing the memory of the
+ * frame, only the luma plane is used unless color is set,
+ * return 1 if a frame has been read, 0 at the end of the stream,
+ * or -1 on error */
+int y4m_read_frame(FILE *stream, y4m_struct *y4m, frame_struct *frame,
+                   int color)
+{
+  char param[Y4M_MAX_PARAM];
+  size_t luma = (size_t)y4m->w * y4m->h;
+  size_t chroma = 2 * (size_t)y4m->cw * y4m->ch;
+  size_t size;
+  int c;
+
+  /* every frame starts with a FRAME line, possibly with parameters */
+  c = y4m_param(stream, param, sizeof(param));
+  if(c == EOF && !param[0]) return 0;
+  if(strcmp(param, "FRAME") != 0) return -1;
+  while(c == ' ') c = y4m_param(stream, param, sizeof(param));
+  if(c != '\n') return -1;
+
+  /* the color conversion needs room for the luma plane and RGB data */
+  color = color && chroma;
+  size = color ? 4 * luma : luma;
+  if(size > frame->buf_size) {
+    unsigned char *buf;
+    if(!(buf = realloc(frame->buf, size))) {
+      perror(PROG ": frame->buf = realloc()");
+      exit(99);
+    }
+    frame->buf = buf;
+    frame->buf_size = size;
+  }
+  if(fread(frame->buf, 1, luma, stream) != luma) return -1;
+  if(color) {
+    if(!y4m->chroma && !(y4m->chroma = calloc(chroma, 1))) {
+      perror(PROG ": y4m->chroma = calloc()");
+      exit(99);
+    }
+    if(fread(y4m->chroma, 1, chroma, stream) != chroma) return -1;
+    if(y4m_skip(stream, y4m, y4m->extra)) return -1;
+    y4m_to_rgb(y4m, frame, frame->buf + luma);
+  } else {
+    if(y4m_skip(stream, y4m, chroma + y4m->extra)) return -1;
+  }
+
+  frame->fmt = color ? FRAME_RGB24 : FRAME_GRAY8;
+  frame->w = y4m->w;
+  frame->h = y4m->h;
+  frame->x0 = frame->y0 = 0;
+  frame->stride = color ? 3 * (size_t)y4m->w : (size_t)y4m->w;
+  frame->data = color ? frame->buf + luma : frame->buf;
+  return 1;
+}
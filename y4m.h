@@ -0,0 +1,56 @@
+/* Seven Segment Optical Character Recognition YUV4MPEG2 Stream Functions */
+
+/*  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Copyright (C) 2026 Erik Auerswald <auerswal@unix-ag.uni-kl.de> */
+
+#ifndef SSOCR2_Y4M_H
+#define SSOCR2_Y4M_H
+
+/* the signature starting every YUV4MPEG2 stream */
+#define Y4M_SIGNATURE "YUV4MPEG2"
+
+/* maximum length of a header parameter (including terminating zero) */
+#define Y4M_MAX_PARAM 64
+
+/* parameters of a YUV4MPEG2 stream */
+typedef struct {
+  int w, h;                 /* frame dimensions */
+  int cw, ch;               /* dimensions of a chroma plane (0 for mono) */
+  int sx, sy;               /* chroma subsampling as shift of x and y */
+  size_t extra;             /* bytes of further planes (alpha) per frame */
+  char colorspace[Y4M_MAX_PARAM]; /* colorspace as given in stream header */
+  int seekable;             /* can planes be skipped by seeking? */
+  unsigned char *chroma;    /* buffer for both chroma planes, or NULL */
+  unsigned char *skip;      /* buffer to read unneeded data into, or NULL */
+  size_t skip_size;         /* size of skip buffer */
+} y4m_struct;
+
+/* functions */
+
+/* read the stream header, return NULL if it is not a supported stream */
+y4m_struct *y4m_read_header(FILE *stream);
+
+/* free stream parameters and buffers */
+void free_y4m(y4m_struct *y4m);
+
+/* read the next frame of a stream into frame, reusing the memory of the
+ * frame, only the luma plane is used unless color is set,
+ * return 1 if a frame has been read, 0 at the end of the stream,
+ * or -1 on error */
+int y4m_read_frame(FILE *stream, y4m_struct *y4m, frame_struct *frame,
+                   int color);
+
+#endif /* SSOCR2_Y4M_H */